@@ -0,0 +1,53 @@
+//Selects the fastest decoder variant of the default K=7 code with the autotuner.
+//The first run benchmarks the variants and writes the wisdom file.  Later runs read the selection from the file.
+//Usage: autotuneDemo [--retune] [wisdomFile]
+
+#include "codeRegistry.h"
+#include "viterbiAutotune.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+int main(int argc, char* argv[]){
+    bool retune = false;
+    const char* wisdomPath = VITERBI_AUTOTUNE_WISDOM_FILE;
+    for(int i = 1; i<argc; i++){
+        if(strcmp(argv[i], "--retune") == 0){
+            retune = true;
+        }else{
+            wisdomPath = argv[i];
+        }
+    }
+
+    printf("=============== Autotune Demo ===============\n");
+    printf("Registered Variants: %d\n", codeRegistryNumCodes);
+
+    char fingerprint[VITERBI_AUTOTUNE_FINGERPRINT_LEN];
+    viterbiAutotuneFingerprint(fingerprint, sizeof(fingerprint));
+    printf("CPU Fingerprint: %s\n", fingerprint);
+    printf("Wisdom File: %s\n", wisdomPath);
+
+    const uint64_t generators[] = {0113, 0171};
+
+    viterbiAutotuneResult_t result;
+    viterbiAutotune(7, 1, 2, generators, wisdomPath, retune, &result);
+    if(result.entry == NULL){
+        printf("No usable variant of the code is registered\n");
+        printf("++++ Test Failed! ++++\n");
+        return 1;
+    }
+
+    printf("Selected: %s (%s), %8.3f Mbps, %s\n", result.entry->name, result.entry->variant, result.mbps, result.fromWisdom ? "from wisdom" : "benchmarked");
+
+    //A second call should be served from the wisdom file
+    viterbiAutotuneResult_t reloaded;
+    viterbiAutotune(7, 1, 2, generators, wisdomPath, false, &reloaded);
+    if(!reloaded.fromWisdom || reloaded.entry != result.entry){
+        printf("The selection was not reloaded from the wisdom file\n");
+        printf("++++ Test Failed! ++++\n");
+        return 1;
+    }
+
+    printf("++++ Test Passed! ++++\n");
+    return 0;
+}
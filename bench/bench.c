@@ -0,0 +1,983 @@
+//Benchmark driver for the encoder and decoder variants in the code registry
+//
+//Replaces the compile time configuration of speedEncode/speedDecode (packet length, number of packets, core)
+//with command line options.  The decoder variants are linked into the binary as registry entries (see variants.txt)
+//and are selected by name.  Each variant is warmed up (which also checks the decoded packets) and then measured
+//over several repetitions of a fixed duration.  The mean and standard deviation of the throughput and cycles/bit
+//across the repetitions are reported as text, JSON, or CSV.  When permitted, hardware performance counters
+//(see perfCounters.h) are read around each repetition and reported per uncoded bit.
+//
+//By default the decoders are given noiseless packets.  With --esn0, the coded packets are passed through the AWGN
+//channel (see awgnChannel.h) and hard sliced so that the decoders see realistic channel errors.
+//
+//The default batch of 16 packets stays in the L1/L2 cache along with the decoder state.  To measure the decoders
+//with cold data, --working-set sizes the batch so that the distinct input packets span the given number of bytes
+//(up to several GB) and --flush evicts the next packet, the output buffer, and the encoder/decoder state from every
+//level of the cache before each packet.  The flush is not included in the measured time, but is included in the
+//performance counters.  --states cycles the packets through several independently allocated encoder/decoder states
+//(packet p uses state p mod the number of states) to emulate switching between the states of several channels.
+//
+//With --save-baseline, the per repetition throughput and packet latency of each variant are stored in a baseline file
+//along with fingerprints of the machine and compiler (see benchBaseline.h).  With --compare, a later run is compared
+//to the baseline for the same machine, compiler, and configuration with Welch's t-test.  A variant regresses if its
+//throughput is lower or its latency is higher with a p-value below --alpha and by more than --threshold.  The
+//benchmark then exits with BENCH_EXIT_REGRESSION so that scripts and CI can detect the regression.
+
+#ifndef _GNU_SOURCE
+//Need _GNU_SOURCE, sched.h, and unistd.h for setting thread affinity in Linux
+#define _GNU_SOURCE
+#endif
+#include <unistd.h>
+#include <sched.h>
+#include <errno.h>
+#include <pthread.h>
+#include <getopt.h>
+#include <fcntl.h>
+
+#include "codeRegistry.h"
+#include "perfCounters.h"
+#include "awgnChannel.h"
+#include "benchBaseline.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <limits.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+    #include <x86intrin.h>
+    #define BENCH_HAS_TSC
+    #define BENCH_HAS_CLFLUSH
+#endif
+
+#define BENCH_MAX_REPS (1000)
+#define BENCH_MAX_VARIANTS (64)
+#define BENCH_SEED (314)
+#define BENCH_MAX_STATES (1024)
+#define BENCH_TIMER_PKTS (16) //Packets processed between reads of the timer
+#define BENCH_CACHE_LINE_BYTES (64)
+#define BENCH_EVICT_BYTES (64*1024*1024) //Written to evict the cache when clflush is not available
+#define BENCH_EXIT_CHECK_FAILED (1)
+#define BENCH_EXIT_REGRESSION (2)
+
+typedef enum{
+    BENCH_MODE_DECODE,
+    BENCH_MODE_ENCODE
+} benchMode_e;
+
+typedef enum{
+    BENCH_FORMAT_TEXT,
+    BENCH_FORMAT_JSON,
+    BENCH_FORMAT_CSV
+} benchFormat_e;
+
+typedef struct{
+    benchMode_e mode;
+    benchFormat_e format;
+    int pktLenBytes;
+    int batch; //Number of distinct packets cycled through
+    size_t workingSetBytes; //If non-zero, overrides batch so that the distinct input packets span at least this many bytes
+    bool flushEnable; //Evict the packet, output buffer, and state from the cache before each packet
+    int numStates; //Number of encoder/decoder states cycled through
+    int core; //-1 to not set the affinity
+    double duration; //Seconds per repetition
+    int reps;
+    int warmupReps; //Passes over the batch before measuring
+    const char* outputPath;
+    bool perfEnable;
+    bool awgnEnable; //False for noiseless packets.  NAN is not used since the benchmark is compiled with -Ofast
+    double esN0Db;
+    const char* saveBaselinePath; //NULL to not save the results
+    const char* compareBaselinePath; //NULL to not compare the results
+    double regressionAlpha; //Significance level of the regression test
+    double regressionThreshold; //Minimum relative change considered a regression
+    const codeRegistryEntry_t* variants[BENCH_MAX_VARIANTS];
+    int numVariants;
+} benchConfig_t;
+
+typedef struct{
+    const codeRegistryEntry_t* entry;
+    bool correct;
+    int batch; //Number of distinct packets cycled through for this variant
+    double mbps[BENCH_MAX_REPS];
+    double cyclesPerBit[BENCH_MAX_REPS];
+    double pktLatencyUs[BENCH_MAX_REPS]; //Mean time to encode/decode a packet
+    double meanMbps;
+    double stddevMbps;
+    double meanCyclesPerBit;
+    double stddevCyclesPerBit;
+    bool perfValid[PERF_COUNTER_NUM]; //True if the counter was read in every repetition
+    double perfPerBit[PERF_COUNTER_NUM]; //Mean across the repetitions
+} benchResult_t;
+
+//From telemetry_helpers.c
+typedef struct timespec timespec_t;
+double difftimespec(timespec_t* a, timespec_t* b){
+    double a_double = a->tv_sec + (a->tv_nsec)*(0.000000001);
+    double b_double = b->tv_sec + (b->tv_nsec)*(0.000000001);
+    return a_double - b_double;
+}
+
+static inline uint64_t readCycles(){
+    #ifdef BENCH_HAS_TSC
+        return __rdtsc();
+    #else
+        return 0;
+    #endif
+}
+
+benchConfig_t config;
+benchResult_t results[BENCH_MAX_VARIANTS];
+#ifndef BENCH_HAS_CLFLUSH
+    uint8_t* evictBuffer;
+#endif
+
+//The decoder init functions print to stdout.  They are silenced so that JSON/CSV written to stdout can be parsed
+int silenceStdout(){
+    fflush(stdout);
+    int savedStdout = dup(STDOUT_FILENO);
+    int devNull = open("/dev/null", O_WRONLY);
+    if(savedStdout >= 0 && devNull >= 0){
+        dup2(devNull, STDOUT_FILENO);
+    }
+    if(devNull >= 0){
+        close(devNull);
+    }
+    return savedStdout;
+}
+
+void restoreStdout(int savedStdout){
+    fflush(stdout);
+    if(savedStdout >= 0){
+        dup2(savedStdout, STDOUT_FILENO);
+        close(savedStdout);
+    }
+}
+
+void computeStats(const double* vals, int count, double* mean, double* stddev){
+    double sum = 0;
+    for(int i = 0; i<count; i++){
+        sum += vals[i];
+    }
+    *mean = sum/count;
+
+    double sumSq = 0;
+    for(int i = 0; i<count; i++){
+        sumSq += (vals[i]-*mean)*(vals[i]-*mean);
+    }
+    *stddev = count > 1 ? sqrt(sumSq/(count-1)) : 0;
+}
+
+/**
+ * Evicts the given bytes from every level of the cache.  Without clflush, evictCache is used instead
+ */
+void flushRange(const void* ptr, size_t len){
+    #ifdef BENCH_HAS_CLFLUSH
+        const uint8_t* bytes = (const uint8_t*) ptr;
+        for(size_t i = 0; i<len; i+=BENCH_CACHE_LINE_BYTES){
+            _mm_clflush(bytes+i);
+        }
+        if(len > 0){
+            _mm_clflush(bytes+len-1);
+        }
+    #else
+        (void) ptr;
+        (void) len;
+    #endif
+}
+
+/**
+ * Evicts the input packet, the output buffer, and the state used by the next packet
+ */
+void evictCache(const void* pkt, size_t pktLen, const void* out, size_t outLen, const void* state, size_t stateLen){
+    #ifdef BENCH_HAS_CLFLUSH
+        flushRange(pkt, pktLen);
+        flushRange(out, outLen);
+        flushRange(state, stateLen);
+        _mm_mfence();
+    #else
+        //Writing a buffer larger than the last level cache replaces the lines of the packet and state
+        (void) pkt;
+        (void) pktLen;
+        (void) out;
+        (void) outLen;
+        (void) state;
+        (void) stateLen;
+        for(size_t i = 0; i<BENCH_EVICT_BYTES; i+=BENCH_CACHE_LINE_BYTES){
+            evictBuffer[i]++;
+        }
+        asm volatile ("" ::: "memory");
+    #endif
+}
+
+/**
+ * Runs the encoder or decoder of the entry over the batch until the given duration has elapsed.
+ * The packets are processed in order starting at *nextPkt, which is updated so that the next repetition continues
+ * through a batch which is too large to be finished in one repetition.  Packet p uses state p mod config.numStates.
+ * Returns the number of uncoded bits processed
+ */
+int64_t runForDuration(const codeRegistryEntry_t* entry, void** encoderStates, void** decoderStates, uint8_t* uncodedPkts, uint8_t* codedSegments, int maxCodedSegments, const int* codedSegmentsLen, int batch, int* nextPkt, uint8_t* outBuffer, size_t outBufferLen, double duration, double* elapsed, uint64_t* cycles){
+    int64_t bitsProcessed = 0;
+    double currentDuration = 0;
+    uint64_t totalCycles = 0;
+    int pkt = *nextPkt;
+
+    //When flushing, each packet is timed separately so that the flush is not measured
+    int pktsPerTimer = config.flushEnable ? 1 : (batch < BENCH_TIMER_PKTS ? batch : BENCH_TIMER_PKTS);
+
+    while(currentDuration < duration){
+        if(config.flushEnable){
+            if(config.mode == BENCH_MODE_DECODE){
+                evictCache(codedSegments+(size_t) pkt*maxCodedSegments, codedSegmentsLen[pkt], outBuffer, outBufferLen, decoderStates[pkt%config.numStates], entry->decoderStateSize);
+            }else{
+                evictCache(uncodedPkts+(size_t) pkt*config.pktLenBytes, config.pktLenBytes, outBuffer, outBufferLen, encoderStates[pkt%config.numStates], entry->encoderStateSize);
+            }
+        }
+
+        timespec_t startTime;
+        asm volatile ("" ::: "memory"); //Stop Re-ordering of timer
+        clock_gettime(CLOCK_MONOTONIC, &startTime);
+        uint64_t startCycles = readCycles();
+        asm volatile ("" ::: "memory"); //Stop Re-ordering of timer
+
+        for(int i = 0; i<pktsPerTimer; i++){
+            if(config.mode == BENCH_MODE_DECODE){
+                entry->decode(decoderStates[pkt%config.numStates], codedSegments+(size_t) pkt*maxCodedSegments, outBuffer, codedSegmentsLen[pkt], true);
+            }else{
+                entry->encode(encoderStates[pkt%config.numStates], uncodedPkts+(size_t) pkt*config.pktLenBytes, outBuffer, config.pktLenBytes, true);
+            }
+            bitsProcessed += 8*config.pktLenBytes;
+
+            //Need to make sure that the decode/encode is not optimized out
+            asm volatile(""
+            :
+            : "r" (*(const uint8_t (*)[]) outBuffer)
+            :);
+
+            pkt = pkt+1 == batch ? 0 : pkt+1;
+        }
+
+        timespec_t currentTime;
+        asm volatile ("" ::: "memory"); //Stop Re-ordering of timer
+        uint64_t endCycles = readCycles();
+        clock_gettime(CLOCK_MONOTONIC, &currentTime);
+        asm volatile ("" ::: "memory"); //Stop Re-ordering of timer
+        currentDuration += difftimespec(&currentTime, &startTime);
+        totalCycles += endCycles - startCycles;
+    }
+
+    *nextPkt = pkt;
+    *elapsed = currentDuration;
+    *cycles = totalCycles;
+    return bitsProcessed;
+}
+
+void benchVariant(const codeRegistryEntry_t* entry, benchResult_t* result, perfCounters_t* counters){
+    result->entry = entry;
+    result->correct = true;
+
+    int maxCodedSegments = 8*config.pktLenBytes/entry->inputBits + entry->constraintLength;
+
+    //The working set is made of the packets read by the encoder/decoder
+    int batch = config.batch;
+    if(config.workingSetBytes > 0){
+        size_t pktBytes = config.mode == BENCH_MODE_DECODE ? (size_t) maxCodedSegments : (size_t) config.pktLenBytes;
+        size_t pkts = (config.workingSetBytes+pktBytes-1)/pktBytes;
+        if(pkts > INT_MAX){
+            printf("Working set of %zu bytes is too large for %d byte packets ... exiting\n", config.workingSetBytes, config.pktLenBytes);
+            exit(1);
+        }
+        batch = (int) pkts;
+    }
+    result->batch = batch;
+
+    size_t outBufferLen = maxCodedSegments > config.pktLenBytes ? maxCodedSegments : config.pktLenBytes;
+    uint8_t* uncodedPkts = malloc((size_t) batch*config.pktLenBytes);
+    uint8_t* codedSegments = malloc((size_t) batch*maxCodedSegments);
+    int* codedSegmentsLen = malloc((size_t) batch*sizeof(int));
+    //Large enough for either the decoded bytes or the coded segments
+    uint8_t* outBuffer = malloc(outBufferLen);
+    void** encoderStates = malloc(config.numStates*sizeof(void*));
+    void** decoderStates = malloc(config.numStates*sizeof(void*));
+    if(uncodedPkts == NULL || codedSegments == NULL || codedSegmentsLen == NULL || outBuffer == NULL || encoderStates == NULL || decoderStates == NULL){
+        printf("Unable to allocate benchmark buffers ... exiting\n");
+        exit(1);
+    }
+
+    for(int i = 0; i<config.numStates; i++){
+        encoderStates[i] = codeRegistryAllocState(entry, entry->encoderStateSize);
+        decoderStates[i] = codeRegistryAllocState(entry, entry->decoderStateSize);
+        if(encoderStates[i] == NULL || decoderStates[i] == NULL){
+            printf("Unable to allocate benchmark buffers ... exiting\n");
+            exit(1);
+        }
+    }
+
+    //The same packets are used for each variant
+    unsigned int seed = BENCH_SEED;
+    for(size_t i = 0; i<(size_t) batch*config.pktLenBytes; i++){
+        uncodedPkts[i] = (uint8_t) rand_r(&seed);
+    }
+
+    int savedStdout = silenceStdout();
+    for(int i = 0; i<config.numStates; i++){
+        entry->encoderInit(encoderStates[i]);
+        entry->decoderInit(decoderStates[i]);
+    }
+    restoreStdout(savedStdout);
+
+    for(int pkt = 0; pkt<batch; pkt++){
+        codedSegmentsLen[pkt] = entry->encode(encoderStates[0], uncodedPkts+(size_t) pkt*config.pktLenBytes, codedSegments+(size_t) pkt*maxCodedSegments, config.pktLenBytes, true);
+    }
+
+    //Pass the coded packets through the channel.  The same noise is used for each variant with the same code
+    bool noisy = config.mode == BENCH_MODE_DECODE && config.awgnEnable;
+    if(noisy){
+        int8_t* soft = malloc(maxCodedSegments*entry->outputBits);
+        if(soft == NULL){
+            printf("Unable to allocate benchmark buffers ... exiting\n");
+            exit(1);
+        }
+
+        awgnChannel_t channel;
+        awgnChannelInit(&channel, config.esN0Db, AWGN_CHANNEL_DEFAULT_SOFT_SCALE, BENCH_SEED);
+        for(int pkt = 0; pkt<batch; pkt++){
+            uint8_t* pktSegments = codedSegments+(size_t) pkt*maxCodedSegments;
+            awgnChannelBpsk(&channel, pktSegments, codedSegmentsLen[pkt], entry->outputBits, soft);
+            awgnChannelHardSlice(soft, pktSegments, codedSegmentsLen[pkt], entry->outputBits);
+        }
+        free(soft);
+    }
+
+    //Warm-up.  Decoding is checked against the uncoded packets.  With channel errors, only the decoded length is checked
+    for(int rep = 0; rep<config.warmupReps; rep++){
+        for(int pkt = 0; pkt<batch; pkt++){
+            uint8_t* uncodedPkt = uncodedPkts+(size_t) pkt*config.pktLenBytes;
+            uint8_t* codedPkt = codedSegments+(size_t) pkt*maxCodedSegments;
+            if(config.mode == BENCH_MODE_DECODE){
+                int bytesOut = entry->decode(decoderStates[pkt%config.numStates], codedPkt, outBuffer, codedSegmentsLen[pkt], true);
+                if(bytesOut != config.pktLenBytes || (!noisy && memcmp(outBuffer, uncodedPkt, config.pktLenBytes) != 0)){
+                    result->correct = false;
+                }
+            }else{
+                int segmentsOut = entry->encode(encoderStates[pkt%config.numStates], uncodedPkt, outBuffer, config.pktLenBytes, true);
+                if(segmentsOut != codedSegmentsLen[pkt] || memcmp(outBuffer, codedPkt, segmentsOut) != 0){
+                    result->correct = false;
+                }
+            }
+        }
+    }
+
+    for(int i = 0; i<PERF_COUNTER_NUM; i++){
+        result->perfValid[i] = true;
+        result->perfPerBit[i] = 0;
+    }
+
+    int nextPkt = 0;
+    for(int rep = 0; rep<config.reps; rep++){
+        double elapsed;
+        uint64_t cycles;
+        perfCounterValues_t perfValues;
+        perfCountersStart(counters);
+        int64_t bits = runForDuration(entry, encoderStates, decoderStates, uncodedPkts, codedSegments, maxCodedSegments, codedSegmentsLen, batch, &nextPkt, outBuffer, outBufferLen, config.duration, &elapsed, &cycles);
+        perfCountersStop(counters, &perfValues);
+        result->mbps[rep] = bits / elapsed / 1e6;
+        result->cyclesPerBit[rep] = ((double) cycles) / bits;
+        result->pktLatencyUs[rep] = elapsed / (bits/(8.0*config.pktLenBytes)) * 1e6;
+
+        for(int i = 0; i<PERF_COUNTER_NUM; i++){
+            result->perfValid[i] &= perfValues.valid[i];
+            result->perfPerBit[i] += perfValues.counts[i] / bits / config.reps;
+        }
+    }
+
+    computeStats(result->mbps, config.reps, &result->meanMbps, &result->stddevMbps);
+    computeStats(result->cyclesPerBit, config.reps, &result->meanCyclesPerBit, &result->stddevCyclesPerBit);
+
+    for(int i = 0; i<config.numStates; i++){
+        free(encoderStates[i]);
+        free(decoderStates[i]);
+    }
+    free(encoderStates);
+    free(decoderStates);
+    free(uncodedPkts);
+    free(codedSegments);
+    free(codedSegmentsLen);
+    free(outBuffer);
+}
+
+void* benchThread(void* arg){
+    //The counters only count the thread which opens them
+    perfCounters_t counters;
+    perfCountersOpen(&counters, config.perfEnable);
+
+    for(int i = 0; i<config.numVariants; i++){
+        fprintf(stderr, "Benchmarking %s (%s)\n", config.variants[i]->name, config.variants[i]->variant);
+        benchVariant(config.variants[i], &results[i], &counters);
+    }
+
+    perfCountersClose(&counters);
+
+    return NULL;
+}
+
+const char* modeName(benchMode_e mode){
+    return mode == BENCH_MODE_DECODE ? "decode" : "encode";
+}
+
+void printResults(FILE* out){
+    if(config.format == BENCH_FORMAT_JSON){
+        fprintf(out, "{\n");
+        fprintf(out, "  \"mode\": \"%s\",\n", modeName(config.mode));
+        fprintf(out, "  \"pktLenBytes\": %d,\n", config.pktLenBytes);
+        fprintf(out, "  \"batch\": %d,\n", config.batch);
+        fprintf(out, "  \"workingSetBytes\": %zu,\n", config.workingSetBytes);
+        fprintf(out, "  \"flush\": %s,\n", config.flushEnable ? "true" : "false");
+        fprintf(out, "  \"states\": %d,\n", config.numStates);
+        fprintf(out, "  \"core\": %d,\n", config.core);
+        fprintf(out, "  \"durationSec\": %f,\n", config.duration);
+        fprintf(out, "  \"reps\": %d,\n", config.reps);
+        fprintf(out, "  \"warmupReps\": %d,\n", config.warmupReps);
+        if(config.awgnEnable){
+            fprintf(out, "  \"esN0Db\": %f,\n", config.esN0Db);
+        }else{
+            fprintf(out, "  \"esN0Db\": null,\n");
+        }
+        fprintf(out, "  \"results\": [\n");
+        for(int i = 0; i<config.numVariants; i++){
+            benchResult_t* result = &results[i];
+            fprintf(out, "    {\"variant\": \"%s\", \"flags\": \"%s\", \"K\": %d, \"k\": %d, \"n\": %d, \"batch\": %d, \"correct\": %s, ",
+                    result->entry->name, result->entry->variant, result->entry->constraintLength, result->entry->inputBits, result->entry->outputBits, result->batch, result->correct ? "true" : "false");
+            fprintf(out, "\"meanMbps\": %f, \"stddevMbps\": %f, \"meanCyclesPerBit\": %f, \"stddevCyclesPerBit\": %f, \"mbps\": [",
+                    result->meanMbps, result->stddevMbps, result->meanCyclesPerBit, result->stddevCyclesPerBit);
+            for(int rep = 0; rep<config.reps; rep++){
+                fprintf(out, "%s%f", rep == 0 ? "" : ", ", result->mbps[rep]);
+            }
+            //Unavailable counters are reported as null
+            fprintf(out, "], \"perfPerBit\": {");
+            for(int j = 0; j<PERF_COUNTER_NUM; j++){
+                fprintf(out, "%s\"%s\": ", j == 0 ? "" : ", ", perfCounterName(j));
+                if(result->perfValid[j]){
+                    fprintf(out, "%f", result->perfPerBit[j]);
+                }else{
+                    fprintf(out, "null");
+                }
+            }
+            fprintf(out, "}}%s\n", i == config.numVariants-1 ? "" : ",");
+        }
+        fprintf(out, "  ]\n");
+        fprintf(out, "}\n");
+    }else if(config.format == BENCH_FORMAT_CSV){
+        fprintf(out, "variant,flags,mode,K,k,n,pktLenBytes,batch,states,flush,reps,esN0Db,correct,meanMbps,stddevMbps,meanCyclesPerBit,stddevCyclesPerBit");
+        for(int j = 0; j<PERF_COUNTER_NUM; j++){
+            fprintf(out, ",%sPerBit", perfCounterName(j));
+        }
+        fprintf(out, "\n");
+        for(int i = 0; i<config.numVariants; i++){
+            benchResult_t* result = &results[i];
+            fprintf(out, "%s,\"%s\",%s,%d,%d,%d,%d,%d,%d,%d,%d,",
+                    result->entry->name, result->entry->variant, modeName(config.mode), result->entry->constraintLength, result->entry->inputBits, result->entry->outputBits,
+                    config.pktLenBytes, result->batch, config.numStates, config.flushEnable ? 1 : 0, config.reps);
+            //Left empty for noiseless packets
+            if(config.awgnEnable){
+                fprintf(out, "%f", config.esN0Db);
+            }
+            fprintf(out, ",%d,%f,%f,%f,%f", result->correct ? 1 : 0,
+                    result->meanMbps, result->stddevMbps, result->meanCyclesPerBit, result->stddevCyclesPerBit);
+            //Unavailable counters are left empty
+            for(int j = 0; j<PERF_COUNTER_NUM; j++){
+                if(result->perfValid[j]){
+                    fprintf(out, ",%f", result->perfPerBit[j]);
+                }else{
+                    fprintf(out, ",");
+                }
+            }
+            fprintf(out, "\n");
+        }
+    }else{
+        if(config.workingSetBytes > 0){
+            fprintf(out, "Mode: %s, Packet Length: %d bytes, Working Set: %zu bytes, Reps: %d x %f s\n", modeName(config.mode), config.pktLenBytes, config.workingSetBytes, config.reps, config.duration);
+        }else{
+            fprintf(out, "Mode: %s, Packet Length: %d bytes, Batch: %d packets, Reps: %d x %f s\n", modeName(config.mode), config.pktLenBytes, config.batch, config.reps, config.duration);
+        }
+        if(config.numStates > 1 || config.flushEnable){
+            fprintf(out, "States: %d, Cache Flush: %s\n", config.numStates, config.flushEnable ? "before each packet" : "off");
+        }
+        if(config.awgnEnable){
+            fprintf(out, "Channel: AWGN, Es/N0: %f dB (BPSK, Hard Decisions)\n", config.esN0Db);
+        }
+        for(int i = 0; i<config.numVariants; i++){
+            benchResult_t* result = &results[i];
+            fprintf(out, "%-20s Rate: %10.3f +/- %8.3f Mbps, %8.3f +/- %6.3f Cycles/Bit",
+                    result->entry->name, result->meanMbps, result->stddevMbps, result->meanCyclesPerBit, result->stddevCyclesPerBit);
+            if(config.workingSetBytes > 0){
+                fprintf(out, ", %d Packets", result->batch);
+            }
+            fprintf(out, "%s\n", result->correct ? "" : " (Check Failed)");
+
+            bool anyPerf = false;
+            for(int j = 0; j<PERF_COUNTER_NUM; j++){
+                if(result->perfValid[j]){
+                    fprintf(out, "%s%s: %.4f", anyPerf ? ", " : "    Per Bit: ", perfCounterName(j), result->perfPerBit[j]);
+                    anyPerf = true;
+                }
+            }
+            if(anyPerf){
+                fprintf(out, "\n");
+            }
+        }
+    }
+}
+
+//***** Baseline *****
+
+typedef struct{
+    const char* name;
+    const char* units;
+    bool lowerIsBetter;
+} baselineMetric_t;
+
+static const baselineMetric_t baselineMetrics[] = {
+    {"mbps", "Mbps", false},
+    {"pktLatencyUs", "us/pkt", true}
+};
+#define BASELINE_NUM_METRICS ((int) (sizeof(baselineMetrics)/sizeof(baselineMetrics[0])))
+
+const double* baselineMetricSamples(const benchResult_t* result, int metric){
+    return metric == 0 ? result->mbps : result->pktLatencyUs;
+}
+
+/**
+ * Identifies the benchmark configuration.  Results are only compared to baselines with the same configuration
+ */
+void baselineConfigKey(char* key, size_t len){
+    char esN0[32] = "none";
+    if(config.awgnEnable){
+        snprintf(esN0, sizeof(esN0), "%g", config.esN0Db);
+    }
+    snprintf(key, len, "%s_l%d_b%d_w%zu_s%d_f%d_e%s", modeName(config.mode), config.pktLenBytes, config.batch, config.workingSetBytes,
+             config.numStates, config.flushEnable ? 1 : 0, esN0);
+}
+
+void baselineVariantKey(const codeRegistryEntry_t* entry, char* key, size_t len){
+    char combined[BENCH_BASELINE_FIELD_LEN];
+    snprintf(combined, sizeof(combined), "%s:%s", entry->name, entry->variant);
+    benchBaselineSanitize(combined, key, len);
+}
+
+double baselineMean(const double* vals, int count){
+    double sum = 0;
+    for(int i = 0; i<count; i++){
+        sum += vals[i];
+    }
+    return sum/count;
+}
+
+/**
+ * Compares the results to the baseline.  Returns true if any variant regressed
+ */
+bool compareBaseline(const benchBaselineFingerprint_t* fingerprint){
+    char configKey[BENCH_BASELINE_FIELD_LEN];
+    baselineConfigKey(configKey, sizeof(configKey));
+
+    fprintf(stderr, "Baseline: %s (alpha: %g, threshold: %g%%)\n", config.compareBaselinePath, config.regressionAlpha, config.regressionThreshold*100);
+
+    bool regressed = false;
+    for(int i = 0; i<config.numVariants; i++){
+        benchResult_t* result = &results[i];
+        char variantKey[BENCH_BASELINE_FIELD_LEN];
+        baselineVariantKey(result->entry, variantKey, sizeof(variantKey));
+
+        fprintf(stderr, "%-20s", result->entry->name);
+        bool variantRegressed = false;
+        bool anyBaseline = false;
+        for(int metric = 0; metric<BASELINE_NUM_METRICS; metric++){
+            double ref[BENCH_MAX_REPS];
+            int refCount = benchBaselineRead(config.compareBaselinePath, fingerprint, configKey, variantKey, baselineMetrics[metric].name, ref, BENCH_MAX_REPS);
+            if(refCount == 0){
+                continue;
+            }
+            anyBaseline = true;
+
+            const double* test = baselineMetricSamples(result, metric);
+            double refMean = baselineMean(ref, refCount);
+            double testMean = baselineMean(test, config.reps);
+            double change = (testMean-refMean)/refMean;
+
+            //One-sided in the direction of a regression
+            double t;
+            double p = baselineMetrics[metric].lowerIsBetter ? benchWelchTTest(ref, refCount, test, config.reps, &t) : benchWelchTTest(test, config.reps, ref, refCount, &t);
+            double worse = baselineMetrics[metric].lowerIsBetter ? change : -change;
+            bool metricRegressed = p < config.regressionAlpha && worse > config.regressionThreshold;
+            variantRegressed |= metricRegressed;
+
+            fprintf(stderr, " %s: %.3f -> %.3f %s (%+.2f%%, p=%.3g)%s", baselineMetrics[metric].name, refMean, testMean, baselineMetrics[metric].units,
+                    change*100, p, metricRegressed ? " REGRESSION" : "");
+        }
+
+        if(!anyBaseline){
+            fprintf(stderr, " No baseline\n");
+        }else{
+            fprintf(stderr, "\n");
+        }
+        regressed |= variantRegressed;
+    }
+
+    return regressed;
+}
+
+void saveBaseline(const benchBaselineFingerprint_t* fingerprint){
+    char configKey[BENCH_BASELINE_FIELD_LEN];
+    baselineConfigKey(configKey, sizeof(configKey));
+
+    for(int i = 0; i<config.numVariants; i++){
+        char variantKey[BENCH_BASELINE_FIELD_LEN];
+        baselineVariantKey(results[i].entry, variantKey, sizeof(variantKey));
+        for(int metric = 0; metric<BASELINE_NUM_METRICS; metric++){
+            if(!benchBaselineWrite(config.saveBaselinePath, fingerprint, configKey, variantKey, baselineMetrics[metric].name, baselineMetricSamples(&results[i], metric), config.reps)){
+                printf("Could not write the baseline file %s ... exiting\n", config.saveBaselinePath);
+                exit(1);
+            }
+        }
+    }
+
+    fprintf(stderr, "Saved the results of %d variants to %s (CPU: %s, Compiler: %s)\n", config.numVariants, config.saveBaselinePath, fingerprint->cpu, fingerprint->compiler);
+}
+
+void printUsage(const char* prog){
+    printf("Usage: %s [options]\n", prog);
+    printf("  -m, --mode <decode|encode>  Operation to benchmark (default: decode)\n");
+    printf("  -l, --pkt-len <bytes>       Uncoded packet length in bytes (default: %d)\n", 2048/8);
+    printf("  -b, --batch <pkts>          Number of distinct packets cycled through (default: 16)\n");
+    printf("  -W, --working-set <bytes>   Size the batch so the distinct input packets span this many bytes, K/M/G suffixes allowed\n");
+    printf("  -F, --flush                 Evict the packet, output buffer, and state from the cache before each packet\n");
+    printf("  -s, --states <n>            Number of encoder/decoder states cycled through (default: 1, max: %d)\n", BENCH_MAX_STATES);
+    printf("  -c, --core <cpu>            Core to run on, -1 to not set the affinity (default: -1)\n");
+    printf("  -d, --duration <sec>        Duration of each repetition (default: 1.0)\n");
+    printf("  -r, --reps <n>              Number of measured repetitions (default: 5, max: %d)\n", BENCH_MAX_REPS);
+    printf("  -w, --warmup <n>            Passes over the batch before measuring (default: 2)\n");
+    printf("  -v, --variant <name>        Variant to benchmark, may be repeated (default: all)\n");
+    printf("  -f, --format <text|json|csv> Output format (default: text)\n");
+    printf("  -o, --output <file>         Write the results to a file instead of stdout\n");
+    printf("  -e, --esn0 <dB>             Decode packets received over the AWGN channel at this Es/N0 (default: noiseless)\n");
+    printf("  -P, --no-perf               Do not read the hardware performance counters\n");
+    printf("  -S, --save-baseline <file>  Save the results to a baseline file\n");
+    printf("  -C, --compare <file>        Compare the results to a baseline file, exit with %d on a regression\n", BENCH_EXIT_REGRESSION);
+    printf("  -a, --alpha <p>             Significance level of the regression test (default: 0.01)\n");
+    printf("  -t, --threshold <frac>      Minimum relative change considered a regression (default: 0.05)\n");
+    printf("  -L, --list                  List the variants and exit\n");
+    printf("  -h, --help                  Print this message\n");
+}
+
+void listVariants(){
+    for(int i = 0; i<codeRegistryNumCodes; i++){
+        const codeRegistryEntry_t* entry = codeRegistryTable[i];
+        printf("%-20s K=%d, k=%d, n=%d, Flags: %s\n", entry->name, entry->constraintLength, entry->inputBits, entry->outputBits, entry->variant);
+    }
+}
+
+int parseIntArg(const char* arg, const char* name){
+    char* end;
+    long val = strtol(arg, &end, 0);
+    if(*end != '\0'){
+        printf("Invalid %s: %s ... exiting\n", name, arg);
+        exit(1);
+    }
+    return (int) val;
+}
+
+size_t parseSizeArg(const char* arg, const char* name){
+    char* end;
+    unsigned long long val = strtoull(arg, &end, 0);
+    size_t scale = 1;
+    if(*end == 'K' || *end == 'k'){
+        scale = 1024;
+        end++;
+    }else if(*end == 'M' || *end == 'm'){
+        scale = 1024*1024;
+        end++;
+    }else if(*end == 'G' || *end == 'g'){
+        scale = 1024*1024*1024;
+        end++;
+    }
+    if(*end != '\0' || arg[0] == '-'){
+        printf("Invalid %s: %s ... exiting\n", name, arg);
+        exit(1);
+    }
+    return (size_t) val*scale;
+}
+
+int main(int argc, char* argv[]){
+    config.mode = BENCH_MODE_DECODE;
+    config.format = BENCH_FORMAT_TEXT;
+    config.pktLenBytes = 2048/8;
+    config.batch = 16;
+    config.workingSetBytes = 0;
+    config.flushEnable = false;
+    config.numStates = 1;
+    config.core = -1;
+    config.duration = 1.0;
+    config.reps = 5;
+    config.warmupReps = 2;
+    config.outputPath = NULL;
+    config.perfEnable = true;
+    config.awgnEnable = false;
+    config.esN0Db = 0;
+    config.saveBaselinePath = NULL;
+    config.compareBaselinePath = NULL;
+    config.regressionAlpha = 0.01;
+    config.regressionThreshold = 0.05;
+    config.numVariants = 0;
+
+    static struct option longOptions[] = {
+        {"mode",     required_argument, NULL, 'm'},
+        {"pkt-len",  required_argument, NULL, 'l'},
+        {"batch",    required_argument, NULL, 'b'},
+        {"working-set", required_argument, NULL, 'W'},
+        {"flush",    no_argument,       NULL, 'F'},
+        {"states",   required_argument, NULL, 's'},
+        {"core",     required_argument, NULL, 'c'},
+        {"duration", required_argument, NULL, 'd'},
+        {"reps",     required_argument, NULL, 'r'},
+        {"warmup",   required_argument, NULL, 'w'},
+        {"variant",  required_argument, NULL, 'v'},
+        {"format",   required_argument, NULL, 'f'},
+        {"output",   required_argument, NULL, 'o'},
+        {"esn0",     required_argument, NULL, 'e'},
+        {"no-perf",  no_argument,       NULL, 'P'},
+        {"save-baseline", required_argument, NULL, 'S'},
+        {"compare",  required_argument, NULL, 'C'},
+        {"alpha",    required_argument, NULL, 'a'},
+        {"threshold", required_argument, NULL, 't'},
+        {"list",     no_argument,       NULL, 'L'},
+        {"help",     no_argument,       NULL, 'h'},
+        {NULL, 0, NULL, 0}
+    };
+
+    int opt;
+    while((opt = getopt_long(argc, argv, "m:l:b:W:Fs:c:d:r:w:v:f:o:e:PS:C:a:t:Lh", longOptions, NULL)) != -1){
+        switch(opt){
+            case 'm':
+                if(strcmp(optarg, "decode") == 0){
+                    config.mode = BENCH_MODE_DECODE;
+                }else if(strcmp(optarg, "encode") == 0){
+                    config.mode = BENCH_MODE_ENCODE;
+                }else{
+                    printf("Unknown mode: %s ... exiting\n", optarg);
+                    exit(1);
+                }
+                break;
+            case 'l':
+                config.pktLenBytes = parseIntArg(optarg, "packet length");
+                break;
+            case 'b':
+                config.batch = parseIntArg(optarg, "batch size");
+                break;
+            case 'W':
+                config.workingSetBytes = parseSizeArg(optarg, "working set");
+                break;
+            case 'F':
+                config.flushEnable = true;
+                break;
+            case 's':
+                config.numStates = parseIntArg(optarg, "number of states");
+                break;
+            case 'c':
+                config.core = parseIntArg(optarg, "core");
+                break;
+            case 'd':
+                config.duration = atof(optarg);
+                break;
+            case 'r':
+                config.reps = parseIntArg(optarg, "reps");
+                break;
+            case 'w':
+                config.warmupReps = parseIntArg(optarg, "warmup reps");
+                break;
+            case 'v':{
+                const codeRegistryEntry_t* entry = codeRegistryLookupByName(optarg);
+                if(entry == NULL){
+                    printf("Unknown variant: %s ... exiting\n", optarg);
+                    listVariants();
+                    exit(1);
+                }
+                if(config.numVariants >= BENCH_MAX_VARIANTS){
+                    printf("Too many variants ... exiting\n");
+                    exit(1);
+                }
+                config.variants[config.numVariants++] = entry;
+                break;
+            }
+            case 'f':
+                if(strcmp(optarg, "text") == 0){
+                    config.format = BENCH_FORMAT_TEXT;
+                }else if(strcmp(optarg, "json") == 0){
+                    config.format = BENCH_FORMAT_JSON;
+                }else if(strcmp(optarg, "csv") == 0){
+                    config.format = BENCH_FORMAT_CSV;
+                }else{
+                    printf("Unknown format: %s ... exiting\n", optarg);
+                    exit(1);
+                }
+                break;
+            case 'o':
+                config.outputPath = optarg;
+                break;
+            case 'e':
+                config.awgnEnable = true;
+                config.esN0Db = atof(optarg);
+                break;
+            case 'P':
+                config.perfEnable = false;
+                break;
+            case 'S':
+                config.saveBaselinePath = optarg;
+                break;
+            case 'C':
+                config.compareBaselinePath = optarg;
+                break;
+            case 'a':
+                config.regressionAlpha = atof(optarg);
+                break;
+            case 't':
+                config.regressionThreshold = atof(optarg);
+                break;
+            case 'L':
+                listVariants();
+                return 0;
+            case 'h':
+                printUsage(argv[0]);
+                return 0;
+            default:
+                printUsage(argv[0]);
+                exit(1);
+        }
+    }
+
+    if(config.numVariants == 0){
+        for(int i = 0; i<codeRegistryNumCodes && i<BENCH_MAX_VARIANTS; i++){
+            config.variants[config.numVariants++] = codeRegistryTable[i];
+        }
+    }
+
+    if(config.pktLenBytes <= 0 || config.batch <= 0 || config.reps <= 0 || config.reps > BENCH_MAX_REPS || config.warmupReps < 0 || config.duration <= 0 ||
+       config.numStates <= 0 || config.numStates > BENCH_MAX_STATES || config.regressionAlpha <= 0 || config.regressionThreshold < 0){
+        printf("Invalid benchmark parameters ... exiting\n");
+        exit(1);
+    }
+
+    for(int i = 0; i<config.numVariants; i++){
+        if(8*config.pktLenBytes > config.variants[i]->maxUncodedBits || (8*config.pktLenBytes) % config.variants[i]->inputBits != 0){
+            printf("Packet length of %d bytes is not supported by %s (max %d bits, multiple of %d bits) ... exiting\n",
+                   config.pktLenBytes, config.variants[i]->name, config.variants[i]->maxUncodedBits, config.variants[i]->inputBits);
+            exit(1);
+        }
+    }
+
+    #ifndef BENCH_HAS_TSC
+        fprintf(stderr, "Cycle counter is not available on this platform, Cycles/Bit will be reported as 0\n");
+    #endif
+
+    #ifndef BENCH_HAS_CLFLUSH
+        if(config.flushEnable){
+            evictBuffer = calloc(BENCH_EVICT_BYTES, 1);
+            if(evictBuffer == NULL){
+                printf("Unable to allocate benchmark buffers ... exiting\n");
+                exit(1);
+            }
+        }
+    #endif
+
+    //Create Thread Parameters
+    int status;
+    pthread_t thread;
+    pthread_attr_t attr;
+
+    status = pthread_attr_init(&attr);
+    if(status != 0)
+    {
+        printf("Could not create pthread attributes ... exiting");
+        exit(1);
+    }
+
+    if(config.core >= 0){
+        //Set partition to run on
+        cpu_set_t cpuset;
+        CPU_ZERO(&cpuset); //Clear cpuset
+        CPU_SET(config.core, &cpuset); //Add CPU to cpuset
+        status = pthread_attr_setaffinity_np(&attr, sizeof(cpu_set_t), &cpuset);//Set thread CPU affinity
+        if(status != 0)
+        {
+            printf("Could not set thread core affinity ... exiting");
+            exit(1);
+        }
+    }
+
+    //Start Threads
+    status = pthread_create(&thread, &attr, benchThread, NULL);
+    if(status != 0)
+    {
+        printf("Could not create a thread ... exiting");
+        errno = status;
+        perror(NULL);
+        exit(1);
+    }
+
+    //Wait for Thread to Finish
+    void *res;
+    status = pthread_join(thread, &res);
+    if(status != 0)
+    {
+        printf("Could not join a thread ... exiting");
+        errno = status;
+        perror(NULL);
+        exit(1);
+    }
+
+    FILE* out = stdout;
+    if(config.outputPath != NULL){
+        out = fopen(config.outputPath, "w");
+        if(out == NULL){
+            printf("Could not open %s ... exiting\n", config.outputPath);
+            exit(1);
+        }
+    }
+
+    printResults(out);
+
+    if(out != stdout){
+        fclose(out);
+    }
+
+    bool allCorrect = true;
+    for(int i = 0; i<config.numVariants; i++){
+        allCorrect &= results[i].correct;
+    }
+
+    //The comparison is made before saving so that the same file can be compared to and then updated
+    bool regressed = false;
+    if(config.compareBaselinePath != NULL || config.saveBaselinePath != NULL){
+        benchBaselineFingerprint_t fingerprint;
+        benchBaselineFingerprint(&fingerprint);
+
+        if(config.compareBaselinePath != NULL){
+            regressed = compareBaseline(&fingerprint);
+        }
+
+        //Results which failed the check are not a valid baseline
+        if(config.saveBaselinePath != NULL){
+            if(allCorrect){
+                saveBaseline(&fingerprint);
+            }else{
+                fprintf(stderr, "Not saving the baseline since a variant failed the check\n");
+            }
+        }
+    }
+
+    if(!allCorrect){
+        return BENCH_EXIT_CHECK_FAILED;
+    }
+
+    return regressed ? BENCH_EXIT_REGRESSION : 0;
+}
@@ -0,0 +1,235 @@
+#include "benchBaseline.h"
+#include "viterbiAutotune.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <math.h>
+#include <float.h>
+
+#define BENCH_BETA_MAX_ITER (200)
+#define BENCH_BETA_EPS (1e-12)
+
+void benchBaselineSanitize(const char* str, char* dst, size_t len){
+    size_t i = 0;
+    for(; str[i] != '\0' && i+1<len; i++){
+        dst[i] = isspace((unsigned char) str[i]) ? '_' : str[i];
+    }
+    dst[i] = '\0';
+
+    if(i == 0 && len > 1){
+        snprintf(dst, len, "unknown");
+    }
+}
+
+void benchBaselineFingerprint(benchBaselineFingerprint_t* fingerprint){
+    char cpu[VITERBI_AUTOTUNE_FINGERPRINT_LEN];
+    viterbiAutotuneFingerprint(cpu, sizeof(cpu));
+    benchBaselineSanitize(cpu, fingerprint->cpu, sizeof(fingerprint->cpu));
+
+    #ifdef __VERSION__
+        #if defined(__clang__)
+            benchBaselineSanitize("clang-" __VERSION__, fingerprint->compiler, sizeof(fingerprint->compiler));
+        #else
+            benchBaselineSanitize("gcc-" __VERSION__, fingerprint->compiler, sizeof(fingerprint->compiler));
+        #endif
+    #else
+        benchBaselineSanitize("", fingerprint->compiler, sizeof(fingerprint->compiler));
+    #endif
+}
+
+/**
+ * True if the key fields of the line match.  samplesOffset is set to the offset of the count and samples in the line
+ */
+static bool baselineLineMatches(const char* line, const benchBaselineFingerprint_t* fingerprint, const char* configKey, const char* variantKey, const char* metric, int* samplesOffset){
+    char lineCpu[BENCH_BASELINE_FIELD_LEN];
+    char lineCompiler[BENCH_BASELINE_FIELD_LEN];
+    char lineConfigKey[BENCH_BASELINE_FIELD_LEN];
+    char lineVariantKey[BENCH_BASELINE_FIELD_LEN];
+    char lineMetric[BENCH_BASELINE_FIELD_LEN];
+    int offset = 0;
+    if(sscanf(line, "%255s %255s %255s %255s %255s %n", lineCpu, lineCompiler, lineConfigKey, lineVariantKey, lineMetric, &offset) != 5 || offset == 0){
+        return false;
+    }
+
+    *samplesOffset = offset;
+    return strcmp(lineCpu, fingerprint->cpu) == 0 && strcmp(lineCompiler, fingerprint->compiler) == 0 && strcmp(lineConfigKey, configKey) == 0 &&
+           strcmp(lineVariantKey, variantKey) == 0 && strcmp(lineMetric, metric) == 0;
+}
+
+int benchBaselineRead(const char* path, const benchBaselineFingerprint_t* fingerprint, const char* configKey, const char* variantKey, const char* metric, double* vals, int maxVals){
+    FILE* baseline = fopen(path, "r");
+    if(baseline == NULL){
+        return 0;
+    }
+
+    int count = 0;
+    char* line = NULL;
+    size_t lineCap = 0;
+    while(count == 0 && getline(&line, &lineCap, baseline) != -1){
+        int samplesOffset;
+        if(!baselineLineMatches(line, fingerprint, configKey, variantKey, metric, &samplesOffset)){
+            continue;
+        }
+
+        char* end;
+        long lineCount = strtol(line+samplesOffset, &end, 10);
+        for(long i = 0; i<lineCount && count<maxVals; i++){
+            char* valEnd;
+            double val = strtod(end, &valEnd);
+            if(valEnd == end){
+                break;
+            }
+            vals[count++] = val;
+            end = valEnd;
+        }
+    }
+
+    free(line);
+    fclose(baseline);
+    return count;
+}
+
+bool benchBaselineWrite(const char* path, const benchBaselineFingerprint_t* fingerprint, const char* configKey, const char* variantKey, const char* metric, const double* vals, int count){
+    size_t tmpPathLen = strlen(path)+5;
+    char* tmpPath = malloc(tmpPathLen);
+    if(tmpPath == NULL){
+        return false;
+    }
+    snprintf(tmpPath, tmpPathLen, "%s.tmp", path);
+
+    FILE* tmp = fopen(tmpPath, "w");
+    if(tmp == NULL){
+        free(tmpPath);
+        return false;
+    }
+
+    FILE* baseline = fopen(path, "r");
+    if(baseline != NULL){
+        char* line = NULL;
+        size_t lineCap = 0;
+        while(getline(&line, &lineCap, baseline) != -1){
+            int samplesOffset;
+            if(baselineLineMatches(line, fingerprint, configKey, variantKey, metric, &samplesOffset)){
+                continue;
+            }
+            fputs(line, tmp);
+        }
+        free(line);
+        fclose(baseline);
+    }
+
+    fprintf(tmp, "%s %s %s %s %s %d", fingerprint->cpu, fingerprint->compiler, configKey, variantKey, metric, count);
+    for(int i = 0; i<count; i++){
+        fprintf(tmp, " %.9g", vals[i]);
+    }
+    fprintf(tmp, "\n");
+
+    bool ok = fclose(tmp) == 0 && rename(tmpPath, path) == 0;
+    if(!ok){
+        remove(tmpPath);
+    }
+    free(tmpPath);
+    return ok;
+}
+
+/**
+ * Continued fraction of the regularized incomplete beta function (modified Lentz's method)
+ */
+static double betaContinuedFraction(double a, double b, double x){
+    const double tiny = 1e-300;
+    double c = 1;
+    double d = 1 - (a+b)*x/(a+1);
+    d = fabs(d) < tiny ? tiny : d;
+    d = 1/d;
+    double h = d;
+
+    for(int m = 1; m<=BENCH_BETA_MAX_ITER; m++){
+        //Even step
+        double num = m*(b-m)*x/((a+2*m-1)*(a+2*m));
+        d = 1 + num*d;
+        d = fabs(d) < tiny ? tiny : d;
+        c = 1 + num/c;
+        c = fabs(c) < tiny ? tiny : c;
+        d = 1/d;
+        h *= d*c;
+
+        //Odd step
+        num = -(a+m)*(a+b+m)*x/((a+2*m)*(a+2*m+1));
+        d = 1 + num*d;
+        d = fabs(d) < tiny ? tiny : d;
+        c = 1 + num/c;
+        c = fabs(c) < tiny ? tiny : c;
+        d = 1/d;
+        double delta = d*c;
+        h *= delta;
+
+        if(fabs(delta-1) < BENCH_BETA_EPS){
+            break;
+        }
+    }
+
+    return h;
+}
+
+/**
+ * Regularized incomplete beta function I_x(a, b)
+ */
+static double incompleteBeta(double a, double b, double x){
+    if(x <= 0){
+        return 0;
+    }
+    if(x >= 1){
+        return 1;
+    }
+
+    double front = exp(lgamma(a+b) - lgamma(a) - lgamma(b) + a*log(x) + b*log(1-x));
+    //The continued fraction converges quickly for x < (a+1)/(a+b+2), otherwise the symmetry relation is used
+    if(x < (a+1)/(a+b+2)){
+        return front*betaContinuedFraction(a, b, x)/a;
+    }else{
+        return 1 - front*betaContinuedFraction(b, a, 1-x)/b;
+    }
+}
+
+static void meanVariance(const double* vals, int count, double* mean, double* variance){
+    double sum = 0;
+    for(int i = 0; i<count; i++){
+        sum += vals[i];
+    }
+    *mean = sum/count;
+
+    double sumSq = 0;
+    for(int i = 0; i<count; i++){
+        sumSq += (vals[i]-*mean)*(vals[i]-*mean);
+    }
+    *variance = sumSq/(count-1);
+}
+
+double benchWelchTTest(const double* ref, int refCount, const double* test, int testCount, double* t){
+    *t = 0;
+    if(refCount < 2 || testCount < 2){
+        return 1;
+    }
+
+    double refMean, refVar, testMean, testVar;
+    meanVariance(ref, refCount, &refMean, &refVar);
+    meanVariance(test, testCount, &testMean, &testVar);
+
+    double refSe2 = refVar/refCount;
+    double testSe2 = testVar/testCount;
+    double se2 = refSe2 + testSe2;
+    if(se2 <= 0){
+        //Both samples are constant.  Infinities are avoided since the benchmark is compiled with -Ofast
+        *t = testMean > refMean ? DBL_MAX : (testMean < refMean ? -DBL_MAX : 0);
+        return testMean > refMean ? 0 : 1;
+    }
+
+    *t = (testMean-refMean)/sqrt(se2);
+    //Welch-Satterthwaite degrees of freedom
+    double df = se2*se2/(refSe2*refSe2/(refCount-1) + testSe2*testSe2/(testCount-1));
+
+    //P(T >= t) for the t distribution with df degrees of freedom
+    double tail = 0.5*incompleteBeta(df/2, 0.5, df/(df + (*t)*(*t)));
+    return *t >= 0 ? tail : 1-tail;
+}
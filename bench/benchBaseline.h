@@ -0,0 +1,59 @@
+#ifndef _BENCH_BASELINE_H_
+#define _BENCH_BASELINE_H_
+
+#include <stddef.h>
+#include <stdbool.h>
+
+//Local store of benchmark results used to detect performance regressions
+//
+//Each line of the baseline file holds the per repetition samples of one metric of one variant:
+//    <cpu fingerprint> <compiler> <config key> <variant key> <metric> <count> <sample 0> ... <sample count-1>
+//The CPU fingerprint is the one used by the autotuner's wisdom file (see viterbiAutotune.h) and the compiler is the
+//version string of the compiler which built the benchmark, both without whitespace.  Results are only compared
+//with baseline samples from the same machine, compiler, benchmark configuration, and variant.  Saving a result
+//replaces the matching line and preserves the others, so one file can hold the baselines of several machines.
+//
+//A later run is compared to the baseline with Welch's t-test, which does not assume that the two runs have the same
+//variance.  The test is one-sided in the direction of a regression.
+
+#define BENCH_BASELINE_FIELD_LEN (256)
+
+typedef struct{
+    char cpu[BENCH_BASELINE_FIELD_LEN];
+    char compiler[BENCH_BASELINE_FIELD_LEN];
+} benchBaselineFingerprint_t;
+
+/**
+ * @brief Fingerprints the machine and the compiler which built the benchmark
+ */
+void benchBaselineFingerprint(benchBaselineFingerprint_t* fingerprint);
+
+/**
+ * @brief Copies str to dst with whitespace replaced by '_' so that it can be used as a field of the baseline file
+ */
+void benchBaselineSanitize(const char* str, char* dst, size_t len);
+
+/**
+ * @brief Reads the baseline samples of a metric
+ *
+ * @param vals the samples.  At most maxVals are returned
+ * @returns the number of samples or 0 if the baseline file has no matching line
+ */
+int benchBaselineRead(const char* path, const benchBaselineFingerprint_t* fingerprint, const char* configKey, const char* variantKey, const char* metric, double* vals, int maxVals);
+
+/**
+ * @brief Replaces the baseline samples of a metric.  Other lines of the file are preserved
+ *
+ * @returns false if the file could not be written
+ */
+bool benchBaselineWrite(const char* path, const benchBaselineFingerprint_t* fingerprint, const char* configKey, const char* variantKey, const char* metric, const double* vals, int count);
+
+/**
+ * @brief Welch's t-test of whether the mean of test is greater than the mean of ref
+ *
+ * @param t the t statistic (positive if the mean of test is greater)
+ * @returns the one-sided p-value.  1 if either sample has fewer than 2 values
+ */
+double benchWelchTTest(const double* ref, int refCount, const double* test, int testCount, double* t);
+
+#endif
@@ -0,0 +1,219 @@
+#include "perfCounters.h"
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+
+#ifdef __linux__
+    #include <unistd.h>
+    #include <sys/ioctl.h>
+    #include <sys/syscall.h>
+    #include <linux/perf_event.h>
+    #define PERF_COUNTERS_SUPPORTED
+#endif
+
+#if defined(__x86_64__) || defined(__i386__)
+    #include <cpuid.h>
+#endif
+
+static const char* perfCounterNames[PERF_COUNTER_NUM] = {
+    "cycles",
+    "instructions",
+    "l1dMisses",
+    "l2Misses",
+    "llcReferences",
+    "llcMisses",
+    "dtlbMisses",
+    "branchMisses"
+};
+
+const char* perfCounterName(perfCounter_e counter){
+    return perfCounterNames[counter];
+}
+
+#ifdef PERF_COUNTERS_SUPPORTED
+#define PERF_CACHE_READ_MISS(CACHE) ((CACHE) | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16))
+
+/**
+ * The raw event (event select | umask << 8) counting the demand requests which missed the L2.  Returns false if the
+ * event is not known for this CPU
+ */
+static bool perfL2MissEvent(__u64* config){
+    #if defined(__x86_64__) || defined(__i386__)
+        unsigned int eax, ebx, ecx, edx;
+        if(!__get_cpuid(0, &eax, &ebx, &ecx, &edx)){
+            return false;
+        }
+        char vendor[13];
+        memcpy(vendor, &ebx, 4);
+        memcpy(vendor+4, &edx, 4);
+        memcpy(vendor+8, &ecx, 4);
+        vendor[12] = '\0';
+
+        if(!__get_cpuid(1, &eax, &ebx, &ecx, &edx)){
+            return false;
+        }
+        unsigned int family = (eax >> 8) & 0xF;
+        unsigned int model = (eax >> 4) & 0xF;
+        if(family == 0x6 || family == 0xF){
+            model |= ((eax >> 16) & 0xF) << 4;
+        }
+        if(family == 0xF){
+            family += (eax >> 20) & 0xFF;
+        }
+
+        if(strcmp(vendor, "GenuineIntel") == 0 && family == 6 && model >= 0x3C){
+            //L2_RQSTS.MISS (Haswell and later.  Earlier CPUs use a different umask)
+            *config = 0x24 | (0x3F << 8);
+            return true;
+        }
+        if((strcmp(vendor, "AuthenticAMD") == 0 || strcmp(vendor, "HygonGenuine") == 0) && family >= 0x17){
+            //L2CacheReqStat: instruction and data cache requests which missed the L2 (Zen and later)
+            *config = 0x64 | (0x09 << 8);
+            return true;
+        }
+    #endif
+
+    return false;
+}
+
+/**
+ * Returns false if the counter is not supported on this CPU
+ */
+static bool perfCounterConfig(perfCounter_e counter, __u32* type, __u64* config){
+    switch(counter){
+        case PERF_COUNTER_CYCLES:
+            *type = PERF_TYPE_HARDWARE;
+            *config = PERF_COUNT_HW_CPU_CYCLES;
+            break;
+        case PERF_COUNTER_INSTRUCTIONS:
+            *type = PERF_TYPE_HARDWARE;
+            *config = PERF_COUNT_HW_INSTRUCTIONS;
+            break;
+        case PERF_COUNTER_L1D_MISSES:
+            *type = PERF_TYPE_HW_CACHE;
+            *config = PERF_CACHE_READ_MISS(PERF_COUNT_HW_CACHE_L1D);
+            break;
+        case PERF_COUNTER_L2_MISSES:
+            *type = PERF_TYPE_RAW;
+            return perfL2MissEvent(config);
+        case PERF_COUNTER_LLC_REFERENCES:
+            *type = PERF_TYPE_HARDWARE;
+            *config = PERF_COUNT_HW_CACHE_REFERENCES;
+            break;
+        case PERF_COUNTER_LLC_MISSES:
+            *type = PERF_TYPE_HARDWARE;
+            *config = PERF_COUNT_HW_CACHE_MISSES;
+            break;
+        case PERF_COUNTER_DTLB_MISSES:
+            *type = PERF_TYPE_HW_CACHE;
+            *config = PERF_CACHE_READ_MISS(PERF_COUNT_HW_CACHE_DTLB);
+            break;
+        case PERF_COUNTER_BRANCH_MISSES:
+        default:
+            *type = PERF_TYPE_HARDWARE;
+            *config = PERF_COUNT_HW_BRANCH_MISSES;
+            break;
+    }
+
+    return true;
+}
+#endif
+
+void perfCountersOpen(perfCounters_t* counters, bool enable){
+    counters->numAvailable = 0;
+    for(int i = 0; i<PERF_COUNTER_NUM; i++){
+        counters->fds[i] = -1;
+    }
+
+    if(!enable){
+        return;
+    }
+
+    #ifdef PERF_COUNTERS_SUPPORTED
+        int lastErrno = 0;
+        for(int i = 0; i<PERF_COUNTER_NUM; i++){
+            struct perf_event_attr attr;
+            memset(&attr, 0, sizeof(attr));
+            attr.size = sizeof(attr);
+            if(!perfCounterConfig(i, &attr.type, &attr.config)){
+                lastErrno = EOPNOTSUPP;
+                continue;
+            }
+            attr.disabled = 1;
+            attr.exclude_kernel = 1;
+            attr.exclude_hv = 1;
+            attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+            //This thread, any CPU
+            int fd = syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+            if(fd < 0){
+                lastErrno = errno;
+                continue;
+            }
+
+            counters->fds[i] = fd;
+            counters->numAvailable++;
+        }
+
+        if(counters->numAvailable < PERF_COUNTER_NUM){
+            fprintf(stderr, "%d of %d performance counters are unavailable (%s).  Check /proc/sys/kernel/perf_event_paranoid or whether the CPU exposes a PMU\n",
+                    PERF_COUNTER_NUM-counters->numAvailable, PERF_COUNTER_NUM, strerror(lastErrno));
+        }
+    #else
+        fprintf(stderr, "Performance counters are not supported on this platform\n");
+    #endif
+}
+
+void perfCountersClose(perfCounters_t* counters){
+    #ifdef PERF_COUNTERS_SUPPORTED
+        for(int i = 0; i<PERF_COUNTER_NUM; i++){
+            if(counters->fds[i] >= 0){
+                close(counters->fds[i]);
+                counters->fds[i] = -1;
+            }
+        }
+    #endif
+    counters->numAvailable = 0;
+}
+
+void perfCountersStart(perfCounters_t* counters){
+    #ifdef PERF_COUNTERS_SUPPORTED
+        for(int i = 0; i<PERF_COUNTER_NUM; i++){
+            if(counters->fds[i] >= 0){
+                ioctl(counters->fds[i], PERF_EVENT_IOC_RESET, 0);
+                ioctl(counters->fds[i], PERF_EVENT_IOC_ENABLE, 0);
+            }
+        }
+    #endif
+}
+
+void perfCountersStop(perfCounters_t* counters, perfCounterValues_t* values){
+    #ifdef PERF_COUNTERS_SUPPORTED
+        for(int i = 0; i<PERF_COUNTER_NUM; i++){
+            if(counters->fds[i] >= 0){
+                ioctl(counters->fds[i], PERF_EVENT_IOC_DISABLE, 0);
+            }
+        }
+    #endif
+
+    for(int i = 0; i<PERF_COUNTER_NUM; i++){
+        values->valid[i] = false;
+        values->counts[i] = 0;
+
+        #ifdef PERF_COUNTERS_SUPPORTED
+            if(counters->fds[i] < 0){
+                continue;
+            }
+
+            //value, time enabled, time running
+            uint64_t readBuf[3];
+            if(read(counters->fds[i], readBuf, sizeof(readBuf)) != sizeof(readBuf) || readBuf[2] == 0){
+                continue;
+            }
+
+            //Scale if the counter was multiplexed
+            values->counts[i] = ((double) readBuf[0]) * readBuf[1] / readBuf[2];
+            values->valid[i] = true;
+        #endif
+    }
+}
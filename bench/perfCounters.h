@@ -0,0 +1,64 @@
+#ifndef _PERF_COUNTERS_H_
+#define _PERF_COUNTERS_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+//Hardware performance counters read with perf_event_open (Linux)
+//
+//Each counter is opened separately so that a counter which is not supported (ex. in a VM without a PMU)
+//or not permitted (see /proc/sys/kernel/perf_event_paranoid) does not prevent the others from being used.
+//Counters which could not be opened are reported as unavailable.  Only user space events of the calling
+//thread are counted.  If the kernel multiplexes the counters, the counts are scaled by the fraction of
+//time each counter was running.
+//
+//The kernel has no generic L2 event, so the L2 misses are counted with a raw event chosen from the CPU vendor and
+//model.  The counter is unavailable on other CPUs.
+
+typedef enum{
+    PERF_COUNTER_CYCLES,
+    PERF_COUNTER_INSTRUCTIONS,
+    PERF_COUNTER_L1D_MISSES,
+    PERF_COUNTER_L2_MISSES, //Raw event, only available on the CPUs listed in perfCounters.c (perfL2MissEvent)
+    PERF_COUNTER_LLC_REFERENCES,
+    PERF_COUNTER_LLC_MISSES,
+    PERF_COUNTER_DTLB_MISSES,
+    PERF_COUNTER_BRANCH_MISSES,
+    PERF_COUNTER_NUM
+} perfCounter_e;
+
+typedef struct{
+    int fds[PERF_COUNTER_NUM]; //-1 if the counter is not available
+    int numAvailable;
+} perfCounters_t;
+
+typedef struct{
+    bool valid[PERF_COUNTER_NUM];
+    double counts[PERF_COUNTER_NUM];
+} perfCounterValues_t;
+
+/**
+ * @brief Opens the counters for the calling thread.  Counters which cannot be opened are marked unavailable
+ *
+ * @param enable if false, no counters are opened
+ */
+void perfCountersOpen(perfCounters_t* counters, bool enable);
+
+void perfCountersClose(perfCounters_t* counters);
+
+/**
+ * @brief Resets and starts the available counters
+ */
+void perfCountersStart(perfCounters_t* counters);
+
+/**
+ * @brief Stops the available counters and reads them into values
+ */
+void perfCountersStop(perfCounters_t* counters, perfCounterValues_t* values);
+
+/**
+ * @brief The name of the counter as used in the JSON and CSV output (ex. l1dMisses)
+ */
+const char* perfCounterName(perfCounter_e counter);
+
+#endif
@@ -0,0 +1,500 @@
+//Multi-threaded BER sweep engine
+//
+//Measures the decoded BER over a grid of SNRs (BPSK with hard decisions, using the same 4 samples/symbol SNR
+//convention as berTestK7 and the Matlab scripts) or channel error probabilities (BSC).
+//
+//The packets for each point are divided into blocks of --block-pkts packets.  Each block has its own RNG stream
+//(see errorInjector.h) derived from the seed, the point index, and the block index, so the result of a block does not depend on which
+//thread simulated it.  Threads take blocks from a shared counter and each thread has its own encoder and decoder.
+//Blocks are merged in block order and a point stops at the first block where the stopping rule is met
+//(target number of decoded bit errors, target relative confidence interval, or the max number of packets).
+//Blocks past the stopping block which were already simulated are discarded.  The results are therefore identical
+//for any number of threads.
+//
+//The results are written as CSV which can be plotted with scripts/matlab/plotBerSweep.m
+
+#include "convEncode.h"
+#include "viterbiDecoder.h"
+#include "errorInjector.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <getopt.h>
+#include <pthread.h>
+#include <unistd.h>
+
+#define ENCODE_PKT_BYTE_LEN (2048/8)
+#define CODED_SEGMENTS_LEN (8*ENCODE_PKT_BYTE_LEN/k+S)
+#define SNR_OVERSAMPLE (4) //The SNR is for 4 samples per symbol (see berCurveCoded.m)
+#define MAX_POINTS (256)
+#define MAX_THREADS (256)
+
+typedef enum{
+    STOP_NOT_STOPPED,
+    STOP_TARGET_ERRORS,
+    STOP_CONFIDENCE,
+    STOP_MAX_PKTS
+} stopReason_e;
+
+typedef struct{
+    int64_t codedBits;
+    int64_t codedBitErrors;
+    int64_t decodedBits;
+    int64_t decodedBitErrors;
+    int64_t pkts;
+    int64_t pktErrors;
+} berCounts_t;
+
+typedef struct{
+    double snr; //NAN if the point was specified by error probability
+    double errorProbability;
+
+    //Shared between the threads, protected by the sweep mutex
+    int64_t nextBlock;
+    int64_t mergedBlocks; //Blocks 0..mergedBlocks-1 have been merged into total
+    berCounts_t* blockCounts;
+    bool* blockDone;
+    berCounts_t total;
+    stopReason_e stopReason;
+} sweepPoint_t;
+
+typedef struct{
+    uint64_t seed;
+    int threads;
+    int64_t blockPkts;
+    int64_t maxPkts;
+    int64_t maxBlocks;
+    int64_t minPkts;
+    int64_t targetErrors;
+    double targetRelCi; //Relative half width of the confidence interval.  0 to disable
+    double z; //Standard normal quantile of the confidence level
+    const char* outputPath;
+
+    sweepPoint_t points[MAX_POINTS];
+    int numPoints;
+    int currentPoint;
+
+    pthread_mutex_t mutex;
+} sweepConfig_t;
+
+sweepConfig_t sweep;
+
+//***** RNG *****
+
+/**
+ * The seed of the RNG stream for a block.  The stream identifiers are mixed so that neighbouring blocks have unrelated streams
+ */
+uint64_t blockSeed(uint64_t seed, uint64_t point, uint64_t block){
+    uint64_t state = seed;
+    state = splitmix64(&state) ^ point;
+    state = splitmix64(&state) ^ block;
+    return splitmix64(&state);
+}
+
+//***** Statistics *****
+
+/**
+ * Wilson score interval for a binomial proportion
+ */
+void wilsonInterval(int64_t errors, int64_t trials, double z, double* low, double* high){
+    if(trials == 0){
+        *low = 0;
+        *high = 1;
+        return;
+    }
+
+    double p = (double) errors/trials;
+    double z2 = z*z;
+    double denom = 1 + z2/trials;
+    double center = (p + z2/(2*trials))/denom;
+    double halfWidth = z*sqrt(p*(1-p)/trials + z2/(4.0*trials*trials))/denom;
+    *low = center-halfWidth < 0 ? 0 : center-halfWidth;
+    *high = center+halfWidth > 1 ? 1 : center+halfWidth;
+}
+
+stopReason_e checkStop(const berCounts_t* total){
+    if(total->pkts < sweep.minPkts){
+        return STOP_NOT_STOPPED;
+    }
+
+    if(sweep.targetErrors > 0 && total->decodedBitErrors >= sweep.targetErrors){
+        return STOP_TARGET_ERRORS;
+    }
+
+    if(sweep.targetRelCi > 0 && total->decodedBitErrors > 0){
+        double low, high;
+        wilsonInterval(total->decodedBitErrors, total->decodedBits, sweep.z, &low, &high);
+        double ber = (double) total->decodedBitErrors/total->decodedBits;
+        if((high-low)/2 <= sweep.targetRelCi*ber){
+            return STOP_CONFIDENCE;
+        }
+    }
+
+    if(total->pkts >= sweep.maxPkts){
+        return STOP_MAX_PKTS;
+    }
+
+    return STOP_NOT_STOPPED;
+}
+
+const char* stopReasonName(stopReason_e reason){
+    switch(reason){
+        case STOP_TARGET_ERRORS:
+            return "targetErrors";
+        case STOP_CONFIDENCE:
+            return "confidence";
+        case STOP_MAX_PKTS:
+            return "maxPkts";
+        default:
+            return "notStopped";
+    }
+}
+
+//***** Simulation *****
+
+/**
+ * The BPSK BER with hard decisions at the given SNR (dB, 4 samples/symbol)
+ */
+double snrToErrorProbability(double snr){
+    double esN0 = pow(10, (snr + 10*log10(SNR_OVERSAMPLE))/10);
+    return 0.5*erfc(sqrt(esN0));
+}
+
+int bitErrors(uint8_t* a, uint8_t* b, int len){
+    int errorCount = 0;
+    for(int i = 0; i<len; i++){
+        errorCount += calcHammingDist(a[i], b[i], 8);
+    }
+
+    return errorCount;
+}
+
+void simulateBlock(int pointIdx, int64_t block, convEncoderState_t* convEncState, viterbiHardState_t* viterbiState, berCounts_t* counts){
+    double errorProbability = sweep.points[pointIdx].errorProbability;
+
+    errorInjector_t injector;
+    errorInjectorInit(&injector, errorProbability, blockSeed(sweep.seed, pointIdx, block));
+
+    memset(counts, 0, sizeof(berCounts_t));
+
+    for(int64_t pkt = 0; pkt<sweep.blockPkts; pkt++){
+        uint8_t uncodedPkt[ENCODE_PKT_BYTE_LEN];
+        for(int j = 0; j<ENCODE_PKT_BYTE_LEN; j++){
+            uncodedPkt[j] = (uint8_t) xoshiro256ssNext(&injector.rng);
+        }
+
+        uint8_t codedSegments[CODED_SEGMENTS_LEN];
+        convEnc(convEncState, uncodedPkt, codedSegments, ENCODE_PKT_BYTE_LEN, true);
+
+        //Flip the coded bits with the channel error probability (IID)
+        counts->codedBitErrors += errorInjectorCorruptSegments(&injector, codedSegments, CODED_SEGMENTS_LEN, n);
+        counts->codedBits += CODED_SEGMENTS_LEN*n;
+
+        uint8_t decodedBytes[ENCODE_PKT_BYTE_LEN];
+        int decodedBytesReturned = VITERBI_DECODER_HARD(viterbiState, codedSegments, decodedBytes, CODED_SEGMENTS_LEN, true);
+        if(decodedBytesReturned != ENCODE_PKT_BYTE_LEN){
+            printf("Decoder returned %d bytes, expected %d ... exiting\n", decodedBytesReturned, ENCODE_PKT_BYTE_LEN);
+            exit(1);
+        }
+
+        int pktBitErrors = bitErrors(uncodedPkt, decodedBytes, ENCODE_PKT_BYTE_LEN);
+        counts->decodedBits += 8*ENCODE_PKT_BYTE_LEN;
+        counts->decodedBitErrors += pktBitErrors;
+        counts->pkts++;
+        counts->pktErrors += pktBitErrors > 0 ? 1 : 0;
+    }
+}
+
+void addCounts(berCounts_t* total, const berCounts_t* counts){
+    total->codedBits += counts->codedBits;
+    total->codedBitErrors += counts->codedBitErrors;
+    total->decodedBits += counts->decodedBits;
+    total->decodedBitErrors += counts->decodedBitErrors;
+    total->pkts += counts->pkts;
+    total->pktErrors += counts->pktErrors;
+}
+
+void* sweepThread(void* arg){
+    convEncoderState_t convEncState;
+    resetConvEncoder(&convEncState);
+    initConvEncoder(&convEncState);
+
+    viterbiHardState_t* viterbiState = (viterbiHardState_t*) aligned_alloc(64, sizeof(viterbiHardState_t)); //Contains aligned arrays
+    if(viterbiState == NULL){
+        printf("Unable to allocate the decoder ... exiting\n");
+        exit(1);
+    }
+    VITERBI_RESET(viterbiState);
+    VITERBI_INIT(viterbiState);
+
+    pthread_mutex_lock(&sweep.mutex);
+    while(sweep.currentPoint < sweep.numPoints){
+        int pointIdx = sweep.currentPoint;
+        sweepPoint_t* point = &sweep.points[pointIdx];
+
+        if(point->stopReason != STOP_NOT_STOPPED || point->nextBlock >= sweep.maxBlocks){
+            //No more work for this point.  The last thread to merge a block moves the sweep to the next point
+            if(point->stopReason != STOP_NOT_STOPPED && sweep.currentPoint == pointIdx){
+                sweep.currentPoint++;
+            }else{
+                //Wait for the outstanding blocks of this point to be merged
+                pthread_mutex_unlock(&sweep.mutex);
+                usleep(100);
+                pthread_mutex_lock(&sweep.mutex);
+            }
+            continue;
+        }
+
+        int64_t block = point->nextBlock++;
+        pthread_mutex_unlock(&sweep.mutex);
+
+        berCounts_t counts;
+        simulateBlock(pointIdx, block, &convEncState, viterbiState, &counts);
+
+        pthread_mutex_lock(&sweep.mutex);
+        point->blockCounts[block] = counts;
+        point->blockDone[block] = true;
+
+        //Merge the completed blocks in order
+        while(point->stopReason == STOP_NOT_STOPPED && point->mergedBlocks < sweep.maxBlocks && point->blockDone[point->mergedBlocks]){
+            addCounts(&point->total, &point->blockCounts[point->mergedBlocks]);
+            point->mergedBlocks++;
+            point->stopReason = checkStop(&point->total);
+        }
+
+        if(point->stopReason != STOP_NOT_STOPPED && sweep.currentPoint == pointIdx){
+            double ber = (double) point->total.decodedBitErrors/point->total.decodedBits;
+            fprintf(stderr, "Point %d: p=%e, BER=%e (%ld errors in %ld pkts, stop: %s)\n", pointIdx, point->errorProbability, ber, point->total.decodedBitErrors, point->total.pkts, stopReasonName(point->stopReason));
+            sweep.currentPoint++;
+        }
+    }
+    pthread_mutex_unlock(&sweep.mutex);
+
+    free(viterbiState);
+
+    return NULL;
+}
+
+//***** Output *****
+
+void writeCsv(FILE* out){
+    fprintf(out, "snr,channelErrorProb,codedBits,codedBitErrors,channelBer,decodedBits,decodedBitErrors,ber,berCiLow,berCiHigh,pkts,pktErrors,per,stopReason\n");
+    for(int i = 0; i<sweep.numPoints; i++){
+        sweepPoint_t* point = &sweep.points[i];
+        berCounts_t* total = &point->total;
+        double ciLow, ciHigh;
+        wilsonInterval(total->decodedBitErrors, total->decodedBits, sweep.z, &ciLow, &ciHigh);
+
+        if(isnan(point->snr)){
+            fprintf(out, ",");
+        }else{
+            fprintf(out, "%f,", point->snr);
+        }
+        fprintf(out, "%e,%ld,%ld,%e,%ld,%ld,%e,%e,%e,%ld,%ld,%e,%s\n",
+                point->errorProbability, total->codedBits, total->codedBitErrors, (double) total->codedBitErrors/total->codedBits,
+                total->decodedBits, total->decodedBitErrors, (double) total->decodedBitErrors/total->decodedBits, ciLow, ciHigh,
+                total->pkts, total->pktErrors, (double) total->pktErrors/total->pkts, stopReasonName(point->stopReason));
+    }
+}
+
+//***** CLI *****
+
+void printUsage(const char* prog){
+    printf("Usage: %s [options]\n", prog);
+    printf("  -s, --snr <start:step:stop>  SNR grid in dB (4 samples/symbol, BPSK hard decisions) (default: -5:0.5:-2)\n");
+    printf("  -p, --p <p0,p1,...>          Channel error probabilities (BSC).  Replaces the SNR grid\n");
+    printf("  -t, --threads <n>            Worker threads (default: number of online CPUs)\n");
+    printf("  -S, --seed <seed>            RNG seed (default: 9865)\n");
+    printf("  -b, --block-pkts <n>         Packets per block (default: 100)\n");
+    printf("  -m, --min-pkts <n>           Minimum packets per point before stopping (default: 1000)\n");
+    printf("  -M, --max-pkts <n>           Maximum packets per point (default: 1000000)\n");
+    printf("  -e, --target-errors <n>      Stop a point after n decoded bit errors, 0 to disable (default: 1000)\n");
+    printf("  -c, --rel-ci <r>             Stop a point when the CI half width is below r*BER, 0 to disable (default: 0.1)\n");
+    printf("  -z, --z <z>                  Standard normal quantile of the CI (default: 1.96, 95%%)\n");
+    printf("  -o, --output <file>          CSV output file, - for stdout (default: berSweep.csv)\n");
+    printf("  -h, --help                   Print this message\n");
+    printf("Decoded bit errors are bursty, so the binomial CI is optimistic.  Use a larger target error count for tighter estimates\n");
+}
+
+void addPoint(double snr, double errorProbability){
+    if(sweep.numPoints >= MAX_POINTS){
+        printf("Too many sweep points (max %d) ... exiting\n", MAX_POINTS);
+        exit(1);
+    }
+    if(!(errorProbability >= 0 && errorProbability <= 0.5)){
+        printf("Channel error probability %e is not in [0, 0.5] ... exiting\n", errorProbability);
+        exit(1);
+    }
+
+    sweepPoint_t* point = &sweep.points[sweep.numPoints++];
+    point->snr = snr;
+    point->errorProbability = errorProbability;
+}
+
+void parseSnrGrid(const char* arg){
+    double start, step, stop;
+    if(sscanf(arg, "%lf:%lf:%lf", &start, &step, &stop) != 3 || step <= 0 || stop < start){
+        printf("Invalid SNR grid: %s (expected start:step:stop) ... exiting\n", arg);
+        exit(1);
+    }
+
+    sweep.numPoints = 0;
+    int numSteps = (int) floor((stop-start)/step + 1e-9);
+    for(int i = 0; i<=numSteps; i++){
+        double snr = start + i*step;
+        addPoint(snr, snrToErrorProbability(snr));
+    }
+}
+
+void parseErrorProbabilities(const char* arg){
+    sweep.numPoints = 0;
+    char* list = strdup(arg);
+    for(char* tok = strtok(list, ","); tok != NULL; tok = strtok(NULL, ",")){
+        addPoint(NAN, atof(tok));
+    }
+    free(list);
+}
+
+int main(int argc, char* argv[]){
+    sweep.seed = 9865;
+    sweep.threads = (int) sysconf(_SC_NPROCESSORS_ONLN);
+    sweep.blockPkts = 100;
+    sweep.minPkts = 1000;
+    sweep.maxPkts = 1000000;
+    sweep.targetErrors = 1000;
+    sweep.targetRelCi = 0.1;
+    sweep.z = 1.96;
+    sweep.outputPath = "berSweep.csv";
+    sweep.numPoints = 0;
+    parseSnrGrid("-5:0.5:-2");
+
+    static struct option longOptions[] = {
+        {"snr",           required_argument, NULL, 's'},
+        {"p",             required_argument, NULL, 'p'},
+        {"threads",       required_argument, NULL, 't'},
+        {"seed",          required_argument, NULL, 'S'},
+        {"block-pkts",    required_argument, NULL, 'b'},
+        {"min-pkts",      required_argument, NULL, 'm'},
+        {"max-pkts",      required_argument, NULL, 'M'},
+        {"target-errors", required_argument, NULL, 'e'},
+        {"rel-ci",        required_argument, NULL, 'c'},
+        {"z",             required_argument, NULL, 'z'},
+        {"output",        required_argument, NULL, 'o'},
+        {"help",          no_argument,       NULL, 'h'},
+        {NULL, 0, NULL, 0}
+    };
+
+    int opt;
+    while((opt = getopt_long(argc, argv, "s:p:t:S:b:m:M:e:c:z:o:h", longOptions, NULL)) != -1){
+        switch(opt){
+            case 's':
+                parseSnrGrid(optarg);
+                break;
+            case 'p':
+                parseErrorProbabilities(optarg);
+                break;
+            case 't':
+                sweep.threads = atoi(optarg);
+                break;
+            case 'S':
+                sweep.seed = strtoull(optarg, NULL, 0);
+                break;
+            case 'b':
+                sweep.blockPkts = atoll(optarg);
+                break;
+            case 'm':
+                sweep.minPkts = atoll(optarg);
+                break;
+            case 'M':
+                sweep.maxPkts = atoll(optarg);
+                break;
+            case 'e':
+                sweep.targetErrors = atoll(optarg);
+                break;
+            case 'c':
+                sweep.targetRelCi = atof(optarg);
+                break;
+            case 'z':
+                sweep.z = atof(optarg);
+                break;
+            case 'o':
+                sweep.outputPath = optarg;
+                break;
+            case 'h':
+                printUsage(argv[0]);
+                return 0;
+            default:
+                printUsage(argv[0]);
+                exit(1);
+        }
+    }
+
+    if(sweep.threads <= 0 || sweep.threads > MAX_THREADS || sweep.blockPkts <= 0 || sweep.maxPkts <= 0 || sweep.numPoints == 0){
+        printf("Invalid sweep parameters ... exiting\n");
+        exit(1);
+    }
+
+    viterbiConfigCheck();
+
+    //The max packets are rounded up to a whole number of blocks
+    sweep.maxBlocks = (sweep.maxPkts + sweep.blockPkts - 1)/sweep.blockPkts;
+    sweep.maxPkts = sweep.maxBlocks*sweep.blockPkts;
+    if(sweep.minPkts > sweep.maxPkts){
+        sweep.minPkts = sweep.maxPkts;
+    }
+    for(int i = 0; i<sweep.numPoints; i++){
+        sweepPoint_t* point = &sweep.points[i];
+        point->nextBlock = 0;
+        point->mergedBlocks = 0;
+        point->blockCounts = (berCounts_t*) malloc(sweep.maxBlocks*sizeof(berCounts_t));
+        point->blockDone = (bool*) calloc(sweep.maxBlocks, sizeof(bool));
+        if(point->blockCounts == NULL || point->blockDone == NULL){
+            printf("Unable to allocate the block results ... exiting\n");
+            exit(1);
+        }
+        memset(&point->total, 0, sizeof(berCounts_t));
+        point->stopReason = STOP_NOT_STOPPED;
+    }
+    sweep.currentPoint = 0;
+    pthread_mutex_init(&sweep.mutex, NULL);
+
+    fprintf(stderr, "BER Sweep: K=%d, k=%d, n=%d, %d Points, %d Threads, Seed: %lu\n", K, k, n, sweep.numPoints, sweep.threads, sweep.seed);
+
+    pthread_t threads[MAX_THREADS];
+    for(int i = 0; i<sweep.threads; i++){
+        int status = pthread_create(&threads[i], NULL, sweepThread, NULL);
+        if(status != 0){
+            printf("Could not create a thread ... exiting\n");
+            exit(1);
+        }
+    }
+
+    for(int i = 0; i<sweep.threads; i++){
+        pthread_join(threads[i], NULL);
+    }
+
+    //The decoder init functions print to stdout so the CSV is written to a file by default
+    FILE* out = stdout;
+    if(strcmp(sweep.outputPath, "-") != 0){
+        out = fopen(sweep.outputPath, "w");
+        if(out == NULL){
+            printf("Could not open %s ... exiting\n", sweep.outputPath);
+            exit(1);
+        }
+    }
+
+    writeCsv(out);
+
+    if(out != stdout){
+        fclose(out);
+    }
+
+    for(int i = 0; i<sweep.numPoints; i++){
+        free(sweep.points[i].blockCounts);
+        free(sweep.points[i].blockDone);
+    }
+    pthread_mutex_destroy(&sweep.mutex);
+
+    return 0;
+}
@@ -0,0 +1,384 @@
+//Traceback depth and block size explorer
+//
+//A streaming decoder outputs each block of bits once the trellis has been run a fixed decision depth past it
+//(see viterbiDecoderHardButterflyk1Window).  A longer depth lowers the BER but costs traceback work per decoded bit
+//and adds decoding delay.  A longer block spreads the traceback over more bits but also adds delay.
+//
+//This tool decodes the same noisy packets with every combination of the given depths and block sizes and measures
+//the decoded BER, the throughput, and the decoding delay of each.  The channel is the binary symmetric channel of
+//berTestK7/berSweep at a single SNR (4 samples/symbol, BPSK with hard decisions) or channel error probability.  The full
+//packet traceback of VITERBI_DECODER_HARD is included as the reference (depth and block size reported as -1).
+//
+//A configuration is on the Pareto frontier if no other configuration has a BER, delay, and throughput which are at
+//least as good with at least one better.  The streaming configuration with the highest throughput among those meeting
+//the BER target is reported as the recommendation.  The results are written as CSV.
+
+#include "convEncode.h"
+#include "viterbiDecoder.h"
+#include "errorInjector.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <getopt.h>
+
+#if k!=1 || defined(FORCE_GENERIC_DECODER)
+    #error The traceback sweep requires the k=1 butterfly decoder
+#endif
+
+#define ENCODE_PKT_BYTE_LEN (2048/8)
+#define CODED_SEGMENTS_LEN (8*ENCODE_PKT_BYTE_LEN/k+S)
+#define SNR_OVERSAMPLE (4) //The SNR is for 4 samples per symbol (see berCurveCoded.m)
+#define MAX_DEPTHS (64)
+#define MAX_BLOCK_LENS (64)
+#define MAX_CONFIGS (MAX_DEPTHS*MAX_BLOCK_LENS+1)
+
+typedef struct{
+    int depth; //-1 for the full packet traceback
+    int blockLen; //-1 for the full packet traceback
+    int64_t decodedBits;
+    int64_t decodedBitErrors;
+    int64_t pktErrors;
+    double ber;
+    double mbps;
+    int delaySteps; //Trellis steps between receiving a coded segment and outputting its bit
+    double delayUs; //The delay at the measured throughput
+    bool pareto;
+} sweepConfig_t;
+
+typedef struct{
+    double snr; //NAN if specified by error probability
+    double errorProbability;
+    double targetBer;
+    int64_t pkts;
+    int reps; //Timed passes over the packets
+    uint64_t seed;
+    const char* outputPath;
+
+    int depths[MAX_DEPTHS];
+    int numDepths;
+    int blockLens[MAX_BLOCK_LENS];
+    int numBlockLens;
+
+    sweepConfig_t configs[MAX_CONFIGS];
+    int numConfigs;
+} tracebackSweep_t;
+
+tracebackSweep_t sweep;
+
+//From telemetry_helpers.c
+typedef struct timespec timespec_t;
+double difftimespec(timespec_t* a, timespec_t* b){
+    double a_double = a->tv_sec + (a->tv_nsec)*(0.000000001);
+    double b_double = b->tv_sec + (b->tv_nsec)*(0.000000001);
+    return a_double - b_double;
+}
+
+/**
+ * The BPSK BER with hard decisions at the given SNR (dB, 4 samples/symbol)
+ */
+double snrToErrorProbability(double snr){
+    double esN0 = pow(10, (snr + 10*log10(SNR_OVERSAMPLE))/10);
+    return 0.5*erfc(sqrt(esN0));
+}
+
+int bitErrors(uint8_t* a, uint8_t* b, int len){
+    int errorCount = 0;
+    for(int i = 0; i<len; i++){
+        errorCount += calcHammingDist(a[i], b[i], 8);
+    }
+
+    return errorCount;
+}
+
+/**
+ * Decodes every packet with the given configuration.  The BER is taken from the first pass and the throughput from the fastest pass
+ */
+void runConfig(sweepConfig_t* config, viterbiHardState_t* viterbiState, uint8_t* uncodedPkts, uint8_t* codedPkts){
+    config->decodedBits = 0;
+    config->decodedBitErrors = 0;
+    config->pktErrors = 0;
+    double bestDuration = INFINITY;
+
+    for(int rep = 0; rep<sweep.reps; rep++){
+        timespec_t startTime;
+        asm volatile ("" ::: "memory"); //Stop Re-ordering of timer
+        clock_gettime(CLOCK_MONOTONIC, &startTime);
+        asm volatile ("" ::: "memory"); //Stop Re-ordering of timer
+
+        for(int64_t pkt = 0; pkt<sweep.pkts; pkt++){
+            uint8_t* codedSegments = codedPkts+pkt*CODED_SEGMENTS_LEN;
+            uint8_t decodedBytes[ENCODE_PKT_BYTE_LEN];
+            int decodedBytesReturned;
+            if(config->depth < 0){
+                decodedBytesReturned = VITERBI_DECODER_HARD(viterbiState, codedSegments, decodedBytes, CODED_SEGMENTS_LEN, true);
+            }else{
+                decodedBytesReturned = viterbiDecoderHardButterflyk1Window(viterbiState, codedSegments, decodedBytes, CODED_SEGMENTS_LEN, config->depth, config->blockLen);
+            }
+            if(decodedBytesReturned != ENCODE_PKT_BYTE_LEN){
+                printf("Decoder returned %d bytes, expected %d ... exiting\n", decodedBytesReturned, ENCODE_PKT_BYTE_LEN);
+                exit(1);
+            }
+
+            if(rep == 0){
+                int pktBitErrors = bitErrors(uncodedPkts+pkt*ENCODE_PKT_BYTE_LEN, decodedBytes, ENCODE_PKT_BYTE_LEN);
+                config->decodedBits += 8*ENCODE_PKT_BYTE_LEN;
+                config->decodedBitErrors += pktBitErrors;
+                config->pktErrors += pktBitErrors > 0 ? 1 : 0;
+            }
+        }
+
+        timespec_t endTime;
+        asm volatile ("" ::: "memory"); //Stop Re-ordering of timer
+        clock_gettime(CLOCK_MONOTONIC, &endTime);
+        asm volatile ("" ::: "memory"); //Stop Re-ordering of timer
+        double duration = difftimespec(&endTime, &startTime);
+        bestDuration = duration < bestDuration ? duration : bestDuration;
+    }
+
+    config->ber = (double) config->decodedBitErrors/config->decodedBits;
+    config->mbps = 8.0*ENCODE_PKT_BYTE_LEN*sweep.pkts/bestDuration/1e6;
+    //The full packet traceback outputs the first bit after the whole packet is received
+    config->delaySteps = config->depth < 0 ? CODED_SEGMENTS_LEN : config->depth+config->blockLen;
+    config->delayUs = config->delaySteps/config->mbps;
+}
+
+/**
+ * True if a is at least as good as b in every objective and better in at least one
+ */
+bool dominates(const sweepConfig_t* a, const sweepConfig_t* b){
+    bool noWorse = a->ber <= b->ber && a->delaySteps <= b->delaySteps && a->mbps >= b->mbps;
+    bool better = a->ber < b->ber || a->delaySteps < b->delaySteps || a->mbps > b->mbps;
+    return noWorse && better;
+}
+
+void markPareto(){
+    for(int i = 0; i<sweep.numConfigs; i++){
+        sweep.configs[i].pareto = true;
+        for(int j = 0; j<sweep.numConfigs; j++){
+            if(j != i && dominates(&sweep.configs[j], &sweep.configs[i])){
+                sweep.configs[i].pareto = false;
+                break;
+            }
+        }
+    }
+}
+
+//***** Output *****
+
+void writeCsv(FILE* out){
+    fprintf(out, "depth,blockLen,delaySteps,delayUs,decodedBits,decodedBitErrors,ber,pktErrors,per,mbps,meetsTarget,pareto\n");
+    for(int i = 0; i<sweep.numConfigs; i++){
+        sweepConfig_t* config = &sweep.configs[i];
+        fprintf(out, "%d,%d,%d,%f,%ld,%ld,%e,%ld,%e,%f,%d,%d\n",
+                config->depth, config->blockLen, config->delaySteps, config->delayUs, config->decodedBits, config->decodedBitErrors, config->ber,
+                config->pktErrors, (double) config->pktErrors/sweep.pkts, config->mbps, config->ber <= sweep.targetBer ? 1 : 0, config->pareto ? 1 : 0);
+    }
+}
+
+void printFrontier(){
+    fprintf(stderr, "Pareto Frontier (p=%e, Target BER: %e):\n", sweep.errorProbability, sweep.targetBer);
+    const sweepConfig_t* recommended = NULL;
+    for(int i = 0; i<sweep.numConfigs; i++){
+        const sweepConfig_t* config = &sweep.configs[i];
+        if(config->pareto){
+            fprintf(stderr, "    Depth: %4d, Block: %4d, Delay: %5d steps, BER: %e, Rate: %8.3f Mbps\n", config->depth, config->blockLen, config->delaySteps, config->ber, config->mbps);
+        }
+
+        //The reference is not a streaming decoder so it is not recommended
+        if(config->depth >= 0 && config->ber <= sweep.targetBer && (recommended == NULL || config->mbps > recommended->mbps)){
+            recommended = config;
+        }
+    }
+
+    if(recommended != NULL){
+        fprintf(stderr, "Fastest streaming configuration meeting the target: Depth: %d, Block: %d, Delay: %d steps, BER: %e, Rate: %.3f Mbps\n",
+                recommended->depth, recommended->blockLen, recommended->delaySteps, recommended->ber, recommended->mbps);
+    }else{
+        fprintf(stderr, "No streaming configuration met the target BER\n");
+    }
+}
+
+//***** CLI *****
+
+void printUsage(const char* prog){
+    printf("Usage: %s [options]\n", prog);
+    printf("  -s, --snr <dB>               SNR (4 samples/symbol, BPSK hard decisions) (default: -3)\n");
+    printf("  -p, --p <p>                  Channel error probability (BSC).  Replaces the SNR\n");
+    printf("  -d, --depths <d0,d1,...>     Decision depths in trellis steps (default: 0,7,14,21,28,35,42,56,70,96)\n");
+    printf("  -B, --blocks <b0,b1,...>     Block sizes in trellis steps (default: 1,8,32,128)\n");
+    printf("  -T, --target-ber <ber>       BER target for the recommendation (default: 1e-4)\n");
+    printf("  -n, --pkts <n>               Packets of %d bytes decoded by each configuration (default: 2000)\n", ENCODE_PKT_BYTE_LEN);
+    printf("  -r, --reps <n>               Timed passes over the packets, the fastest is reported (default: 3)\n");
+    printf("  -S, --seed <seed>            RNG seed (default: 9865)\n");
+    printf("  -o, --output <file>          CSV output file, - for stdout (default: tracebackSweep.csv)\n");
+    printf("  -h, --help                   Print this message\n");
+}
+
+int parseIntList(const char* arg, int* vals, int maxVals, const char* name){
+    int count = 0;
+    char* list = strdup(arg);
+    for(char* tok = strtok(list, ","); tok != NULL; tok = strtok(NULL, ",")){
+        char* end;
+        long val = strtol(tok, &end, 0);
+        if(*end != '\0' || val < 0 || count >= maxVals){
+            printf("Invalid %s: %s (at most %d values) ... exiting\n", name, arg, maxVals);
+            exit(1);
+        }
+        vals[count++] = (int) val;
+    }
+    free(list);
+    return count;
+}
+
+int main(int argc, char* argv[]){
+    sweep.snr = -3;
+    sweep.errorProbability = snrToErrorProbability(sweep.snr);
+    sweep.targetBer = 1e-4;
+    sweep.pkts = 2000;
+    sweep.reps = 3;
+    sweep.seed = 9865;
+    sweep.outputPath = "tracebackSweep.csv";
+    sweep.numDepths = parseIntList("0,7,14,21,28,35,42,56,70,96", sweep.depths, MAX_DEPTHS, "depths");
+    sweep.numBlockLens = parseIntList("1,8,32,128", sweep.blockLens, MAX_BLOCK_LENS, "block sizes");
+
+    static struct option longOptions[] = {
+        {"snr",        required_argument, NULL, 's'},
+        {"p",          required_argument, NULL, 'p'},
+        {"depths",     required_argument, NULL, 'd'},
+        {"blocks",     required_argument, NULL, 'B'},
+        {"target-ber", required_argument, NULL, 'T'},
+        {"pkts",       required_argument, NULL, 'n'},
+        {"reps",       required_argument, NULL, 'r'},
+        {"seed",       required_argument, NULL, 'S'},
+        {"output",     required_argument, NULL, 'o'},
+        {"help",       no_argument,       NULL, 'h'},
+        {NULL, 0, NULL, 0}
+    };
+
+    int opt;
+    while((opt = getopt_long(argc, argv, "s:p:d:B:T:n:r:S:o:h", longOptions, NULL)) != -1){
+        switch(opt){
+            case 's':
+                sweep.snr = atof(optarg);
+                sweep.errorProbability = snrToErrorProbability(sweep.snr);
+                break;
+            case 'p':
+                sweep.snr = NAN;
+                sweep.errorProbability = atof(optarg);
+                break;
+            case 'd':
+                sweep.numDepths = parseIntList(optarg, sweep.depths, MAX_DEPTHS, "depths");
+                break;
+            case 'B':
+                sweep.numBlockLens = parseIntList(optarg, sweep.blockLens, MAX_BLOCK_LENS, "block sizes");
+                break;
+            case 'T':
+                sweep.targetBer = atof(optarg);
+                break;
+            case 'n':
+                sweep.pkts = atoll(optarg);
+                break;
+            case 'r':
+                sweep.reps = atoi(optarg);
+                break;
+            case 'S':
+                sweep.seed = strtoull(optarg, NULL, 0);
+                break;
+            case 'o':
+                sweep.outputPath = optarg;
+                break;
+            case 'h':
+                printUsage(argv[0]);
+                return 0;
+            default:
+                printUsage(argv[0]);
+                exit(1);
+        }
+    }
+
+    if(sweep.pkts <= 0 || sweep.reps <= 0 || sweep.numDepths == 0 || sweep.numBlockLens == 0 || !(sweep.errorProbability >= 0 && sweep.errorProbability <= 0.5)){
+        printf("Invalid sweep parameters ... exiting\n");
+        exit(1);
+    }
+    for(int i = 0; i<sweep.numBlockLens; i++){
+        if(sweep.blockLens[i] == 0){
+            printf("Block sizes must be at least 1 ... exiting\n");
+            exit(1);
+        }
+    }
+
+    viterbiConfigCheck();
+
+    convEncoderState_t convEncState;
+    resetConvEncoder(&convEncState);
+    initConvEncoder(&convEncState);
+
+    viterbiHardState_t* viterbiState = (viterbiHardState_t*) aligned_alloc(64, sizeof(viterbiHardState_t)); //Contains aligned arrays
+    uint8_t* uncodedPkts = (uint8_t*) malloc(sweep.pkts*ENCODE_PKT_BYTE_LEN);
+    uint8_t* codedPkts = (uint8_t*) malloc(sweep.pkts*CODED_SEGMENTS_LEN);
+    if(viterbiState == NULL || uncodedPkts == NULL || codedPkts == NULL){
+        printf("Unable to allocate the packets ... exiting\n");
+        exit(1);
+    }
+    VITERBI_RESET(viterbiState);
+    VITERBI_INIT(viterbiState);
+
+    //Every configuration decodes the same noisy packets so the BERs are compared on the same channel errors
+    errorInjector_t injector;
+    errorInjectorInit(&injector, sweep.errorProbability, sweep.seed);
+    for(int64_t pkt = 0; pkt<sweep.pkts; pkt++){
+        uint8_t* uncodedPkt = uncodedPkts+pkt*ENCODE_PKT_BYTE_LEN;
+        for(int j = 0; j<ENCODE_PKT_BYTE_LEN; j++){
+            uncodedPkt[j] = (uint8_t) xoshiro256ssNext(&injector.rng);
+        }
+
+        uint8_t* codedSegments = codedPkts+pkt*CODED_SEGMENTS_LEN;
+        convEnc(&convEncState, uncodedPkt, codedSegments, ENCODE_PKT_BYTE_LEN, true);
+        errorInjectorCorruptSegments(&injector, codedSegments, CODED_SEGMENTS_LEN, n);
+    }
+
+    fprintf(stderr, "Traceback Sweep: K=%d, k=%d, n=%d, p=%e, %d Depths x %d Block Sizes, %ld Packets\n", K, k, n, sweep.errorProbability, sweep.numDepths, sweep.numBlockLens, sweep.pkts);
+
+    sweep.numConfigs = 0;
+    sweepConfig_t* reference = &sweep.configs[sweep.numConfigs++];
+    reference->depth = -1;
+    reference->blockLen = -1;
+    for(int i = 0; i<sweep.numDepths; i++){
+        for(int j = 0; j<sweep.numBlockLens; j++){
+            sweepConfig_t* config = &sweep.configs[sweep.numConfigs++];
+            config->depth = sweep.depths[i];
+            config->blockLen = sweep.blockLens[j];
+        }
+    }
+
+    for(int i = 0; i<sweep.numConfigs; i++){
+        runConfig(&sweep.configs[i], viterbiState, uncodedPkts, codedPkts);
+    }
+
+    markPareto();
+    printFrontier();
+
+    //The decoder init functions print to stdout so the CSV is written to a file by default
+    FILE* out = stdout;
+    if(strcmp(sweep.outputPath, "-") != 0){
+        out = fopen(sweep.outputPath, "w");
+        if(out == NULL){
+            printf("Could not open %s ... exiting\n", sweep.outputPath);
+            exit(1);
+        }
+    }
+
+    writeCsv(out);
+
+    if(out != stdout){
+        fclose(out);
+    }
+
+    free(viterbiState);
+    free(uncodedPkts);
+    free(codedPkts);
+
+    return 0;
+}
@@ -0,0 +1,947 @@
+//Checks that the optimized encoder and decoder variants produce bit-exact results
+//when compared to the reference implementations
+
+#include "convEncode.h"
+#include "convEncodeParallel.h"
+#include "viterbiDecoder.h"
+#include "bcjrDecoderButterflyk1.h"
+#include "viterbiFastPathDecoder.h"
+#include "viterbiPipelinedDecoder.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+#define RAND_SEED (2718)
+#define MAX_TEST_BYTES (64*1024)
+#define RANDOM_TRIALS (50)
+#define BATCH_TEST_MAX_FRAMES (256)
+#define PIPELINE_TEST_GROUP (4) //Packets submitted before waiting
+#define SYMBOL_TEST_MAX_BYTES (MAX_PKT_LEN_UNCODED_BITS/8) //The reference symbols are mapped into the soft decoder test buffers
+
+uint8_t uncodedBuf[MAX_TEST_BYTES];
+uint8_t codedRef[MAX_TEST_BYTES*8/k+S];
+uint8_t codedTest[MAX_TEST_BYTES*8/k+S];
+
+//The decoder states are large, keep them off the stack
+viterbiHardState_t viterbiState;
+bcjrStateButterflyk1_t bcjrState;
+viterbiSovaState_t sovaState;
+viterbiFastPathState_t fastPathState;
+viterbiSoftState_t softState;
+uint8_t decodedRef[MAX_PKT_LEN_UNCODED_BITS/8];
+uint8_t decodedTest[MAX_PKT_LEN_UNCODED_BITS/8];
+BCJR_LLR_TYPE llrs[MAX_PKT_LEN_UNCODED_BITS];
+int8_t reliability[MAX_PKT_LEN_UNCODED_BITS];
+float softSamples[(MAX_PKT_LEN_UNCODED_BITS/k+S)*n];
+int16_t softSamplesInt16[(MAX_PKT_LEN_UNCODED_BITS/k+S)*n];
+int8_t symbolsInt8[(SYMBOL_TEST_MAX_BYTES*8/k+S)*n];
+int16_t symbolsInt16[(SYMBOL_TEST_MAX_BYTES*8/k+S)*n];
+float symbolsFloat[(SYMBOL_TEST_MAX_BYTES*8/k+S)*n];
+viterbiBatchFrame_t batchFrames[BATCH_TEST_MAX_FRAMES];
+uint8_t pipelineRef[PIPELINE_TEST_GROUP][MAX_PKT_LEN_UNCODED_BITS/8];
+uint8_t pipelineDecoded[PIPELINE_TEST_GROUP][MAX_PKT_LEN_UNCODED_BITS/8];
+
+/**
+ * Returns a random length which is a multiple of k bytes and is at most maxBytes
+ */
+int randLen(int maxBytes){
+    int len = rand() % (maxBytes+1);
+    return len/k*k;
+}
+
+void fillRandom(uint8_t* buf, int len){
+    for(int i = 0; i<len; i++){
+        buf[i] = (uint8_t) rand();
+    }
+}
+
+bool compareCoded(const char* name, uint8_t* ref, int refLen, uint8_t* test, int testLen){
+    if(refLen != testLen){
+        printf("\t%s: Got %d coded segments, Expected %d\n", name, testLen, refLen);
+        return false;
+    }
+
+    for(int i = 0; i<refLen; i++){
+        if(ref[i] != test[i]){
+            printf("\t%s: Coded[%d]: Got 0x%x, Expected 0x%x\n", name, i, test[i], ref[i]);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+int encodeReference(uint8_t* uncoded, uint8_t* coded, int bytes, bool last){
+    convEncoderState_t convEncState;
+    resetConvEncoder(&convEncState);
+    initConvEncoder(&convEncState);
+    return convEnc(&convEncState, uncoded, coded, bytes, last);
+}
+
+bool testParallelEncoder(){
+    printf("********** Parallel Encoder Test **********\n");
+    bool failed = false;
+
+    int threadCounts[] = {1, 2, 4};
+    int chunkSizes[] = {1, 7, 64, 1000};
+
+    for(int threadInd = 0; threadInd<sizeof(threadCounts)/sizeof(threadCounts[0]); threadInd++){
+        for(int chunkInd = 0; chunkInd<sizeof(chunkSizes)/sizeof(chunkSizes[0]); chunkInd++){
+            convEncParallelPool_t pool;
+            convEncParallelInit(&pool, threadCounts[threadInd], chunkSizes[chunkInd]);
+
+            for(int trial = 0; trial<RANDOM_TRIALS && !failed; trial++){
+                int len = randLen(trial == 0 ? 0 : 4096);
+                fillRandom(uncodedBuf, len);
+
+                int refLen = encodeReference(uncodedBuf, codedRef, len, true);
+                int testLen = convEncParallel(&pool, uncodedBuf, codedTest, len, true);
+
+                if(!compareCoded("Parallel", codedRef, refLen, codedTest, testLen)){
+                    printf("\tThreads: %d, Chunk Bytes: %d, Length: %d\n", threadCounts[threadInd], chunkSizes[chunkInd], len);
+                    failed = true;
+                }
+            }
+
+            //Check that the state is carried between calls which are not the last in the packet
+            if(!failed){
+                int lenA = randLen(2048);
+                int lenB = randLen(2048);
+                fillRandom(uncodedBuf, lenA+lenB);
+
+                int refLen = encodeReference(uncodedBuf, codedRef, lenA+lenB, true);
+                int testLen = convEncParallel(&pool, uncodedBuf, codedTest, lenA, false);
+                testLen += convEncParallel(&pool, uncodedBuf+lenA, codedTest+testLen, lenB, true);
+
+                if(!compareCoded("Parallel (Split)", codedRef, refLen, codedTest, testLen)){
+                    printf("\tThreads: %d, Chunk Bytes: %d, Lengths: %d, %d\n", threadCounts[threadInd], chunkSizes[chunkInd], lenA, lenB);
+                    failed = true;
+                }
+            }
+
+            convEncParallelDestroy(&pool);
+        }
+    }
+
+    //Large buffer
+    if(!failed){
+        convEncParallelPool_t pool;
+        convEncParallelInit(&pool, 4, 0);
+
+        int len = MAX_TEST_BYTES/k*k;
+        fillRandom(uncodedBuf, len);
+        int refLen = encodeReference(uncodedBuf, codedRef, len, true);
+        int testLen = convEncParallel(&pool, uncodedBuf, codedTest, len, true);
+        if(!compareCoded("Parallel (Large)", codedRef, refLen, codedTest, testLen)){
+            failed = true;
+        }
+
+        convEncParallelDestroy(&pool);
+    }
+
+    printf("\t%s\n", failed ? "Failed" : "Passed");
+    return !failed;
+}
+
+bool testBitSlicedEncoder(){
+    printf("********** Bit-Sliced Encoder Test **********\n");
+    bool failed = false;
+
+    for(int trial = 0; trial<RANDOM_TRIALS*4 && !failed; trial++){
+        int len = randLen(trial < 16 ? trial : 4096);
+        fillRandom(uncodedBuf, len);
+
+        int refLen = encodeReference(uncodedBuf, codedRef, len, true);
+
+        convEncoderState_t convEncState;
+        resetConvEncoder(&convEncState);
+        initConvEncoder(&convEncState);
+        int testLen = convEncBitSliced(&convEncState, uncodedBuf, codedTest, len, true);
+
+        if(!compareCoded("Bit-Sliced", codedRef, refLen, codedTest, testLen)){
+            printf("\tLength: %d\n", len);
+            failed = true;
+        }
+    }
+
+    //Check that the state is carried between calls, including calls which are not a multiple of the word size
+    for(int trial = 0; trial<RANDOM_TRIALS && !failed; trial++){
+        int lenA = randLen(300);
+        int lenB = randLen(300);
+        int lenC = randLen(300);
+        fillRandom(uncodedBuf, lenA+lenB+lenC);
+
+        int refLen = encodeReference(uncodedBuf, codedRef, lenA+lenB+lenC, true);
+
+        convEncoderState_t convEncState;
+        resetConvEncoder(&convEncState);
+        initConvEncoder(&convEncState);
+        int testLen = convEncBitSliced(&convEncState, uncodedBuf, codedTest, lenA, false);
+        testLen += convEnc(&convEncState, uncodedBuf+lenA, codedTest+testLen, lenB, false);
+        testLen += convEncBitSliced(&convEncState, uncodedBuf+lenA+lenB, codedTest+testLen, lenC, true);
+
+        if(!compareCoded("Bit-Sliced (Split)", codedRef, refLen, codedTest, testLen)){
+            printf("\tLengths: %d, %d, %d\n", lenA, lenB, lenC);
+            failed = true;
+        }
+    }
+
+    printf("\t%s\n", failed ? "Failed" : "Passed");
+    return !failed;
+}
+
+bool testBcjrDecoder(){
+    printf("********** Max-Log-MAP (BCJR) Decoder Test **********\n");
+    bool failed = false;
+
+    VITERBI_RESET(&viterbiState);
+    VITERBI_INIT(&viterbiState);
+    resetBcjrDecoderButterflyk1(&bcjrState);
+    bcjrInitButterflyk1(&bcjrState);
+
+    for(int trial = 0; trial<RANDOM_TRIALS && !failed; trial++){
+        int len = randLen(MAX_PKT_LEN_UNCODED_BITS/8 - k);
+        if(len == 0){
+            len = k;
+        }
+        fillRandom(uncodedBuf, len);
+        int codedLen = encodeReference(uncodedBuf, codedRef, len, true);
+
+        //Introduce sparse errors (odd trials) which both decoders should correct
+        int errors = 0;
+        if(trial%2 == 1){
+            for(int seg = rand()%64; seg<codedLen; seg+=64+rand()%64){
+                codedRef[seg] ^= 1 << (rand()%n);
+                errors++;
+            }
+        }
+
+        int refLen = VITERBI_DECODER_HARD(&viterbiState, codedRef, decodedRef, codedLen, true);
+
+        //Provide the segments over 2 calls to check the buffering
+        int split = rand()%(codedLen+1);
+        int testLen = bcjrDecoderButterflyk1(&bcjrState, codedRef, decodedTest, llrs, split, false);
+        testLen += bcjrDecoderButterflyk1(&bcjrState, codedRef+split, decodedTest, llrs, codedLen-split, true);
+
+        if(refLen != testLen || memcmp(decodedRef, decodedTest, refLen) != 0 || memcmp(uncodedBuf, decodedTest, len) != 0){
+            printf("\tBCJR: Decoded packet does not match (Length: %d, Errors: %d)\n", len, errors);
+            failed = true;
+        }
+
+        //The hard decisions are the signs of the LLRs
+        for(int bit = 0; bit<len*8 && !failed; bit++){
+            uint8_t decodedBit = (decodedTest[bit/8] >> (7-bit%8)) & 1;
+            if(llrs[bit] == 0 || (llrs[bit] < 0) != decodedBit){
+                printf("\tBCJR: LLR[%d]=%d does not match decoded bit %d\n", bit, llrs[bit], decodedBit);
+                failed = true;
+            }
+        }
+    }
+
+    printf("\t%s\n", failed ? "Failed" : "Passed");
+    return !failed;
+}
+
+bool testSovaDecoder(){
+    printf("********** SOVA Decoder Test **********\n");
+    bool failed = false;
+
+    VITERBI_RESET(&viterbiState);
+    VITERBI_INIT(&viterbiState);
+    resetViterbiDecoderSovaButterflyk1(&sovaState);
+    viterbiInitSovaButterflyk1(&sovaState);
+
+    for(int trial = 0; trial<RANDOM_TRIALS && !failed; trial++){
+        int len = randLen(MAX_PKT_LEN_UNCODED_BITS/8 - k);
+        if(len == 0){
+            len = k;
+        }
+        fillRandom(uncodedBuf, len);
+        int codedLen = encodeReference(uncodedBuf, codedRef, len, true);
+
+        //Introduce errors (odd trials).  Some may not be correctable
+        int errors = 0;
+        if(trial%2 == 1){
+            for(int seg = rand()%16; seg<codedLen; seg+=1+rand()%12){
+                codedRef[seg] ^= 1 << (rand()%n);
+                errors++;
+            }
+        }
+
+        int refLen = VITERBI_DECODER_HARD(&viterbiState, codedRef, decodedRef, codedLen, true);
+
+        //Provide the segments over 2 calls to check the state is carried
+        int split = rand()%(codedLen+1);
+        int testLen = viterbiDecoderSovaButterflyk1(&sovaState, codedRef, decodedTest, reliability, split, false);
+        testLen += viterbiDecoderSovaButterflyk1(&sovaState, codedRef+split, decodedTest, reliability, codedLen-split, true);
+
+        //The hard decisions should match the hard decision decoder exactly
+        if(refLen != testLen || memcmp(decodedRef, decodedTest, refLen) != 0){
+            printf("\tSOVA: Decoded packet does not match the hard decision decoder (Length: %d, Errors: %d)\n", len, errors);
+            failed = true;
+        }
+
+        //Without errors, every bit has a non-zero reliability.  With errors, the incorrectly decoded bits should be less reliable on average
+        int64_t correctReliability = 0;
+        int64_t incorrectReliability = 0;
+        int incorrectBits = 0;
+        for(int bit = 0; bit<len*8 && !failed; bit++){
+            uint8_t decodedBit = (decodedTest[bit/8] >> (7-bit%8)) & 1;
+            uint8_t origBit = (uncodedBuf[bit/8] >> (7-bit%8)) & 1;
+            if(reliability[bit] < 0 || (errors == 0 && reliability[bit] == 0)){
+                printf("\tSOVA: Reliability[%d]=%d is out of range\n", bit, reliability[bit]);
+                failed = true;
+            }
+
+            if(decodedBit == origBit){
+                correctReliability += reliability[bit];
+            }else{
+                incorrectReliability += reliability[bit];
+                incorrectBits++;
+            }
+        }
+
+        if(incorrectBits > 0 && incorrectBits < len*8 && (double) incorrectReliability/incorrectBits >= (double) correctReliability/(len*8-incorrectBits)){
+            printf("\tSOVA: Incorrectly decoded bits are not less reliable on average\n");
+            failed = true;
+        }
+    }
+
+    printf("\t%s\n", failed ? "Failed" : "Passed");
+    return !failed;
+}
+
+/**
+ * Maps coded segments to BPSK samples (0 -> +amplitude, 1 -> -amplitude), first coded bit first
+ */
+void codedToSamples(const uint8_t* coded, int codedLen, float amplitude, float* samples, int16_t* samplesInt16){
+    for(int seg = 0; seg<codedLen; seg++){
+        for(int j = 0; j<n; j++){
+            float sample = ((coded[seg] >> (n-1-j)) & 1) ? -amplitude : amplitude;
+            samples[seg*n+j] = sample;
+            samplesInt16[seg*n+j] = (int16_t) sample;
+        }
+    }
+}
+
+/**
+ * Encodes a buffer with each symbol encoder over 2 calls and compares the symbols to the mapped reference coded segments
+ */
+bool checkSymbolEncoders(int lenA, int lenB){
+    bool failed = false;
+    int refLen = encodeReference(uncodedBuf, codedRef, lenA+lenB, true);
+    codedToSamples(codedRef, refLen, 1.0f, softSamples, softSamplesInt16);
+
+    convEncoderState_t convEncState;
+    resetConvEncoder(&convEncState);
+    initConvEncoder(&convEncState);
+
+    int testLen = convEncBpskInt8(&convEncState, uncodedBuf, symbolsInt8, lenA, false);
+    testLen += convEncBpskInt8(&convEncState, uncodedBuf+lenA, symbolsInt8+testLen, lenB, true);
+    bool match = testLen == refLen*n;
+    for(int i = 0; i<refLen*n && match; i++){
+        match = symbolsInt8[i] == softSamplesInt16[i];
+    }
+    if(!match){
+        printf("\tBPSK int8: Symbols do not match the mapped coded segments (Lengths: %d, %d)\n", lenA, lenB);
+        failed = true;
+    }
+
+    testLen = convEncBpskInt16(&convEncState, uncodedBuf, symbolsInt16, lenA, false);
+    testLen += convEncBpskInt16(&convEncState, uncodedBuf+lenA, symbolsInt16+testLen, lenB, true);
+    if(testLen != refLen*n || memcmp(symbolsInt16, softSamplesInt16, refLen*n*sizeof(int16_t)) != 0){
+        printf("\tBPSK int16: Symbols do not match the mapped coded segments (Lengths: %d, %d)\n", lenA, lenB);
+        failed = true;
+    }
+
+    testLen = convEncBpskFloat(&convEncState, uncodedBuf, symbolsFloat, lenA, false);
+    testLen += convEncBpskFloat(&convEncState, uncodedBuf+lenA, symbolsFloat+testLen, lenB, true);
+    if(testLen != refLen*n || memcmp(symbolsFloat, softSamples, refLen*n*sizeof(float)) != 0){
+        printf("\tBPSK float: Symbols do not match the mapped coded segments (Lengths: %d, %d)\n", lenA, lenB);
+        failed = true;
+    }
+
+    #if n%2 == 0
+        testLen = convEncQpskFloat(&convEncState, uncodedBuf, symbolsFloat, lenA, false);
+        testLen += convEncQpskFloat(&convEncState, uncodedBuf+lenA, symbolsFloat+2*testLen, lenB, true);
+        match = testLen == refLen*n/2;
+        for(int i = 0; i<refLen*n && match; i++){
+            match = symbolsFloat[i] == softSamples[i]*0.70710678118654752f;
+        }
+        if(!match){
+            printf("\tQPSK float: Symbols do not match the mapped coded segments (Lengths: %d, %d)\n", lenA, lenB);
+            failed = true;
+        }
+    #endif
+
+    return !failed;
+}
+
+bool testSymbolEncoder(){
+    printf("********** Symbol Mapped Encoder Test **********\n");
+    bool failed = false;
+
+    //Provide the bytes over 2 calls to check the state is carried, including calls which are not a multiple of the word size
+    for(int trial = 0; trial<RANDOM_TRIALS*2 && !failed; trial++){
+        int lenA = randLen(trial < 16 ? trial : SYMBOL_TEST_MAX_BYTES/2);
+        int lenB = randLen(trial < 16 ? 16-trial : SYMBOL_TEST_MAX_BYTES/2);
+        fillRandom(uncodedBuf, lenA+lenB);
+
+        failed |= !checkSymbolEncoders(lenA, lenB);
+    }
+
+    printf("\t%s\n", failed ? "Failed" : "Passed");
+    return !failed;
+}
+
+bool testSoftDecoder(){
+    printf("********** Soft Decision Decoder Test **********\n");
+    bool failed = false;
+
+    VITERBI_RESET(&viterbiState);
+    VITERBI_INIT(&viterbiState);
+    resetViterbiDecoderSoftButterflyk1(&softState);
+    viterbiInitSoftButterflyk1(&softState);
+
+    for(int trial = 0; trial<RANDOM_TRIALS && !failed; trial++){
+        int len = randLen(MAX_PKT_LEN_UNCODED_BITS/8 - k);
+        if(len == 0){
+            len = k;
+        }
+        fillRandom(uncodedBuf, len);
+        int codedLen = encodeReference(uncodedBuf, codedRef, len, true);
+
+        //With saturated samples, the soft decision decoder should match the hard decision decoder exactly (including the errors)
+        memcpy(codedTest, codedRef, codedLen);
+        for(int seg = rand()%16; seg<codedLen; seg+=1+rand()%12){
+            codedTest[seg] ^= 1 << (rand()%n);
+        }
+        codedToSamples(codedTest, codedLen, 1.0f, softSamples, softSamplesInt16);
+
+        int refLen = VITERBI_DECODER_HARD(&viterbiState, codedTest, decodedRef, codedLen, true);
+
+        //Provide the samples over 2 calls to check the state is carried
+        int split = rand()%(codedLen+1);
+        int testLen = viterbiDecoderSoftButterflyk1(&softState, softSamples, VITERBI_SOFT_MAX, decodedTest, split, false);
+        testLen += viterbiDecoderSoftButterflyk1(&softState, softSamples+split*n, VITERBI_SOFT_MAX, decodedTest, codedLen-split, true);
+        if(refLen != testLen || memcmp(decodedRef, decodedTest, refLen) != 0){
+            printf("\tSoft: Decoded packet with saturated samples does not match the hard decision decoder (Length: %d)\n", len);
+            failed = true;
+        }
+
+        //Erase some of the samples (odd trials).  Erasures do not cause errors at this density
+        codedToSamples(codedRef, codedLen, 1000.0f, softSamples, softSamplesInt16);
+        int erasures = 0;
+        if(trial%2 == 1){
+            for(int sample = rand()%16; sample<codedLen*n; sample+=1+rand()%12){
+                softSamples[sample] = 0;
+                softSamplesInt16[sample] = 0;
+                erasures++;
+            }
+        }
+
+        float scale = (float) VITERBI_SOFT_MAX/1000.0f;
+        testLen = viterbiDecoderSoftButterflyk1(&softState, softSamples, scale, decodedTest, codedLen, true);
+        if(testLen != len || memcmp(uncodedBuf, decodedTest, len) != 0){
+            printf("\tSoft: Decoded packet does not match the original (Length: %d, Erasures: %d)\n", len, erasures);
+            failed = true;
+        }
+
+        //The int16 samples should be decoded the same as the float samples
+        testLen = viterbiDecoderSoftInt16Butterflyk1(&softState, softSamplesInt16, scale, decodedRef, codedLen, true);
+        if(testLen != len || memcmp(decodedRef, decodedTest, len) != 0){
+            printf("\tSoft: Decoded packet from int16 samples does not match float samples (Length: %d)\n", len);
+            failed = true;
+        }
+    }
+
+    printf("\t%s\n", failed ? "Failed" : "Passed");
+    return !failed;
+}
+
+bool testTraceback(){
+    printf("********** Multi-Step Traceback Test **********\n");
+    bool failed = false;
+
+    #if k==1 && !defined(FORCE_GENERIC_DECODER)
+        //Random decisions exercise paths through every state, not just the paths a decoder would select.  Some of the
+        //packets end part way through a byte (and through a multi-step)
+        for(int trial = 0; trial<RANDOM_TRIALS*4 && !failed; trial++){
+            int len = randLen(trial < 16 ? trial+1 : MAX_PKT_LEN_UNCODED_BITS/8);
+            if(len == 0){
+                len = 1;
+            }
+            unsigned int unusedBits = trial%2 == 0 ? 0 : rand()%8;
+            unsigned int iterations = len*8-unusedBits+S;
+            for(unsigned int t = 0; t<iterations; t++){
+                for(int state = 0; state<NUM_STATES; state++){
+                    viterbiState.tracebackBufs[t][state] = rand() & 1;
+                }
+            }
+
+            int refLen = viterbiTracebackButterflyk1Reference(viterbiState.tracebackBufs, iterations, decodedRef);
+            int testLen = viterbiTracebackButterflyk1(viterbiState.tracebackBufs, iterations, decodedTest);
+            if(refLen != testLen || memcmp(decodedRef, decodedTest, refLen) != 0){
+                printf("\tTraceback: Does not match the reference traceback (Length: %d bits)\n", iterations-S);
+                failed = true;
+            }
+        }
+    #endif
+
+    printf("\t%s\n", failed ? "Failed" : "Passed");
+    return !failed;
+}
+
+bool testWindowDecoder(){
+    printf("********** Sliding Window Decoder Test **********\n");
+    bool failed = false;
+
+    #if k==1 && !defined(FORCE_GENERIC_DECODER)
+        VITERBI_RESET(&viterbiState);
+        VITERBI_INIT(&viterbiState);
+
+        for(int trial = 0; trial<RANDOM_TRIALS && !failed; trial++){
+            int len = 1+randLen(MAX_PKT_LEN_UNCODED_BITS/8-1);
+            fillRandom(uncodedBuf, len);
+            int codedLen = encodeReference(uncodedBuf, codedRef, len, true);
+
+            //Without channel errors, the best state is on the transmitted path for any depth and block size
+            unsigned int depth = rand()%(8*S+1);
+            unsigned int blockLen = 1+rand()%128;
+            int testLen = viterbiDecoderHardButterflyk1Window(&viterbiState, codedRef, decodedTest, codedLen, depth, blockLen);
+            if(testLen != len || memcmp(decodedTest, uncodedBuf, len) != 0){
+                printf("\tWindow: Noiseless packet not decoded (Length: %d, Depth: %u, Block: %u)\n", len, depth, blockLen);
+                failed = true;
+            }
+
+            //A block as long as the packet is the full packet traceback
+            memcpy(codedTest, codedRef, codedLen);
+            for(int i = 0; i<codedLen/8; i++){
+                codedTest[rand()%codedLen] ^= 1 << (rand()%n);
+            }
+            int refLen = VITERBI_DECODER_HARD(&viterbiState, codedTest, decodedRef, codedLen, true);
+            testLen = viterbiDecoderHardButterflyk1Window(&viterbiState, codedTest, decodedTest, codedLen, depth, codedLen);
+            if(refLen != testLen || memcmp(decodedRef, decodedTest, refLen) != 0){
+                printf("\tWindow: Full packet block does not match the hard decoder (Length: %d)\n", len);
+                failed = true;
+            }
+        }
+
+        //The traceback must start exactly depth steps past each block.  Depths which round up to the same multiple of the
+        //block size would otherwise give the same decisions.  Noisy packets are decoded with 2 such depths
+        bool depthsDiffer = false;
+        for(int trial = 0; trial<RANDOM_TRIALS && !failed && !depthsDiffer; trial++){
+            int len = MAX_PKT_LEN_UNCODED_BITS/8;
+            fillRandom(uncodedBuf, len);
+            int codedLen = encodeReference(uncodedBuf, codedRef, len, true);
+            for(int i = 0; i<codedLen/4; i++){
+                codedRef[rand()%codedLen] ^= 1 << (rand()%n);
+            }
+
+            viterbiDecoderHardButterflyk1Window(&viterbiState, codedRef, decodedRef, codedLen, 1, 32);
+            viterbiDecoderHardButterflyk1Window(&viterbiState, codedRef, decodedTest, codedLen, 16, 32);
+            //Only the start of the packet is compared since the blocks near the end are traced back from the terminating state
+            depthsDiffer = memcmp(decodedRef, decodedTest, len/2) != 0;
+        }
+        if(!failed && !depthsDiffer){
+            printf("\tWindow: Depths 1 and 16 with 32 step blocks gave the same decisions\n");
+            failed = true;
+        }
+    #endif
+
+    printf("\t%s\n", failed ? "Failed" : "Passed");
+    return !failed;
+}
+
+bool testBatchDecoder(){
+    printf("********** Batch Decoder Test **********\n");
+    bool failed = false;
+
+    VITERBI_RESET(&viterbiState);
+    VITERBI_INIT(&viterbiState);
+
+    for(int trial = 0; trial<RANDOM_TRIALS && !failed; trial++){
+        //Pack small frames back to back with occasional gaps in the coded and uncoded buffers
+        int numFrames = 1+rand()%BATCH_TEST_MAX_FRAMES;
+        int codedOffset = 0;
+        int uncodedOffset = 0;
+        int framesUsed = 0;
+        for(int frame = 0; frame<numFrames; frame++){
+            int len = k+randLen(64-k);
+            int codedGap = rand()%4 == 0 ? rand()%8 : 0;
+            int uncodedGap = rand()%4 == 0 ? rand()%8 : 0;
+            if(uncodedOffset+uncodedGap+len > (int) sizeof(decodedTest) || codedOffset+codedGap+len*8/k+S > MAX_TEST_BYTES*8/k+S){
+                break;
+            }
+
+            fillRandom(uncodedBuf+uncodedOffset+uncodedGap, len);
+            batchFrames[frame].codedOffset = codedOffset+codedGap;
+            batchFrames[frame].numSegments = encodeReference(uncodedBuf+uncodedOffset+uncodedGap, codedRef+codedOffset+codedGap, len, true);
+            batchFrames[frame].uncodedOffset = uncodedOffset+uncodedGap;
+
+            //Introduce errors into some frames
+            if(rand()%2 == 1){
+                codedRef[codedOffset+codedGap+rand()%batchFrames[frame].numSegments] ^= 1 << (rand()%n);
+            }
+
+            codedOffset += codedGap+batchFrames[frame].numSegments;
+            uncodedOffset += uncodedGap+len;
+            framesUsed++;
+        }
+
+        int testLen = viterbiDecoderHardBatch(&viterbiState, codedRef, decodedTest, batchFrames, framesUsed);
+
+        int refLen = 0;
+        for(int frame = 0; frame<framesUsed && !failed; frame++){
+            int frameLen = VITERBI_DECODER_HARD(&viterbiState, codedRef+batchFrames[frame].codedOffset, decodedRef, batchFrames[frame].numSegments, true);
+            refLen += frameLen;
+            if(memcmp(decodedRef, decodedTest+batchFrames[frame].uncodedOffset, frameLen) != 0){
+                printf("\tBatch: Frame %d does not match decoding the frame on its own\n", frame);
+                failed = true;
+            }
+        }
+
+        if(refLen != testLen){
+            printf("\tBatch: Decoded %d bytes, expected %d\n", testLen, refLen);
+            failed = true;
+        }
+    }
+
+    printf("\t%s\n", failed ? "Failed" : "Passed");
+    return !failed;
+}
+
+bool testPipelinedDecoder(){
+    printf("********** Pipelined Decoder Test **********\n");
+    bool failed = false;
+
+    VITERBI_RESET(&viterbiState);
+    VITERBI_INIT(&viterbiState);
+    viterbiPipeline_t* pipeline = (viterbiPipeline_t*) aligned_alloc(64, sizeof(viterbiPipeline_t));
+    viterbiPipelineInit(pipeline);
+
+    for(int trial = 0; trial<RANDOM_TRIALS && !failed; trial++){
+        //Submit a group of packets (more than the number of slots) before waiting.  The coded buffer is reused once submitted
+        int refLen = 0;
+        int lens[PIPELINE_TEST_GROUP];
+        for(int pkt = 0; pkt<PIPELINE_TEST_GROUP; pkt++){
+            lens[pkt] = randLen(MAX_PKT_LEN_UNCODED_BITS/8 - k);
+            if(lens[pkt] == 0){
+                lens[pkt] = k;
+            }
+            fillRandom(uncodedBuf, lens[pkt]);
+            int codedLen = encodeReference(uncodedBuf, codedRef, lens[pkt], true);
+            if(trial%2 == 1){
+                for(int seg = rand()%16; seg<codedLen; seg+=1+rand()%12){
+                    codedRef[seg] ^= 1 << (rand()%n);
+                }
+            }
+
+            refLen += VITERBI_DECODER_HARD(&viterbiState, codedRef, pipelineRef[pkt], codedLen, true);
+            viterbiPipelineSubmit(pipeline, codedRef, pipelineDecoded[pkt], codedLen);
+        }
+
+        long testLen = viterbiPipelineWait(pipeline);
+        if(testLen != refLen){
+            printf("\tPipelined: Decoded %ld bytes, expected %d\n", testLen, refLen);
+            failed = true;
+        }
+        for(int pkt = 0; pkt<PIPELINE_TEST_GROUP && !failed; pkt++){
+            if(memcmp(pipelineRef[pkt], pipelineDecoded[pkt], lens[pkt]) != 0){
+                printf("\tPipelined: Packet %d does not match the hard decision decoder (Length: %d)\n", pkt, lens[pkt]);
+                failed = true;
+            }
+        }
+    }
+
+    viterbiPipelineDestroy(pipeline);
+    free(pipeline);
+
+    printf("\t%s\n", failed ? "Failed" : "Passed");
+    return !failed;
+}
+
+/**
+ * Checks the fused CRC result of each decoder against a separate CRC pass over the hard decision decoder output
+ */
+bool checkCrcDecoders(crcType_t crc, int codedLen, bool* refOk){
+    bool failed = false;
+
+    int refLen = VITERBI_DECODER_HARD(&viterbiState, codedTest, decodedRef, codedLen, true);
+    *refOk = crcCheck(crc, decodedRef, refLen);
+
+    //Provide the segments over 2 calls to check the CRC is carried
+    int split = rand()%(codedLen+1);
+    viterbiDecodeResult_t result = VITERBI_DECODER_HARD_EX(&viterbiState, codedTest, decodedTest, split, false, crc);
+    int testLen = result.bytesOut;
+    result = VITERBI_DECODER_HARD_EX(&viterbiState, codedTest+split, decodedTest+testLen, codedLen-split, true, crc);
+    testLen += result.bytesOut;
+    if(refLen != testLen || memcmp(decodedRef, decodedTest, refLen) != 0 || result.crcOk != *refOk){
+        printf("\tCRC: Hard decision decoder CRC check got %d, expected %d (Length: %d)\n", result.crcOk, *refOk, refLen);
+        failed = true;
+    }
+
+    codedToSamples(codedTest, codedLen, 1.0f, softSamples, softSamplesInt16);
+    result = viterbiDecoderSoftButterflyk1Ex(&softState, softSamples, VITERBI_SOFT_MAX, decodedTest, codedLen, true, crc);
+    if(result.bytesOut != refLen || memcmp(decodedRef, decodedTest, refLen) != 0 || result.crcOk != *refOk){
+        printf("\tCRC: Soft decision decoder CRC check got %d, expected %d (Length: %d)\n", result.crcOk, *refOk, refLen);
+        failed = true;
+    }
+
+    viterbiBatchFrame_t frame = {0, codedLen, 0};
+    bool batchCrcOk = !*refOk;
+    testLen = viterbiDecoderHardBatchEx(&viterbiState, codedTest, decodedTest, &frame, 1, crc, &batchCrcOk);
+    if(testLen != refLen || batchCrcOk != *refOk){
+        printf("\tCRC: Batch decoder CRC check got %d, expected %d (Length: %d)\n", batchCrcOk, *refOk, refLen);
+        failed = true;
+    }
+
+    return !failed;
+}
+
+bool testCrcDecoder(){
+    printf("********** Fused CRC Test **********\n");
+    bool failed = false;
+
+    crcInit();
+    const uint8_t checkString[] = "123456789";
+    if(crcCompute(CRC_16, checkString, 9) != 0x29B1 || crcCompute(CRC_32, checkString, 9) != 0xCBF43926){
+        printf("\tCRC: Check values do not match (CRC-16: 0x%x, CRC-32: 0x%x)\n", crcCompute(CRC_16, checkString, 9), crcCompute(CRC_32, checkString, 9));
+        failed = true;
+    }
+
+    //The slice-by-8 update should match one byte at a time
+    for(int trial = 0; trial<RANDOM_TRIALS && !failed; trial++){
+        int len = rand()%256;
+        fillRandom(uncodedBuf, len);
+        for(crcType_t crc = CRC_16; crc<=CRC_32; crc++){
+            uint32_t reg = crcInitial(crc);
+            for(int i = 0; i<len; i++){
+                reg = crcUpdate(crc, reg, uncodedBuf+i, 1);
+            }
+            if(reg != crcUpdate(crc, crcInitial(crc), uncodedBuf, len)){
+                printf("\tCRC: Slice-by-8 update does not match the bytewise update (Length: %d)\n", len);
+                failed = true;
+            }
+        }
+    }
+
+    VITERBI_RESET(&viterbiState);
+    VITERBI_INIT(&viterbiState);
+    resetViterbiDecoderSoftButterflyk1(&softState);
+    viterbiInitSoftButterflyk1(&softState);
+    viterbiPipeline_t* pipeline = (viterbiPipeline_t*) aligned_alloc(64, sizeof(viterbiPipeline_t));
+    viterbiPipelineInit(pipeline);
+
+    for(int trial = 0; trial<RANDOM_TRIALS && !failed; trial++){
+        for(crcType_t crc = CRC_NONE; crc<=CRC_32 && !failed; crc++){
+            int len = randLen(MAX_PKT_LEN_UNCODED_BITS/8 - 4 - k);
+            fillRandom(uncodedBuf, len);
+            len = crcAppend(crc, uncodedBuf, len);
+            if(len == 0){
+                uncodedBuf[0] = 0;
+                len = k;
+            }
+
+            //Corrupt the frame before encoding (the decoder returns a bad frame), add channel errors, or leave it intact
+            int mode = rand()%3;
+            if(mode == 1){
+                uncodedBuf[rand()%len] ^= 1 << (rand()%8);
+            }
+            int codedLen = encodeReference(uncodedBuf, codedTest, len, true);
+            if(mode == 2){
+                for(int seg = rand()%16; seg<codedLen; seg+=1+rand()%12){
+                    codedTest[seg] ^= 1 << (rand()%n);
+                }
+            }
+
+            bool refOk;
+            failed |= !checkCrcDecoders(crc, codedLen, &refOk);
+            if(mode == 0 && !refOk){
+                printf("\tCRC: Intact frame failed the CRC check (Length: %d)\n", len);
+                failed = true;
+            }
+            if(mode == 1 && crc != CRC_NONE && refOk){
+                printf("\tCRC: Corrupted frame passed the CRC check (Length: %d)\n", len);
+                failed = true;
+            }
+
+            bool pipelineCrcOk = !refOk;
+            viterbiPipelineSubmitEx(pipeline, codedTest, pipelineDecoded[0], codedLen, crc, &pipelineCrcOk);
+            viterbiPipelineWait(pipeline);
+            if(pipelineCrcOk != refOk){
+                printf("\tCRC: Pipelined decoder CRC check got %d, expected %d (Length: %d)\n", pipelineCrcOk, refOk, len);
+                failed = true;
+            }
+        }
+    }
+
+    viterbiPipelineDestroy(pipeline);
+    free(pipeline);
+
+    printf("\t%s\n", failed ? "Failed" : "Passed");
+    return !failed;
+}
+
+/**
+ * Number of coded bits which differ between 2 coded buffers
+ */
+int codedDistance(const uint8_t* a, const uint8_t* b, int codedLen){
+    int distance = 0;
+    for(int seg = 0; seg<codedLen; seg++){
+        distance += __builtin_popcount(a[seg] ^ b[seg]);
+    }
+    return distance;
+}
+
+bool testDecodeQuality(){
+    printf("********** Decode Quality Test **********\n");
+    bool failed = false;
+
+    VITERBI_RESET(&viterbiState);
+    VITERBI_INIT(&viterbiState);
+    resetViterbiDecoderSoftButterflyk1(&softState);
+    viterbiInitSoftButterflyk1(&softState);
+
+    for(int trial = 0; trial<RANDOM_TRIALS && !failed; trial++){
+        int len = randLen(MAX_PKT_LEN_UNCODED_BITS/8 - k);
+        if(len == 0){
+            len = k;
+        }
+        fillRandom(uncodedBuf, len);
+        int codedLen = encodeReference(uncodedBuf, codedRef, len, true);
+
+        //Clean packets (even trials) and packets with errors, some of which are not corrected
+        memcpy(codedTest, codedRef, codedLen);
+        if(trial%2 == 1){
+            int spacing = 2+rand()%40;
+            for(int seg = rand()%16; seg<codedLen; seg+=1+rand()%spacing){
+                codedTest[seg] ^= 1 << (rand()%n);
+            }
+        }
+
+        //Provide the segments over 2 calls.  The last step must be in the last call
+        int split = rand()%codedLen;
+        viterbiDecodeResult_t result = VITERBI_DECODER_HARD_EX(&viterbiState, codedTest, decodedTest, split, false, CRC_NONE);
+        int testLen = result.bytesOut;
+        result = VITERBI_DECODER_HARD_EX(&viterbiState, codedTest+split, decodedTest+testLen, codedLen-split, true, CRC_NONE);
+        testLen += result.bytesOut;
+
+        //The path metric replaces re-encoding the decoded packet and comparing it to the received segments
+        int reencodedLen = encodeReference(decodedTest, codedRef, testLen, true);
+        int distance = codedDistance(codedRef, codedTest, codedLen);
+        if(testLen != len || reencodedLen != codedLen || result.pathMetric != (uint32_t) distance){
+            printf("\tQuality: Path metric %u does not match the re-encoded distance %d (Length: %d)\n", result.pathMetric, distance, len);
+            failed = true;
+        }
+        if(trial%2 == 0 && result.margin == 0){
+            printf("\tQuality: Clean packet has no margin (Length: %d)\n", len);
+            failed = true;
+        }
+
+        //With saturated samples, the soft metrics are scaled hard metrics
+        codedToSamples(codedTest, codedLen, 1.0f, softSamples, softSamplesInt16);
+        viterbiDecodeResult_t softResult = viterbiDecoderSoftButterflyk1Ex(&softState, softSamples, VITERBI_SOFT_MAX, decodedRef, codedLen, true, CRC_NONE);
+        if(softResult.pathMetric != 2*VITERBI_SOFT_MAX*result.pathMetric || softResult.margin != 2*VITERBI_SOFT_MAX*result.margin){
+            printf("\tQuality: Soft decision path metric %u and margin %u do not match the hard decision %u and %u (Length: %d)\n", softResult.pathMetric, softResult.margin, result.pathMetric, result.margin, len);
+            failed = true;
+        }
+    }
+
+    printf("\t%s\n", failed ? "Failed" : "Passed");
+    return !failed;
+}
+
+bool testFastPathDecoder(){
+    printf("********** Re-Encode Fast Path Decoder Test **********\n");
+    bool failed = false;
+
+    VITERBI_RESET(&viterbiState);
+    VITERBI_INIT(&viterbiState);
+    viterbiFastPathInit(&fastPathState);
+    viterbiFastPathReset(&fastPathState);
+
+    for(int trial = 0; trial<RANDOM_TRIALS*2 && !failed; trial++){
+        int len = randLen(MAX_PKT_LEN_UNCODED_BITS/8 - k);
+        if(len == 0){
+            len = k;
+        }
+        fillRandom(uncodedBuf, len);
+        int codedLen = encodeReference(uncodedBuf, codedRef, len, true);
+
+        //Introduce errors at a density which varies between trials, including bursts at the start and end of the packet
+        int errors = 0;
+        int spacing = 1 << (trial%10);
+        for(int seg = rand()%spacing; seg<codedLen; seg+=1+rand()%spacing){
+            codedRef[seg] ^= 1 << (rand()%n);
+            errors++;
+        }
+        if(trial%4 == 3){
+            codedRef[0] ^= 1;
+            codedRef[codedLen-1] ^= 1;
+        }
+
+        int refLen = VITERBI_DECODER_HARD(&viterbiState, codedRef, decodedRef, codedLen, true);
+
+        int split = rand()%(codedLen+1);
+        int testLen = viterbiFastPathDecoderHard(&fastPathState, codedRef, decodedTest, split, false);
+        testLen += viterbiFastPathDecoderHard(&fastPathState, codedRef+split, decodedTest, codedLen-split, true);
+
+        //With sparse errors, both decoders recover the packet.  With dense errors, the fast path is not
+        //guaranteed to find the same path as the full Viterbi decoder but should be no worse on average
+        int refErrors = 0;
+        int testErrors = 0;
+        for(int i = 0; i<len; i++){
+            refErrors += calcHammingDist(decodedRef[i], uncodedBuf[i], 8);
+            testErrors += calcHammingDist(decodedTest[i], uncodedBuf[i], 8);
+        }
+
+        if(refLen != testLen || (refErrors == 0 && testErrors != 0) || testErrors > 2*refErrors+8){
+            printf("\tFast Path: Decoded packet has %d bit errors, Viterbi has %d (Length: %d, Channel Errors: %d)\n", testErrors, refErrors, len, errors);
+            failed = true;
+        }
+    }
+
+    printf("\t%s\n", failed ? "Failed" : "Passed");
+    return !failed;
+}
+
+int main(int argc, char* argv[]){
+    printf("=============== Equivalence Test ===============\n");
+
+    printf("Params:\n");
+    printf("\tk:    %d\n", k);
+    printf("\tK:    %d\n", K);
+    printf("\tn:    %d\n", n);
+    for(int i = 0; i<n; i++){
+        printf("\t\tg[%d]=%lo\n", i, g[i]);
+    }
+    printf("\tRate: %f\n", Rc);
+    printf("\tNum States: %lu\n", NUM_STATES);
+
+    srand(RAND_SEED);
+
+    bool passed = true;
+    passed &= testParallelEncoder();
+    passed &= testBitSlicedEncoder();
+    passed &= testSymbolEncoder();
+    passed &= testBcjrDecoder();
+    passed &= testSovaDecoder();
+    passed &= testSoftDecoder();
+    passed &= testTraceback();
+    passed &= testWindowDecoder();
+    passed &= testBatchDecoder();
+    passed &= testPipelinedDecoder();
+    passed &= testCrcDecoder();
+    passed &= testDecodeQuality();
+    passed &= testFastPathDecoder();
+
+    if(!passed){
+        printf("++++ Test Failed! ++++\n");
+        return 1;
+    }
+
+    printf("++++ Test Passed! ++++\n");
+    return 0;
+}
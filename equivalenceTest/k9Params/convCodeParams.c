@@ -0,0 +1,6 @@
+#include "convCodeParams.h"
+
+//Note, starting with a 0 indecates an octal
+//Note, in the Proakis convention, the generators are big endian with the MSB representing the most recent input bit in the encoder
+//internally, these generators will be converted to little endian representations
+const uint64_t g[n] = {0753, 0561};
\ No newline at end of file
@@ -0,0 +1,509 @@
+//Encodes or decodes a file with the convolutional code in convCodeParams.c
+//
+//The uncoded file is split into frames of --frame-len bytes (the last frame may be shorter).  Each frame is encoded
+//as a terminated packet so frames can be decoded independently.  With --crc, the last bytes of each uncoded frame
+//are the CRC of the frame's payload (see crc.h): the encoder appends it and the decoder checks and removes it.
+//The coded file holds one coded segment per byte (the layout used by convEnc and the decoders), frame after frame,
+//so a full frame is (--frame-len)*8/k+S bytes.
+//
+//The input is memory mapped.  The frames are divided into one contiguous range per thread and each thread processes
+//its range --batch frames at a time into a private staging buffer which stays in the cache.  The staging buffer is
+//copied into the memory mapped output, or, with --direct, written with O_DIRECT so large captures do not evict the
+//page cache.  O_DIRECT writes must be block aligned, so each thread's range starts on a block boundary of the output
+//and the end of the file is padded to a block and then truncated.
+//
+//With --replay, the coded input (ex. a recorded capture) is decoded the given number of times without writing an
+//output and the decoder throughput is reported.  This is a benchmark workload with real channel errors and frame
+//boundaries rather than the synthetic packets of speedDecode.
+
+#ifndef _GNU_SOURCE
+//Need _GNU_SOURCE for O_DIRECT
+#define _GNU_SOURCE
+#endif
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <pthread.h>
+#include <getopt.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "convCodeParams.h"
+#include "convEncode.h"
+#include "viterbiDecoder.h"
+#include "crc.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define FILE_CODEC_MAX_THREADS (64)
+#define FILE_CODEC_BLOCK_BYTES (4096) //Alignment of O_DIRECT writes
+#define FILE_CODEC_DEFAULT_FRAME_BYTES (MAX_PKT_LEN_UNCODED_BITS/8)
+#define FILE_CODEC_DEFAULT_BATCH (64)
+
+typedef enum{
+    FILE_CODEC_ENCODE,
+    FILE_CODEC_DECODE
+} fileCodecMode_e;
+
+typedef struct{
+    fileCodecMode_e mode;
+    const char* inputPath;
+    const char* outputPath;
+    int frameBytes; //Uncoded bytes per frame, including the CRC
+    crcType_t crc;
+    int threads;
+    int batch; //Frames processed between writes of the staging buffer
+    bool direct;
+    int replayReps; //0 if not replaying
+} fileCodecConfig_t;
+
+/**
+ * The layout of the frames in the input and output files
+ */
+typedef struct{
+    size_t numFrames;
+    size_t inFrameBytes; //Bytes per full frame in the input file
+    size_t outFrameBytes; //Bytes per full frame in the output file
+    size_t lastInFrameBytes;
+    size_t lastOutFrameBytes;
+    size_t outputBytes;
+} fileCodecLayout_t;
+
+/**
+ * Writes the frames of one thread's range to the output file through the staging buffer
+ */
+typedef struct{
+    int fd;
+    uint8_t* map; //NULL if writing with O_DIRECT or if the output is discarded (replay)
+    bool direct;
+    off_t fileOffset; //Where the start of the staging buffer is written
+    uint8_t* staging;
+    size_t stagingUsed;
+} fileCodecWriter_t;
+
+typedef struct{
+    const fileCodecLayout_t* layout;
+    const uint8_t* input;
+    size_t firstFrame;
+    size_t endFrame;
+    int reps;
+    fileCodecWriter_t writer;
+
+    //Per thread state
+    viterbiHardState_t* decoder;
+    convEncoderState_t encoder;
+    uint8_t* frameBuf; //Uncoded frame with room for the CRC (encode)
+
+    //Statistics
+    uint64_t crcFailures;
+    uint64_t correctedBits;
+} fileCodecThread_t;
+
+static fileCodecConfig_t config;
+
+void fileCodecWriterFlush(fileCodecWriter_t* writer, bool final){
+    if(writer->direct){
+        //Only whole blocks are written until the end of the range.  The final block is padded
+        size_t writeBytes = writer->stagingUsed/FILE_CODEC_BLOCK_BYTES*FILE_CODEC_BLOCK_BYTES;
+        if(final && writeBytes < writer->stagingUsed){
+            writeBytes += FILE_CODEC_BLOCK_BYTES;
+            memset(writer->staging+writer->stagingUsed, 0, writeBytes-writer->stagingUsed);
+        }
+
+        size_t written = 0;
+        while(written < writeBytes){
+            ssize_t status = pwrite(writer->fd, writer->staging+written, writeBytes-written, writer->fileOffset+written);
+            if(status < 0){
+                perror("Could not write the output file ... exiting");
+                exit(1);
+            }
+            written += status;
+        }
+
+        size_t remaining = writeBytes < writer->stagingUsed ? writer->stagingUsed-writeBytes : 0;
+        memmove(writer->staging, writer->staging+writeBytes, remaining);
+        writer->stagingUsed = remaining;
+        writer->fileOffset += writeBytes;
+    }else{
+        if(writer->map != NULL){
+            memcpy(writer->map+writer->fileOffset, writer->staging, writer->stagingUsed);
+        }
+        writer->fileOffset += writer->stagingUsed;
+        writer->stagingUsed = 0;
+    }
+}
+
+/**
+ * Encodes or decodes a frame into the staging buffer
+ */
+static void fileCodecFrame(fileCodecThread_t* thread, size_t frame){
+    const fileCodecLayout_t* layout = thread->layout;
+    bool lastFrame = frame == layout->numFrames-1;
+    size_t inBytes = lastFrame ? layout->lastInFrameBytes : layout->inFrameBytes;
+    size_t outBytes = lastFrame ? layout->lastOutFrameBytes : layout->outFrameBytes;
+    const uint8_t* in = thread->input + frame*layout->inFrameBytes;
+    uint8_t* out = thread->writer.staging + thread->writer.stagingUsed;
+
+    if(config.mode == FILE_CODEC_ENCODE){
+        //The input is mapped read only, so the payload and CRC are assembled in a private buffer
+        memcpy(thread->frameBuf, in, inBytes);
+        int frameBytes = crcAppend(config.crc, thread->frameBuf, inBytes);
+        convEncBitSliced(&thread->encoder, thread->frameBuf, out, frameBytes, true);
+    }else{
+        //The CRC is written past the end of the frame's output and is overwritten by the next frame
+        viterbiDecodeResult_t result = VITERBI_DECODER_HARD_EX(thread->decoder, (uint8_t*) in, out, inBytes, true, config.crc);
+        thread->crcFailures += !result.crcOk;
+        thread->correctedBits += result.pathMetric;
+    }
+
+    thread->writer.stagingUsed += outBytes;
+}
+
+static void* fileCodecWorker(void* arg){
+    fileCodecThread_t* thread = (fileCodecThread_t*) arg;
+
+    for(int rep = 0; rep<thread->reps; rep++){
+        for(size_t batchStart = thread->firstFrame; batchStart<thread->endFrame; batchStart += config.batch){
+            size_t batchEnd = batchStart+config.batch < thread->endFrame ? batchStart+config.batch : thread->endFrame;
+            for(size_t frame = batchStart; frame<batchEnd; frame++){
+                //The frames are read sequentially, start loading the next frame while this one is processed
+                if(frame+1 < thread->endFrame){
+                    __builtin_prefetch(thread->input + (frame+1)*thread->layout->inFrameBytes);
+                }
+                fileCodecFrame(thread, frame);
+            }
+
+            fileCodecWriterFlush(&thread->writer, batchEnd == thread->endFrame);
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * Finds the frame layout of the input file.  Exits if the input is not a whole number of frames
+ */
+fileCodecLayout_t fileCodecGetLayout(size_t inputBytes){
+    fileCodecLayout_t layout;
+    size_t payloadBytes = config.frameBytes - crcBytes(config.crc);
+    size_t codedFrameBytes = config.frameBytes*8/k+S;
+
+    if(config.mode == FILE_CODEC_ENCODE){
+        layout.inFrameBytes = payloadBytes;
+        layout.outFrameBytes = codedFrameBytes;
+    }else{
+        layout.inFrameBytes = codedFrameBytes;
+        layout.outFrameBytes = payloadBytes;
+    }
+
+    layout.numFrames = (inputBytes+layout.inFrameBytes-1)/layout.inFrameBytes;
+    layout.lastInFrameBytes = inputBytes-(layout.numFrames == 0 ? 0 : (layout.numFrames-1)*layout.inFrameBytes);
+
+    if(config.mode == FILE_CODEC_ENCODE){
+        if(layout.lastInFrameBytes%k != 0){
+            printf("The input must be a multiple of %d bytes ... exiting\n", k);
+            exit(1);
+        }
+        layout.lastOutFrameBytes = (layout.lastInFrameBytes+crcBytes(config.crc))*8/k+S;
+    }else{
+        //The last frame must contain a terminated packet with a whole number of bytes (including the CRC)
+        size_t dataSegments = layout.lastInFrameBytes-S;
+        if(layout.numFrames > 0 && (layout.lastInFrameBytes <= S || dataSegments*k%8 != 0 || dataSegments*k/8 <= (size_t) crcBytes(config.crc))){
+            printf("The last frame of the input has %zu coded segments, which is not a terminated frame of the specified length ... exiting\n", layout.lastInFrameBytes);
+            exit(1);
+        }
+        layout.lastOutFrameBytes = layout.numFrames == 0 ? 0 : dataSegments*k/8-crcBytes(config.crc);
+    }
+
+    layout.outputBytes = layout.numFrames == 0 ? 0 : (layout.numFrames-1)*layout.outFrameBytes+layout.lastOutFrameBytes;
+
+    return layout;
+}
+
+void printUsage(const char* prog){
+    printf("Usage: %s -m <encode|decode> -i <input> [-o <output>] [options]\n", prog);
+    printf("  -m, --mode <encode|decode>  Operation to perform\n");
+    printf("  -i, --input <file>          Input file (uncoded bytes to encode, or coded segments to decode)\n");
+    printf("  -o, --output <file>         Output file.  Not used with --replay\n");
+    printf("  -l, --frame-len <bytes>     Uncoded bytes per frame, including the CRC (default: %d, max: %d)\n", FILE_CODEC_DEFAULT_FRAME_BYTES, MAX_PKT_LEN_UNCODED_BITS/8);
+    printf("  -c, --crc <none|16|32>      CRC at the end of each uncoded frame (default: none)\n");
+    printf("  -t, --threads <n>           Number of threads (default: 1, max: %d)\n", FILE_CODEC_MAX_THREADS);
+    printf("  -b, --batch <frames>        Frames processed between writes (default: %d)\n", FILE_CODEC_DEFAULT_BATCH);
+    printf("  -D, --direct                Write the output with O_DIRECT instead of memory mapping it\n");
+    printf("  -r, --replay <reps>         Decode the input the given number of times without an output and report the throughput\n");
+    printf("  -h, --help                  Print this message\n");
+}
+
+int parseIntArg(const char* arg, const char* name){
+    char* end;
+    long val = strtol(arg, &end, 0);
+    if(*end != '\0'){
+        printf("Invalid %s: %s ... exiting\n", name, arg);
+        exit(1);
+    }
+    return (int) val;
+}
+
+double timespecDiff(struct timespec* start, struct timespec* stop){
+    return (stop->tv_sec-start->tv_sec) + (stop->tv_nsec-start->tv_nsec)*1e-9;
+}
+
+int main(int argc, char* argv[]){
+    config.mode = FILE_CODEC_DECODE;
+    config.inputPath = NULL;
+    config.outputPath = NULL;
+    config.frameBytes = FILE_CODEC_DEFAULT_FRAME_BYTES;
+    config.crc = CRC_NONE;
+    config.threads = 1;
+    config.batch = FILE_CODEC_DEFAULT_BATCH;
+    config.direct = false;
+    config.replayReps = 0;
+    bool modeSet = false;
+
+    static struct option longOptions[] = {
+        {"mode",      required_argument, NULL, 'm'},
+        {"input",     required_argument, NULL, 'i'},
+        {"output",    required_argument, NULL, 'o'},
+        {"frame-len", required_argument, NULL, 'l'},
+        {"crc",       required_argument, NULL, 'c'},
+        {"threads",   required_argument, NULL, 't'},
+        {"batch",     required_argument, NULL, 'b'},
+        {"direct",    no_argument,       NULL, 'D'},
+        {"replay",    required_argument, NULL, 'r'},
+        {"help",      no_argument,       NULL, 'h'},
+        {NULL, 0, NULL, 0}
+    };
+
+    int opt;
+    while((opt = getopt_long(argc, argv, "m:i:o:l:c:t:b:Dr:h", longOptions, NULL)) != -1){
+        switch(opt){
+            case 'm':
+                if(strcmp(optarg, "encode") == 0){
+                    config.mode = FILE_CODEC_ENCODE;
+                }else if(strcmp(optarg, "decode") == 0){
+                    config.mode = FILE_CODEC_DECODE;
+                }else{
+                    printf("Unknown mode: %s ... exiting\n", optarg);
+                    exit(1);
+                }
+                modeSet = true;
+                break;
+            case 'i':
+                config.inputPath = optarg;
+                break;
+            case 'o':
+                config.outputPath = optarg;
+                break;
+            case 'l':
+                config.frameBytes = parseIntArg(optarg, "frame length");
+                break;
+            case 'c':
+                if(strcmp(optarg, "none") == 0){
+                    config.crc = CRC_NONE;
+                }else if(strcmp(optarg, "16") == 0){
+                    config.crc = CRC_16;
+                }else if(strcmp(optarg, "32") == 0){
+                    config.crc = CRC_32;
+                }else{
+                    printf("Unknown CRC: %s ... exiting\n", optarg);
+                    exit(1);
+                }
+                break;
+            case 't':
+                config.threads = parseIntArg(optarg, "threads");
+                break;
+            case 'b':
+                config.batch = parseIntArg(optarg, "batch size");
+                break;
+            case 'D':
+                config.direct = true;
+                break;
+            case 'r':
+                config.replayReps = parseIntArg(optarg, "replay reps");
+                break;
+            case 'h':
+                printUsage(argv[0]);
+                return 0;
+            default:
+                printUsage(argv[0]);
+                exit(1);
+        }
+    }
+
+    bool replay = config.replayReps > 0;
+    if(!modeSet || config.inputPath == NULL || (config.outputPath == NULL && !replay) || (replay && config.mode != FILE_CODEC_DECODE)){
+        printUsage(argv[0]);
+        exit(1);
+    }
+
+    if(config.frameBytes <= crcBytes(config.crc) || config.frameBytes > MAX_PKT_LEN_UNCODED_BITS/8 || config.frameBytes%k != 0 ||
+       config.threads <= 0 || config.threads > FILE_CODEC_MAX_THREADS || config.batch <= 0 || config.replayReps < 0){
+        printf("Invalid parameters ... exiting\n");
+        exit(1);
+    }
+
+    //Map the input
+    int inFd = open(config.inputPath, O_RDONLY);
+    if(inFd < 0){
+        perror("Could not open the input file ... exiting");
+        exit(1);
+    }
+    struct stat inStat;
+    if(fstat(inFd, &inStat) != 0){
+        perror("Could not stat the input file ... exiting");
+        exit(1);
+    }
+    size_t inputBytes = inStat.st_size;
+
+    const uint8_t* input = NULL;
+    if(inputBytes > 0){
+        input = (const uint8_t*) mmap(NULL, inputBytes, PROT_READ, MAP_PRIVATE | (replay ? MAP_POPULATE : 0), inFd, 0);
+        if(input == MAP_FAILED){
+            perror("Could not map the input file ... exiting");
+            exit(1);
+        }
+        madvise((void*) input, inputBytes, MADV_SEQUENTIAL);
+    }
+
+    fileCodecLayout_t layout = fileCodecGetLayout(inputBytes);
+    crcInit();
+
+    //Open and size the output
+    int outFd = -1;
+    uint8_t* outMap = NULL;
+    if(!replay){
+        outFd = open(config.outputPath, O_RDWR | O_CREAT | O_TRUNC | (config.direct ? O_DIRECT : 0), 0644);
+        if(outFd < 0){
+            perror("Could not open the output file ... exiting");
+            exit(1);
+        }
+        if(ftruncate(outFd, layout.outputBytes) != 0){
+            perror("Could not size the output file ... exiting");
+            exit(1);
+        }
+        if(!config.direct && layout.outputBytes > 0){
+            outMap = (uint8_t*) mmap(NULL, layout.outputBytes, PROT_READ | PROT_WRITE, MAP_SHARED, outFd, 0);
+            if(outMap == MAP_FAILED){
+                perror("Could not map the output file ... exiting");
+                exit(1);
+            }
+        }
+    }
+
+    //Divide the frames between the threads.  With O_DIRECT, each range starts on a block boundary of the output
+    size_t frameAlign = 1;
+    if(config.direct){
+        while((frameAlign*layout.outFrameBytes)%FILE_CODEC_BLOCK_BYTES != 0){
+            frameAlign++;
+        }
+    }
+    size_t framesPerThread = (layout.numFrames+config.threads-1)/config.threads;
+    framesPerThread = (framesPerThread+frameAlign-1)/frameAlign*frameAlign;
+
+    //The staging buffer holds a batch of frames, the unwritten part of the last block, and the CRC written past the last frame
+    size_t stagingBytes = (config.batch*layout.outFrameBytes+2*FILE_CODEC_BLOCK_BYTES+4)/FILE_CODEC_BLOCK_BYTES*FILE_CODEC_BLOCK_BYTES;
+
+    fileCodecThread_t threads[FILE_CODEC_MAX_THREADS];
+    pthread_t threadIds[FILE_CODEC_MAX_THREADS];
+    for(int i = 0; i<config.threads; i++){
+        fileCodecThread_t* thread = &threads[i];
+        thread->layout = &layout;
+        thread->input = input;
+        thread->firstFrame = i*framesPerThread < layout.numFrames ? i*framesPerThread : layout.numFrames;
+        thread->endFrame = (i+1)*framesPerThread < layout.numFrames ? (i+1)*framesPerThread : layout.numFrames;
+        thread->reps = replay ? config.replayReps : 1;
+        thread->crcFailures = 0;
+        thread->correctedBits = 0;
+
+        thread->writer.fd = outFd;
+        thread->writer.map = outMap;
+        thread->writer.direct = config.direct && !replay;
+        thread->writer.fileOffset = thread->firstFrame*layout.outFrameBytes;
+        thread->writer.staging = (uint8_t*) aligned_alloc(FILE_CODEC_BLOCK_BYTES, stagingBytes);
+        thread->writer.stagingUsed = 0;
+
+        thread->decoder = NULL;
+        thread->frameBuf = NULL;
+        if(config.mode == FILE_CODEC_DECODE){
+            thread->decoder = (viterbiHardState_t*) aligned_alloc(64, sizeof(viterbiHardState_t));
+            VITERBI_RESET(thread->decoder);
+            VITERBI_INIT(thread->decoder);
+        }else{
+            resetConvEncoder(&thread->encoder);
+            initConvEncoder(&thread->encoder);
+            thread->frameBuf = (uint8_t*) malloc(config.frameBytes);
+        }
+
+        if(thread->writer.staging == NULL || (thread->decoder == NULL && thread->frameBuf == NULL)){
+            printf("Could not allocate the thread buffers ... exiting\n");
+            exit(1);
+        }
+    }
+
+    struct timespec startTime;
+    clock_gettime(CLOCK_MONOTONIC, &startTime);
+
+    for(int i = 0; i<config.threads; i++){
+        int status = pthread_create(&threadIds[i], NULL, fileCodecWorker, &threads[i]);
+        if(status != 0){
+            printf("Could not create a worker thread ... exiting");
+            errno = status;
+            perror(NULL);
+            exit(1);
+        }
+    }
+
+    uint64_t crcFailures = 0;
+    uint64_t correctedBits = 0;
+    for(int i = 0; i<config.threads; i++){
+        int status = pthread_join(threadIds[i], NULL);
+        if(status != 0){
+            printf("Could not join a worker thread ... exiting");
+            errno = status;
+            perror(NULL);
+            exit(1);
+        }
+        crcFailures += threads[i].crcFailures;
+        correctedBits += threads[i].correctedBits;
+    }
+
+    struct timespec stopTime;
+    clock_gettime(CLOCK_MONOTONIC, &stopTime);
+    double duration = timespecDiff(&startTime, &stopTime);
+
+    if(!replay){
+        if(outMap != NULL && munmap(outMap, layout.outputBytes) != 0){
+            perror("Could not unmap the output file ... exiting");
+            exit(1);
+        }
+        //Remove the padding of the last O_DIRECT block
+        if(ftruncate(outFd, layout.outputBytes) != 0){
+            perror("Could not size the output file ... exiting");
+            exit(1);
+        }
+        close(outFd);
+    }
+
+    if(input != NULL){
+        munmap((void*) input, inputBytes);
+    }
+    close(inFd);
+
+    int reps = replay ? config.replayReps : 1;
+    size_t uncodedBytes = config.mode == FILE_CODEC_DECODE ? layout.outputBytes : inputBytes;
+    printf("Frames: %zu, Input: %zu bytes, Output: %zu bytes, Threads: %d\n", layout.numFrames, inputBytes, layout.outputBytes, config.threads);
+    if(config.mode == FILE_CODEC_DECODE){
+        printf("Corrected Coded Bits: %lu, CRC Failures: %lu\n", correctedBits/reps, crcFailures/reps);
+    }
+    printf("Time: %f s, Rate: %f Mbps (uncoded)\n", duration, duration > 0 ? (double) uncodedBytes*8*reps/duration/1e6 : 0);
+
+    for(int i = 0; i<config.threads; i++){
+        free(threads[i].writer.staging);
+        free(threads[i].decoder);
+        free(threads[i].frameBuf);
+    }
+
+    return 0;
+}
@@ -70,18 +70,18 @@ int main(int argc, char* argv[]){
     printf("******** Viterbi Decoder Node Metric Test*******\n");
     VITERBI_RESET(&viterbiState);
     assert((*viterbiState.nodeMetricsCur)[0] == 0);
-    assert((*viterbiState.nodeMetricsCur)[2] == 5);
-    assert((*viterbiState.nodeMetricsCur)[1] == 5);
-    assert((*viterbiState.nodeMetricsCur)[3] == 5);
+    assert((*viterbiState.nodeMetricsCur)[2] == 6);
+    assert((*viterbiState.nodeMetricsCur)[1] == 6);
+    assert((*viterbiState.nodeMetricsCur)[3] == 6);
     // assert((*viterbiState.traceBackCur)[0] == 0);
     // assert((*viterbiState.traceBackCur)[2] == 0);
     // assert((*viterbiState.traceBackCur)[1] == 0);
     // assert((*viterbiState.traceBackCur)[3] == 0);
     VITERBI_DECODER_HARD(&viterbiState, corruptedCoded+0, decoded, 1, false);
     assert((*viterbiState.nodeMetricsCur)[0] == 1);
-    assert((*viterbiState.nodeMetricsCur)[2] == 6);
+    assert((*viterbiState.nodeMetricsCur)[2] == 7);
     assert((*viterbiState.nodeMetricsCur)[1] == 1);
-    assert((*viterbiState.nodeMetricsCur)[3] == 5);
+    assert((*viterbiState.nodeMetricsCur)[3] == 6);
     // assert((*viterbiState.traceBackCur)[0] == 0b0);
     // assert((*viterbiState.traceBackCur)[2] == 0b0);
     // assert((*viterbiState.traceBackCur)[1] == 0b1);
@@ -0,0 +1,90 @@
+//Encodes and decodes random packets with every code in the registry to check that
+//the prefixed copies of the encoder and decoder can be linked into one binary
+
+#include "codeRegistry.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define ENCODE_PKT_BYTE_LEN (2048/8)
+#define PKTS (20)
+#define RAND_SEED (1618)
+
+//Corrupt a few well separated coded bits.  All of the codes in the demo can correct these
+#define ERROR_SPACING (97)
+
+bool testCode(const codeRegistryEntry_t* entry){
+    printf("%s: K=%d, k=%d, n=%d, g={", entry->name, entry->constraintLength, entry->inputBits, entry->outputBits);
+    for(int i = 0; i<entry->outputBits; i++){
+        printf("%s%lo", i == 0 ? "" : ", ", entry->generators[i]);
+    }
+    printf("}, Num States: %lu\n", entry->numStates);
+
+    //The lookup by parameters should return the same entry
+    if(codeRegistryLookup(entry->constraintLength, entry->inputBits, entry->outputBits, entry->generators) != entry){
+        printf("\tLookup by parameters failed\n");
+        return false;
+    }
+
+    void* encoderState = codeRegistryAllocState(entry, entry->encoderStateSize);
+    void* decoderState = codeRegistryAllocState(entry, entry->decoderStateSize);
+    entry->encoderInit(encoderState);
+    entry->decoderInit(decoderState);
+
+    int maxCodedSegments = 8*ENCODE_PKT_BYTE_LEN/entry->inputBits + entry->constraintLength;
+    uint8_t* codedSegments = (uint8_t*) malloc(maxCodedSegments);
+
+    bool failed = false;
+    for(int pkt = 0; pkt<PKTS && !failed; pkt++){
+        uint8_t uncodedPkt[ENCODE_PKT_BYTE_LEN];
+        for(int i = 0; i<ENCODE_PKT_BYTE_LEN; i++){
+            uncodedPkt[i] = (uint8_t) rand();
+        }
+
+        int codedSegsReturned = entry->encode(encoderState, uncodedPkt, codedSegments, ENCODE_PKT_BYTE_LEN, true);
+
+        for(int i = rand()%ERROR_SPACING; i<codedSegsReturned; i+=ERROR_SPACING){
+            codedSegments[i] ^= 1 << (rand()%entry->outputBits);
+        }
+
+        uint8_t decodedPkt[ENCODE_PKT_BYTE_LEN];
+        int decodedBytesReturned = entry->decode(decoderState, codedSegments, decodedPkt, codedSegsReturned, true);
+
+        if(decodedBytesReturned != ENCODE_PKT_BYTE_LEN || memcmp(uncodedPkt, decodedPkt, ENCODE_PKT_BYTE_LEN) != 0){
+            printf("\tPacket %d was not decoded correctly\n", pkt);
+            failed = true;
+        }
+    }
+
+    free(codedSegments);
+    free(encoderState);
+    free(decoderState);
+
+    printf("\t%s\n", failed ? "Failed" : "Passed");
+    return !failed;
+}
+
+int main(int argc, char* argv[]){
+    printf("=============== Multi-Code Demo ===============\n");
+    printf("Registered Codes: %d\n", codeRegistryNumCodes);
+
+    srand(RAND_SEED);
+
+    bool passed = true;
+    for(int i = 0; i<codeRegistryNumCodes; i++){
+        passed &= testCode(codeRegistryTable[i]);
+    }
+
+    if(codeRegistryLookupByName("notACode") != NULL){
+        printf("Lookup of an unregistered code succeeded\n");
+        passed = false;
+    }
+
+    if(!passed){
+        printf("++++ Test Failed! ++++\n");
+        return 1;
+    }
+
+    printf("++++ Test Passed! ++++\n");
+    return 0;
+}
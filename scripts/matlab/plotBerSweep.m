@@ -0,0 +1,66 @@
+%% Plot BER Sweep
+%Plots the CSV written by berTestK7/berSweep against the expected BPSK
+%curves computed in the same way as berCurveCoded.m
+
+clear; close all; clc;
+
+sweepFile = '../../berTestK7/berSweep.csv';
+
+%Code Spec (should match the code the sweep was run with)
+constrLen = 7;
+generators = [133, 171];
+
+genSize = size(generators);
+codeRate = length(constrLen)/genSize(2);
+trellis = poly2trellis(constrLen, generators);
+codeDistanceSpec = distspec(trellis, 10);
+
+codeLbl = ['Coded - Rate: ' num2str(codeRate) ', Constr Len: ' num2str(constrLen) ', Hard' ];
+
+%Read the sweep
+sweep = readtable(sweepFile);
+
+%Points with a measured BER of 0 cannot be shown on a log scale.  Plot the
+%upper end of the confidence interval instead
+noErrors = sweep.decodedBitErrors == 0;
+berPlot = sweep.ber;
+berPlot(noErrors) = sweep.berCiHigh(noErrors);
+errLow = berPlot - sweep.berCiLow;
+errHigh = sweep.berCiHigh - berPlot;
+
+if all(~isnan(sweep.snr))
+    %SNR grid (4 samples/symbol)
+    overSample = 4;
+    awgnSNR = min(sweep.snr):0.1:max(sweep.snr);
+    EsN0 = awgnSNR + 10*log10(overSample);
+
+    EbN0BPSKUncoded = EsN0 - 10*log10(log2(2));
+    EbN0BPSKCoded = EsN0 - 10*log10(log2(2)*codeRate);
+    idealBerBPSKUncoded = berawgn(EbN0BPSKUncoded, 'psk', 2, 'nondiff');
+    idealBerBPSKCoded = bercoding(EbN0BPSKCoded, 'conv', 'hard', codeRate, codeDistanceSpec, 'psk', 2, 'nondiff');
+
+    figure;
+    semilogy(awgnSNR, idealBerBPSKUncoded, 'k-');
+    hold on;
+    semilogy(awgnSNR, idealBerBPSKCoded, 'k.--');
+    errorbar(sweep.snr, berPlot, errLow, errHigh, 'ro');
+    semilogy(sweep.snr(noErrors), berPlot(noErrors), 'rv');
+    set(gca, 'YScale', 'log');
+    legend({'BPSK (Uncoded)', ['BPSK (' codeLbl ')'], 'Measured (Decoded)', 'Upper CI (No Errors)'}, 'location', 'southwest');
+    xlabel('SNR');
+    ylabel('BER');
+    title('BER vs. SNR (BER Sweep)');
+    grid on;
+else
+    %Channel error probability grid
+    figure;
+    errorbar(sweep.channelErrorProb, berPlot, errLow, errHigh, 'ro');
+    hold on;
+    loglog(sweep.channelErrorProb(noErrors), berPlot(noErrors), 'rv');
+    set(gca, 'XScale', 'log', 'YScale', 'log');
+    legend({'Measured (Decoded)', 'Upper CI (No Errors)'}, 'location', 'southeast');
+    xlabel('Channel Error Probability');
+    ylabel('BER');
+    title('BER vs. Channel Error Probability (BER Sweep)');
+    grid on;
+end
@@ -0,0 +1,221 @@
+#!/usr/bin/env python3
+"""Multi-code build generator.
+
+The encoder and decoder take the code parameters from convCodeParams.h at compile time.  To link
+several codes into one binary, this script generates a parameter directory per code and a Makefile
+fragment which compiles the encoder/decoder sources once per code, partially links each copy into a
+single relocatable object, and prefixes every global symbol it defines with the code name (using
+objcopy --redefine-syms).  src/codeRegistryEntry.c is compiled into each copy to describe the code.
+The script also generates the registry table (codeRegistryTable.c) which lists the entries.
+
+Codes are described in a text file with one code per line:
+    <name> <K> <k> <n> <startingState> <g0> <g1> ... <g(n-1)> [-D<flag>[=<value>] ...]
+The name must be a valid C identifier.  Generators are written as in convCodeParams.c (a leading 0
+indicates octal).  Lines starting with # are ignored.
+
+The optional -D flags select decoder variants (ex. -DALLOW_POPCNT_DECODER, -DDISABLE_POLY_SYMMETRY,
+-DVITERBI_RENORM_INTERVAL=64).  The same code can be listed several times under different names with
+different flags.  The flags are recorded in the registry entry (variant) so that a variant can be
+selected at runtime (see viterbiAutotune.h).
+
+Usage:
+    genMultiCode.py --codes codes.txt --out build/multiCode --src ../src
+
+The including Makefile uses $(MULTI_CODE_OBJS) (the prefixed code objects and the registry table)
+and compiles src/codeRegistry.c itself.
+"""
+
+import argparse
+import os
+import re
+import sys
+
+DEFAULT_SRCS = ['convEncode.c', 'convHelpers.c', 'viterbiDecoder.c', 'crc.c', 'codeRegistryEntry.c']
+
+PARAMS_H_TEMPLATE = """#ifndef _CONV_CODE_PARAMS_H_
+#define _CONV_CODE_PARAMS_H_
+
+#include <stdint.h>
+
+//Generated by genMultiCode.py for code {name}
+
+//The following convolutional code perameters are named following the conventions in "Digital Communications" 4th Ed. by John G. Proakis, 2000, Chapter 8.2 "Convolutional Codes"
+
+#define K ({K}) //Constraint length (in k bit chunks)
+#define k ({k}) //Number of bits shifted into FSM at a time
+
+#define S ((K)-1) //The number of k bit chunks included in the state (the semantics for the tapped delay includes the current input which has not yet become state)
+
+#define n ({n}) //The number of coded output bits
+
+#define Rc ((double) k/n) //The rate of the code (as a double)
+
+#define STARTING_STATE ({startingState}) //The starting state of the encoder
+
+//The generator polynomials
+//See the corresponding C file
+extern const uint64_t g[n];
+
+#endif
+"""
+
+PARAMS_C_TEMPLATE = """#include "convCodeParams.h"
+
+//Generated by genMultiCode.py for code {name}
+
+//Note, starting with a 0 indecates an octal
+//Note, in the Proakis convention, the generators are big endian with the MSB representing the most recent input bit in the encoder
+//internally, these generators will be converted to little endian representations
+const uint64_t g[n] = {{{generators}}};
+"""
+
+EXE_PARAMS_H = """#ifndef _EXE_PARAMS_H_
+#define _EXE_PARAMS_H_
+
+#define ENCODE_BLOCK_SIZE 64
+
+#define DECODE_BLOCK_SIZE 64
+
+#endif
+"""
+
+
+def parseCodes(path):
+    codes = []
+    with open(path) as f:
+        for lineNum, line in enumerate(f, 1):
+            line = line.split('#', 1)[0].strip()
+            if not line:
+                continue
+
+            fields = line.split()
+            if len(fields) < 6:
+                sys.exit('{}:{}: expected <name> <K> <k> <n> <startingState> <generators...>'.format(path, lineNum))
+
+            name = fields[0]
+            if not re.fullmatch(r'[A-Za-z_][A-Za-z0-9_]*', name):
+                sys.exit('{}:{}: {} is not a valid C identifier'.format(path, lineNum, name))
+
+            K, k, n, startingState = (int(x) for x in fields[1:5])
+            generators = fields[5:5+n]
+            flags = fields[5+n:]
+            if any(x.startswith('-D') for x in generators) or not all(x.startswith('-D') for x in flags):
+                sys.exit('{}:{}: expected {} generators followed by -D flags'.format(path, lineNum, n))
+            if any(re.search(r'[\s\'"\\$]', x) for x in flags):
+                sys.exit('{}:{}: the -D flags cannot contain quotes, spaces, backslashes, or $'.format(path, lineNum))
+            if len(generators) != n:
+                sys.exit('{}:{}: expected {} generators, got {}'.format(path, lineNum, n, len(generators)))
+            if k*K > 64:
+                sys.exit('{}:{}: only constraint lengths (k*K) <= 64 are supported'.format(path, lineNum))
+            if n > 8:
+                sys.exit('{}:{}: only n <= 8 is supported (coded segments are stored in bytes)'.format(path, lineNum))
+            for gen in generators:
+                value = int(gen, 8) if gen.startswith('0') and len(gen) > 1 and not gen.lower().startswith('0x') else int(gen, 0)
+                if value >= 2**(k*K):
+                    sys.exit('{}:{}: generator {} is longer than k*K bits'.format(path, lineNum, gen))
+
+            if any(c['name'] == name for c in codes):
+                sys.exit('{}:{}: duplicate code name {}'.format(path, lineNum, name))
+
+            codes.append({'name': name, 'K': K, 'k': k, 'n': n, 'startingState': startingState, 'generators': generators, 'flags': flags})
+
+    if not codes:
+        sys.exit('{}: no codes'.format(path))
+
+    return codes
+
+
+def writeIfChanged(path, contents):
+    """Avoids touching unchanged files so that make does not rebuild the code objects"""
+    if os.path.exists(path):
+        with open(path) as f:
+            if f.read() == contents:
+                return
+    with open(path, 'w') as f:
+        f.write(contents)
+
+
+def genParams(code, outDir):
+    paramsDir = os.path.join(outDir, code['name'], 'params')
+    os.makedirs(paramsDir, exist_ok=True)
+    writeIfChanged(os.path.join(paramsDir, 'convCodeParams.h'), PARAMS_H_TEMPLATE.format(**code))
+    writeIfChanged(os.path.join(paramsDir, 'convCodeParams.c'), PARAMS_C_TEMPLATE.format(name=code['name'], generators=', '.join(code['generators'])))
+    writeIfChanged(os.path.join(paramsDir, 'exeParams.h'), EXE_PARAMS_H)
+
+
+def genRegistryTable(codes, outDir):
+    lines = ['//Generated by genMultiCode.py', '', '#include "codeRegistry.h"', '']
+    for code in codes:
+        lines.append('extern const codeRegistryEntry_t {}_codeRegistryEntry;'.format(code['name']))
+    lines.append('')
+    lines.append('const codeRegistryEntry_t* const codeRegistryTable[] = {')
+    for code in codes:
+        lines.append('    &{}_codeRegistryEntry,'.format(code['name']))
+    lines.append('};')
+    lines.append('')
+    lines.append('const int codeRegistryNumCodes = {};'.format(len(codes)))
+    lines.append('')
+    writeIfChanged(os.path.join(outDir, 'codeRegistryTable.c'), '\n'.join(lines))
+
+
+def genMakefile(codes, outDir, srcDir, srcs):
+    lines = ['#Generated by genMultiCode.py.  Include after setting CC and CFLAGS', '']
+    lines.append('MULTI_CODE_DIR ?= {}'.format(outDir))
+    lines.append('MULTI_CODE_SRC_DIR ?= {}'.format(srcDir))
+    lines.append('NM ?= nm')
+    lines.append('OBJCOPY ?= objcopy')
+    lines.append('')
+    lines.append('MULTI_CODE_NAMES = {}'.format(' '.join(c['name'] for c in codes)))
+    lines.append('MULTI_CODE_SRCS = {}'.format(' '.join(srcs)))
+    lines.append('MULTI_CODE_OBJS = $(patsubst %,$(MULTI_CODE_DIR)/%.o,$(MULTI_CODE_NAMES)) $(MULTI_CODE_DIR)/codeRegistryTable.o')
+    lines.append('')
+
+    for code in codes:
+        name = code['name']
+        variant = ' '.join(code['flags']) if code['flags'] else 'default'
+        lines.append('#***** {} (K={}, k={}, n={}, g={{{}}}, variant: {}) *****'.format(name, code['K'], code['k'], code['n'], ', '.join(code['generators']), variant))
+        lines.append('MULTI_CODE_{}_CFLAGS = {} \'-DCODE_REGISTRY_VARIANT="{}"\''.format(name, ' '.join(code['flags']), variant))
+        lines.append('MULTI_CODE_{0}_OBJS = $(patsubst %.c,$(MULTI_CODE_DIR)/{0}/obj/%.o,$(MULTI_CODE_SRCS)) $(MULTI_CODE_DIR)/{0}/obj/convCodeParams.o'.format(name))
+        lines.append('')
+        lines.append('$(MULTI_CODE_DIR)/{0}/obj/%.o: $(MULTI_CODE_SRC_DIR)/%.c | $(MULTI_CODE_DIR)/{0}/obj/'.format(name))
+        lines.append('\t$(CC) $(CFLAGS) $(MULTI_CODE_{0}_CFLAGS) -c -I$(MULTI_CODE_DIR)/{0}/params -I$(MULTI_CODE_SRC_DIR) -DCODE_REGISTRY_NAME=\\"{0}\\" -o $@ $<'.format(name))
+        lines.append('')
+        lines.append('$(MULTI_CODE_DIR)/{0}/obj/convCodeParams.o: $(MULTI_CODE_DIR)/{0}/params/convCodeParams.c | $(MULTI_CODE_DIR)/{0}/obj/'.format(name))
+        lines.append('\t$(CC) $(CFLAGS) -c -I$(MULTI_CODE_DIR)/{0}/params -o $@ $<'.format(name))
+        lines.append('')
+        lines.append('$(MULTI_CODE_DIR)/{0}/obj/:'.format(name))
+        lines.append('\tmkdir -p $@')
+        lines.append('')
+        lines.append('#Partially link the copy and prefix the global symbols it defines')
+        lines.append('$(MULTI_CODE_DIR)/{0}.o: $(MULTI_CODE_{0}_OBJS)'.format(name))
+        lines.append('\t$(LD) -r -o $(MULTI_CODE_DIR)/{0}/combined.o $^'.format(name))
+        lines.append('\t$(NM) -g --defined-only $(MULTI_CODE_DIR)/{0}/combined.o | awk \'{{print $$3 " {0}_" $$3}}\' > $(MULTI_CODE_DIR)/{0}/symbols.txt'.format(name))
+        lines.append('\t$(OBJCOPY) --redefine-syms=$(MULTI_CODE_DIR)/{0}/symbols.txt $(MULTI_CODE_DIR)/{0}/combined.o $@'.format(name))
+        lines.append('')
+
+    lines.append('$(MULTI_CODE_DIR)/codeRegistryTable.o: $(MULTI_CODE_DIR)/codeRegistryTable.c')
+    lines.append('\t$(CC) $(CFLAGS) -c -I$(MULTI_CODE_SRC_DIR) -o $@ $<')
+    lines.append('')
+
+    writeIfChanged(os.path.join(outDir, 'multiCode.mk'), '\n'.join(lines))
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Generates per-code parameter directories, a Makefile fragment, and the code registry table')
+    parser.add_argument('--codes', required=True, help='The code description file')
+    parser.add_argument('--out', required=True, help='The output directory')
+    parser.add_argument('--src', required=True, help='The encoder/decoder source directory (relative to the directory make is run from)')
+    parser.add_argument('--srcs', nargs='+', default=DEFAULT_SRCS, help='The sources compiled once per code')
+    args = parser.parse_args()
+
+    codes = parseCodes(args.codes)
+
+    os.makedirs(args.out, exist_ok=True)
+    for code in codes:
+        genParams(code, args.out)
+    genRegistryTable(codes, args.out)
+    genMakefile(codes, args.out, args.src, args.srcs)
+
+
+if __name__ == '__main__':
+    main()
@@ -9,6 +9,8 @@
 
 #include "convEncode.h"
 #include "viterbiDecoder.h"
+#include "bcjrDecoderButterflyk1.h"
+#include "viterbiPipelinedDecoder.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <unistd.h>
@@ -22,6 +24,29 @@
 
 #define CPU (16)
 
+//Select the decoder under test
+#ifdef SPEED_DECODE_BCJR
+    #define DECODER_STATE_TYPE bcjrStateButterflyk1_t
+    #define DECODER_RESET resetBcjrDecoderButterflyk1
+    #define DECODER_INIT bcjrInitButterflyk1
+#elif defined(SPEED_DECODE_SOVA)
+    #define DECODER_STATE_TYPE viterbiSovaState_t
+    #define DECODER_RESET resetViterbiDecoderSovaButterflyk1
+    #define DECODER_INIT viterbiInitSovaButterflyk1
+#elif defined(SPEED_DECODE_SOFT)
+    #define DECODER_STATE_TYPE viterbiSoftState_t
+    #define DECODER_RESET resetViterbiDecoderSoftButterflyk1
+    #define DECODER_INIT viterbiInitSoftButterflyk1
+#elif defined(SPEED_DECODE_PIPELINED)
+    #define DECODER_STATE_TYPE viterbiPipeline_t
+    #define DECODER_RESET(state) //Reset by viterbiPipelineInit
+    #define DECODER_INIT viterbiPipelineInit
+#else
+    #define DECODER_STATE_TYPE viterbiHardState_t
+    #define DECODER_RESET VITERBI_RESET
+    #define DECODER_INIT VITERBI_INIT
+#endif
+
 //From telemetry_helpers.c
 typedef struct timespec timespec_t;
 double difftimespec(timespec_t* a, timespec_t* b){
@@ -34,6 +59,41 @@ double timespecToDouble(timespec_t* a){
     return a_double;
 }
 
+#if defined(SPEED_DECODE_SOVA) || defined(SPEED_DECODE_SOFT) || defined(SPEED_DECODE_PIPELINED)
+/**
+ * Measures the rate of the hard decision decoder (in Mbps) so that the overhead (or speedup) of the other decoders can be reported
+ */
+double measureHardRate(viterbiHardState_t* viterbiState, uint8_t codedSegments[PKTS][8*ENCODE_PKT_BYTE_LEN/k+S]){
+    uint8_t decodedBytes[ENCODE_PKT_BYTE_LEN];
+    int64_t bytesDecoded = 0;
+    double duration = 0;
+
+    timespec_t startTime;
+    asm volatile ("" ::: "memory"); //Stop Re-ordering of timer
+    clock_gettime(CLOCK_MONOTONIC, &startTime);
+    asm volatile ("" ::: "memory"); //Stop Re-ordering of timer
+    while(duration < PRINT_INTERVAL){
+        for(int pkt = 0; pkt<PKTS; pkt++){
+            VITERBI_DECODER_HARD(viterbiState, codedSegments[pkt], decodedBytes, 8*ENCODE_PKT_BYTE_LEN/k+S, true);
+            bytesDecoded+=ENCODE_PKT_BYTE_LEN;
+
+            asm volatile(""
+            :
+            : "r" (*(const uint8_t (*)[]) decodedBytes)
+            :);
+        }
+
+        timespec_t currentTime;
+        asm volatile ("" ::: "memory"); //Stop Re-ordering of timer
+        clock_gettime(CLOCK_MONOTONIC, &currentTime);
+        asm volatile ("" ::: "memory"); //Stop Re-ordering of timer
+        duration = difftimespec(&currentTime, &startTime);
+    }
+
+    return bytesDecoded*8 / duration / 1e6;
+}
+#endif
+
 void* testThread(void* arg){
     srand(314);
 
@@ -60,12 +120,44 @@ void* testThread(void* arg){
     }
 
     //Initialize the Decoder
-    viterbiHardState_t viterbiState;
-    VITERBI_RESET(&viterbiState);
-    VITERBI_INIT(&viterbiState);
+    DECODER_STATE_TYPE decoderState;
+    DECODER_RESET(&decoderState);
+    DECODER_INIT(&decoderState);
     viterbiConfigCheck();
 
     uint8_t decodedBytes[ENCODE_PKT_BYTE_LEN];
+    #ifdef SPEED_DECODE_BCJR
+        BCJR_LLR_TYPE llrs[8*ENCODE_PKT_BYTE_LEN];
+    #elif defined(SPEED_DECODE_SOVA)
+        int8_t reliability[8*ENCODE_PKT_BYTE_LEN];
+
+        //The SOVA decoder contains a hard decision decoder state which is used to get the baseline
+        double hardRate = measureHardRate(&(decoderState.hard), codedSegments);
+        printf("Hard Decision Decoder Rate: %f Mbps\n", hardRate);
+    #endif
+
+    #if defined(SPEED_DECODE_SOFT) || defined(SPEED_DECODE_PIPELINED)
+        static viterbiHardState_t hardState;
+        VITERBI_RESET(&hardState);
+        VITERBI_INIT(&hardState);
+        double hardRate = measureHardRate(&hardState, codedSegments);
+        printf("Hard Decision Decoder Rate: %f Mbps\n", hardRate);
+    #endif
+
+    #ifdef SPEED_DECODE_SOFT
+        //Noiseless BPSK samples (0 -> +1, 1 -> -1).  The buffers are large, keep them off the stack
+        static float samples[PKTS][(8*ENCODE_PKT_BYTE_LEN/k+S)*n];
+        for(int i = 0; i<PKTS; i++){
+            for(int seg = 0; seg<8*ENCODE_PKT_BYTE_LEN/k+S; seg++){
+                for(int j = 0; j<n; j++){
+                    samples[i][seg*n+j] = ((codedSegments[i][seg] >> (n-1-j)) & 1) ? -1.0f : 1.0f;
+                }
+            }
+        }
+    #elif defined(SPEED_DECODE_PIPELINED)
+        //Up to VITERBI_PIPELINE_SLOTS packets are in flight, each needs its own output buffer
+        static uint8_t pipelineDecoded[PKTS][ENCODE_PKT_BYTE_LEN];
+    #endif
     int currentPkt = 0;
     int64_t bytesDecoded = 0;
 
@@ -76,7 +168,17 @@ void* testThread(void* arg){
     timespec_t lastPrint = startTime;
     int printCheck = 0;
     while(1){
-        int decodedBytesReturned = VITERBI_DECODER_HARD(&viterbiState, codedSegments[currentPkt], decodedBytes, 8*ENCODE_PKT_BYTE_LEN/k+S, true);
+        #ifdef SPEED_DECODE_BCJR
+            int decodedBytesReturned = bcjrDecoderButterflyk1(&decoderState, codedSegments[currentPkt], decodedBytes, llrs, 8*ENCODE_PKT_BYTE_LEN/k+S, true);
+        #elif defined(SPEED_DECODE_SOVA)
+            int decodedBytesReturned = viterbiDecoderSovaButterflyk1(&decoderState, codedSegments[currentPkt], decodedBytes, reliability, 8*ENCODE_PKT_BYTE_LEN/k+S, true);
+        #elif defined(SPEED_DECODE_SOFT)
+            int decodedBytesReturned = viterbiDecoderSoftButterflyk1(&decoderState, samples[currentPkt], VITERBI_SOFT_MAX/2, decodedBytes, 8*ENCODE_PKT_BYTE_LEN/k+S, true);
+        #elif defined(SPEED_DECODE_PIPELINED)
+            viterbiPipelineSubmit(&decoderState, codedSegments[currentPkt], pipelineDecoded[currentPkt], 8*ENCODE_PKT_BYTE_LEN/k+S);
+        #else
+            int decodedBytesReturned = VITERBI_DECODER_HARD(&decoderState, codedSegments[currentPkt], decodedBytes, 8*ENCODE_PKT_BYTE_LEN/k+S, true);
+        #endif
         if(currentPkt<(PKTS-1)){
             currentPkt++;
         }else{
@@ -94,6 +196,11 @@ void* testThread(void* arg){
         :);
 
         if(printCheck >= PRINT_CHECK_INTERVAL){
+            #ifdef SPEED_DECODE_PIPELINED
+                //Only count the packets which have been traced back
+                viterbiPipelineWait(&decoderState);
+            #endif
+
             timespec_t currentTime;
             asm volatile ("" ::: "memory"); //Stop Re-ordering of timer
             clock_gettime(CLOCK_MONOTONIC, &currentTime);
@@ -101,7 +208,13 @@ void* testThread(void* arg){
             double duration = difftimespec(&currentTime, &lastPrint);
             if(duration >= PRINT_INTERVAL){
                 double rateDurringPeriod = bytesDecoded*8 / duration / 1e6;
-                printf("Decoded %ld bits in %f Seconds, Rate: %f Mbps\n", bytesDecoded*8, duration, rateDurringPeriod);
+                #if defined(SPEED_DECODE_PIPELINED)
+                    printf("Decoded %ld bits in %f Seconds, Rate: %f Mbps, Speedup vs Hard: %f\n", bytesDecoded*8, duration, rateDurringPeriod, rateDurringPeriod/hardRate);
+                #elif defined(SPEED_DECODE_SOVA) || defined(SPEED_DECODE_SOFT)
+                    printf("Decoded %ld bits in %f Seconds, Rate: %f Mbps, Overhead vs Hard: %f%%\n", bytesDecoded*8, duration, rateDurringPeriod, (hardRate/rateDurringPeriod - 1)*100);
+                #else
+                    printf("Decoded %ld bits in %f Seconds, Rate: %f Mbps\n", bytesDecoded*8, duration, rateDurringPeriod);
+                #endif
                 bytesDecoded = 0;
 
                 asm volatile ("" ::: "memory"); //Stop Re-ordering of timer
@@ -128,6 +241,17 @@ int main(int argc, char* argv[]){
     }
     printf("\tRate: %f\n", Rc);
     printf("\tNum States: %lu\n", NUM_STATES);
+    #ifdef SPEED_DECODE_BCJR
+        printf("Decoder: Max-Log-MAP (BCJR)\n");
+    #elif defined(SPEED_DECODE_SOVA)
+        printf("Decoder: SOVA\n");
+    #elif defined(SPEED_DECODE_SOFT)
+        printf("Decoder: Soft Decision Viterbi (Float Samples)\n");
+    #elif defined(SPEED_DECODE_PIPELINED)
+        printf("Decoder: Pipelined Viterbi (ACS and Traceback Threads)\n");
+    #else
+        printf("Decoder: Viterbi\n");
+    #endif
 
     //Create Thread Parameters
     int status;
@@ -22,6 +22,21 @@
 
 #define CPU (16)
 
+//Select the encoder kernel under test
+#ifdef USE_BITSLICED_ENCODER
+    #define CONV_ENC convEncBitSliced
+    #define CODED_TYPE uint8_t
+    #define CODED_PER_SEGMENT (1)
+#elif defined(USE_BPSK_ENCODER)
+    #define CONV_ENC convEncBpskFloat
+    #define CODED_TYPE float
+    #define CODED_PER_SEGMENT (n)
+#else
+    #define CONV_ENC convEnc
+    #define CODED_TYPE uint8_t
+    #define CODED_PER_SEGMENT (1)
+#endif
+
 //From telemetry_helpers.c
 typedef struct timespec timespec_t;
 double difftimespec(timespec_t* a, timespec_t* b){
@@ -53,7 +68,7 @@ void* testThread(void* arg){
 
     //Encode the packets
     int64_t bytesEncoded = 0;
-    uint8_t codedSegments[8*ENCODE_PKT_BYTE_LEN/k+S];
+    CODED_TYPE codedSegments[(8*ENCODE_PKT_BYTE_LEN/k+S)*CODED_PER_SEGMENT];
     int currentPkt = 0;
 
     timespec_t startTime;
@@ -64,7 +79,7 @@ void* testThread(void* arg){
     int printCheck = 0;
     while(1){
 
-        int codedSegsReturned = convEnc(&convEncState, uncodedPkts[currentPkt], codedSegments, ENCODE_PKT_BYTE_LEN, true);
+        int codedSegsReturned = CONV_ENC(&convEncState, uncodedPkts[currentPkt], codedSegments, ENCODE_PKT_BYTE_LEN, true);
         if(currentPkt<(PKTS-1)){
             currentPkt++;
         }else{
@@ -78,7 +93,7 @@ void* testThread(void* arg){
         //Need to make sure that the encode is not optimized out
         asm volatile(""
         :
-        : "r" (*(const uint8_t (*)[]) codedSegments) //See https://gcc.gnu.org/onlinedocs/gcc/Extended-Asm.html for information for "string memory arguments"
+        : "r" (*(const CODED_TYPE (*)[]) codedSegments) //See https://gcc.gnu.org/onlinedocs/gcc/Extended-Asm.html for information for "string memory arguments"
         :);
 
         if(printCheck >= PRINT_CHECK_INTERVAL){
@@ -116,6 +131,13 @@ int main(int argc, char* argv[]){
     }
     printf("\tRate: %f\n", Rc);
     printf("\tNum States: %lu\n", NUM_STATES);
+    #ifdef USE_BITSLICED_ENCODER
+        printf("Encoder: Bit-Sliced\n");
+    #elif defined(USE_BPSK_ENCODER)
+        printf("Encoder: BPSK Float Symbols\n");
+    #else
+        printf("Encoder: Reference\n");
+    #endif
 
     //Create Thread Parameters
     int status;
@@ -0,0 +1,218 @@
+#include "awgnChannel.h"
+#include "errorInjector.h"
+#include <math.h>
+#include <string.h>
+
+#define AWGN_CHANNEL_CHUNK (16*AWGN_CHANNEL_BLOCK) //Samples modulated per pass in awgnChannelBpsk
+
+static inline uint32_t awgnFloatBits(float x){
+    uint32_t bits;
+    memcpy(&bits, &x, sizeof(bits));
+    return bits;
+}
+
+static inline float awgnBitsFloat(uint32_t bits){
+    float x;
+    memcpy(&x, &bits, sizeof(x));
+    return x;
+}
+
+/**
+ * Natural log for x in (0, 1].  Branch free version of the Cephes logf polynomial
+ */
+static inline float awgnLogf(float x){
+    uint32_t bits = awgnFloatBits(x);
+    float e = (float) ((int32_t) ((bits >> 23) & 0xFF) - 126);
+    float m = awgnBitsFloat((bits & 0x007FFFFF) | 0x3F000000); //[0.5, 1)
+
+    //Keep the mantissa in [sqrt(0.5), sqrt(2))
+    float small = m < 0.707106781186547524f ? 1.0f : 0.0f;
+    e -= small;
+    m = m + small*m - 1.0f;
+
+    float z = m*m;
+    float y = 7.0376836292E-2f;
+    y = y*m - 1.1514610310E-1f;
+    y = y*m + 1.1676998740E-1f;
+    y = y*m - 1.2420140846E-1f;
+    y = y*m + 1.4249322787E-1f;
+    y = y*m - 1.6668057665E-1f;
+    y = y*m + 2.0000714765E-1f;
+    y = y*m - 2.4999993993E-1f;
+    y = y*m + 3.3333331174E-1f;
+    y *= m*z;
+
+    y += -2.12194440E-4f*e;
+    y += -0.5f*z;
+    return m + y + 0.693359375f*e;
+}
+
+/**
+ * Square root for x > 0 (normal).  sqrtf is not used since its errno handling prevents vectorization.
+ * The reciprocal square root is estimated from the exponent and refined with 2 Newton iterations
+ */
+static inline float awgnSqrtf(float x){
+    float inv = awgnBitsFloat(0x5F375A86 - (awgnFloatBits(x) >> 1));
+    inv = inv*(1.5f - 0.5f*x*inv*inv);
+    inv = inv*(1.5f - 0.5f*x*inv*inv);
+    return x*inv;
+}
+
+/**
+ * sin and cos of 2*pi*u for u in [0, 1].  The angle is reduced to the nearest quadrant and the Cephes sinf/cosf
+ * polynomials are evaluated on [-pi/4, pi/4]
+ */
+static inline void awgnSinCos2Pi(float u, float* sinOut, float* cosOut){
+    float t = u*4.0f;
+    int32_t quadrant = (int32_t) (t + 0.5f);
+    float x = (t - (float) quadrant)*1.57079632679489662f;
+    float z = x*x;
+
+    float s = ((-1.9515295891E-4f*z + 8.3321608736E-3f)*z - 1.6666654611E-1f)*z*x + x;
+    float c = ((2.443315711809948E-5f*z - 1.388731625493765E-3f)*z + 4.166664568298827E-2f)*z*z - 0.5f*z + 1.0f;
+
+    //Rotate by the quadrant
+    int32_t q = quadrant & 3;
+    float sinQ = (q & 1) ? c : s;
+    float cosQ = (q & 1) ? s : c;
+    *sinOut = (q & 2) ? -sinQ : sinQ;
+    *cosOut = ((q+1) & 2) ? -cosQ : cosQ;
+}
+
+/**
+ * Generates AWGN_CHANNEL_BLOCK standard normal samples.  The lanes are independent and the loop is vectorized
+ */
+static inline void awgnChannelGaussianBlock(awgnChannel_t* channel, float* restrict out){
+    uint64_t* restrict s0 = channel->s[0];
+    uint64_t* restrict s1 = channel->s[1];
+    uint64_t* restrict s2 = channel->s[2];
+    uint64_t* restrict s3 = channel->s[3];
+
+    for(int lane = 0; lane<AWGN_CHANNEL_LANES; lane++){
+        //xoshiro256** with the multiplies by 5 and 9 written as shifts and adds (there is no 64 bit vector multiply in AVX2)
+        uint64_t x = s1[lane] + (s1[lane] << 2);
+        x = (x << 7) | (x >> 57);
+        uint64_t r = x + (x << 3);
+
+        uint64_t t = s1[lane] << 17;
+        s2[lane] ^= s0[lane];
+        s3[lane] ^= s1[lane];
+        s1[lane] ^= s2[lane];
+        s0[lane] ^= s3[lane];
+        s2[lane] ^= t;
+        s3[lane] = (s3[lane] << 45) | (s3[lane] >> 19);
+
+        //Two 24 bit uniforms: u1 in (0, 1) (log(0) is avoided) and u2 in [0, 1)
+        float u1 = ((float) (int32_t) (r >> 40) + 0.5f)*0x1.0p-24f;
+        float u2 = (float) (int32_t) (r & 0xFFFFFF)*0x1.0p-24f;
+
+        float radius = awgnSqrtf(-2.0f*awgnLogf(u1)); //The argument is at least -2*log(1-2^-25)
+        float sinVal, cosVal;
+        awgnSinCos2Pi(u2, &sinVal, &cosVal);
+        out[lane] = radius*cosVal;
+        out[AWGN_CHANNEL_LANES+lane] = radius*sinVal;
+    }
+}
+
+void awgnChannelInit(awgnChannel_t* channel, double esN0Db, double softScale, uint64_t seed){
+    uint64_t state = seed;
+    for(int lane = 0; lane<AWGN_CHANNEL_LANES; lane++){
+        for(int word = 0; word<4; word++){
+            channel->s[word][lane] = splitmix64(&state);
+        }
+    }
+
+    channel->esN0Db = esN0Db;
+    double esN0 = pow(10, esN0Db/10);
+    channel->sigma = (float) sqrt(1.0/(2.0*esN0));
+    channel->halfSoftScale = (float) (softScale/2);
+}
+
+double awgnChannelHardErrorProbability(double esN0Db){
+    double esN0 = pow(10, esN0Db/10);
+    return 0.5*erfc(sqrt(esN0));
+}
+
+void awgnChannelGaussian(awgnChannel_t* channel, float* out, int len){
+    int i = 0;
+    for(; i+AWGN_CHANNEL_BLOCK<=len; i+=AWGN_CHANNEL_BLOCK){
+        awgnChannelGaussianBlock(channel, out+i);
+    }
+
+    if(i<len){
+        float block[AWGN_CHANNEL_BLOCK];
+        awgnChannelGaussianBlock(channel, block);
+        memcpy(out+i, block, (len-i)*sizeof(float));
+    }
+}
+
+/**
+ * Modulates the next chunkLen bits (starting at the given segment and bit) and adds noise
+ */
+static void awgnChannelReceiveChunk(awgnChannel_t* channel, const uint8_t* segments, int* segment, int* bit, int bitsPerSegment, int chunkLen, float* restrict received){
+    float noise[AWGN_CHANNEL_CHUNK];
+
+    //Map to BPSK
+    for(int i = 0; i<chunkLen; i++){
+        received[i] = ((segments[*segment] >> *bit) & 1) ? -1.0f : 1.0f;
+        (*bit)--;
+        if(*bit < 0){
+            *bit = bitsPerSegment-1;
+            (*segment)++;
+        }
+    }
+
+    awgnChannelGaussian(channel, noise, chunkLen);
+
+    float sigma = channel->sigma;
+    for(int i = 0; i<chunkLen; i++){
+        received[i] += sigma*noise[i];
+    }
+}
+
+void awgnChannelBpsk(awgnChannel_t* channel, const uint8_t* segments, int numSegments, int bitsPerSegment, int8_t* soft){
+    float received[AWGN_CHANNEL_CHUNK];
+    int totalSamples = numSegments*bitsPerSegment;
+
+    int segment = 0;
+    int bit = bitsPerSegment-1;
+    for(int chunkStart = 0; chunkStart<totalSamples; chunkStart+=AWGN_CHANNEL_CHUNK){
+        int chunkLen = totalSamples-chunkStart < AWGN_CHANNEL_CHUNK ? totalSamples-chunkStart : AWGN_CHANNEL_CHUNK;
+        awgnChannelReceiveChunk(channel, segments, &segment, &bit, bitsPerSegment, chunkLen, received);
+
+        //Quantize (mid-rise, odd values only).  floorf is not used since it is only inlined
+        //without trapping math.  The noise is bounded so the conversion to int32 does not overflow
+        float halfSoftScale = channel->halfSoftScale;
+        const int32_t maxStep = (AWGN_CHANNEL_SOFT_MAX-1)/2;
+        int8_t* softChunk = soft+chunkStart;
+        for(int i = 0; i<chunkLen; i++){
+            float step = received[i]*halfSoftScale;
+            int32_t stepFloor = (int32_t) step;
+            stepFloor -= step < (float) stepFloor ? 1 : 0;
+            stepFloor = stepFloor > maxStep ? maxStep : stepFloor;
+            stepFloor = stepFloor < -maxStep-1 ? -maxStep-1 : stepFloor;
+            softChunk[i] = (int8_t) (2*stepFloor + 1);
+        }
+    }
+}
+
+void awgnChannelBpskFloat(awgnChannel_t* channel, const uint8_t* segments, int numSegments, int bitsPerSegment, float* received){
+    int totalSamples = numSegments*bitsPerSegment;
+
+    int segment = 0;
+    int bit = bitsPerSegment-1;
+    for(int chunkStart = 0; chunkStart<totalSamples; chunkStart+=AWGN_CHANNEL_CHUNK){
+        int chunkLen = totalSamples-chunkStart < AWGN_CHANNEL_CHUNK ? totalSamples-chunkStart : AWGN_CHANNEL_CHUNK;
+        awgnChannelReceiveChunk(channel, segments, &segment, &bit, bitsPerSegment, chunkLen, received+chunkStart);
+    }
+}
+
+void awgnChannelHardSlice(const int8_t* soft, uint8_t* segments, int numSegments, int bitsPerSegment){
+    for(int i = 0; i<numSegments; i++){
+        uint8_t segment = 0;
+        for(int j = 0; j<bitsPerSegment; j++){
+            segment = (segment << 1) | (soft[i*bitsPerSegment+j] < 0 ? 1 : 0);
+        }
+        segments[i] = segment;
+    }
+}
@@ -0,0 +1,78 @@
+#ifndef _AWGN_CHANNEL_H_
+#define _AWGN_CHANNEL_H_
+
+#include <stdint.h>
+
+//AWGN channel with BPSK modulation and int8 soft outputs
+//
+//Each coded bit is mapped to a BPSK symbol (0 -> +1, 1 -> -1, unit symbol energy), white Gaussian noise with
+//variance N0/2 per sample is added for the given Es/N0, and the received sample is quantized to an int8 soft value.
+//Positive soft values favour a 0 bit.
+//
+//The Gaussian samples are generated with the Box-Muller transform.  AWGN_CHANNEL_LANES independent xoshiro256**
+//streams are stored as a structure of arrays and the log, sqrt, and sin/cos evaluations use branch free polynomial
+//approximations so that the generation loop is vectorized by the compiler.  Each 64 bit draw supplies the two 24 bit
+//uniforms for one Box-Muller pair, which limits the generated noise to about 5.9 standard deviations.
+//
+//The quantizer is mid-rise: soft values are the odd integers from -AWGN_CHANNEL_SOFT_MAX to AWGN_CHANNEL_SOFT_MAX.
+//The sign of a soft value is always the sign of the received sample, so hard slicing the soft values gives a binary
+//symmetric channel with error probability 0.5*erfc(sqrt(Es/N0)).
+
+//***** Channel Options *******
+#define AWGN_CHANNEL_LANES (8) //Independent RNG streams (SIMD lanes).  Each pass generates 2*AWGN_CHANNEL_LANES samples
+#define AWGN_CHANNEL_SOFT_MAX (127)
+#define AWGN_CHANNEL_DEFAULT_SOFT_SCALE (32.0) //Soft value units per unit of received amplitude
+//***** End Options ******
+
+#define AWGN_CHANNEL_BLOCK (2*AWGN_CHANNEL_LANES)
+
+typedef struct{
+    uint64_t s[4][AWGN_CHANNEL_LANES]; //xoshiro256** state, s[word][lane]
+    double esN0Db;
+    float sigma; //Noise standard deviation per sample
+    float halfSoftScale; //Half of the soft value units per unit amplitude (the quantizer step is 2 units)
+} awgnChannel_t;
+
+/**
+ * @brief Initializes the channel
+ *
+ * @param esN0Db the symbol energy to noise density ratio in dB
+ * @param softScale soft value units per unit of received amplitude.  Samples beyond AWGN_CHANNEL_SOFT_MAX/softScale saturate
+ * @param seed the lane streams are seeded from this value with splitmix64
+ */
+void awgnChannelInit(awgnChannel_t* channel, double esN0Db, double softScale, uint64_t seed);
+
+/**
+ * @brief The hard decision error probability of BPSK over AWGN at the given Es/N0 (dB)
+ */
+double awgnChannelHardErrorProbability(double esN0Db);
+
+/**
+ * @brief Generates len samples from the standard normal distribution
+ */
+void awgnChannelGaussian(awgnChannel_t* channel, float* out, int len);
+
+/**
+ * @brief Modulates an array of coded segments (one segment of bitsPerSegment bits per byte), adds noise, and quantizes
+ *
+ * The bits of each segment are transmitted from the MSb.  Noise samples left over at the end of a call are discarded.
+ *
+ * @param soft the soft values, numSegments*bitsPerSegment entries
+ */
+void awgnChannelBpsk(awgnChannel_t* channel, const uint8_t* segments, int numSegments, int bitsPerSegment, int8_t* soft);
+
+/**
+ * @brief Modulates an array of coded segments and adds noise.  The unquantized received samples are returned
+ *
+ * Uses the same noise as awgnChannelBpsk for the same channel state.
+ *
+ * @param received the received samples, numSegments*bitsPerSegment entries
+ */
+void awgnChannelBpskFloat(awgnChannel_t* channel, const uint8_t* segments, int numSegments, int bitsPerSegment, float* received);
+
+/**
+ * @brief Makes hard decisions on soft values and packs them into coded segments (the inverse of the mapping in awgnChannelBpsk)
+ */
+void awgnChannelHardSlice(const int8_t* soft, uint8_t* segments, int numSegments, int bitsPerSegment);
+
+#endif
@@ -0,0 +1,239 @@
+#include "bcjrDecoderButterflyk1.h"
+#include "convEncode.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+void bcjrInitButterflyk1(bcjrStateButterflyk1_t* state){
+    //Populate the edge tables in the same way as viterbiInitButterflyk1
+
+    convEncoderState_t tmpEncoder;
+    resetConvEncoder(&tmpEncoder);
+    initConvEncoder(&tmpEncoder);
+
+    printf("Max-Log-MAP (BCJR) Decoder for k=1\n");
+
+    #ifdef USE_POLY_SYMMETRY
+        for(int i = 0; i < NUM_STATES/2; i++){
+            resetConvEncoder(&tmpEncoder);
+            tmpEncoder.tappedDelay = i;
+            state->edgeCodedBitsSymm[i] = convEncOneInput(&tmpEncoder, 0);
+        }
+
+        for(int codedBits = 0; codedBits < POW2(n); codedBits++){
+            for(int i = 0; i < NUM_STATES/2; i++){
+                state->edgeMetricsSymm[codedBits][i] = calcHammingDist(state->edgeCodedBitsSymm[i], codedBits, n);
+            }
+        }
+    #else
+        for(int edge = 0; edge < 4; edge++){
+            int input = edge/2;
+            int upper = edge%2;
+            for(int i = 0; i < NUM_STATES/2; i++){
+                resetConvEncoder(&tmpEncoder);
+                tmpEncoder.tappedDelay = i + upper*NUM_STATES/2;
+                state->edgeCodedBitsButterfly[edge][i] = convEncOneInput(&tmpEncoder, input);
+            }
+        }
+
+        for(int codedBits = 0; codedBits < POW2(n); codedBits++){
+            for(int edge = 0; edge < 4; edge++){
+                for(int i = 0; i < NUM_STATES/2; i++){
+                    state->edgeMetricsButterfly[codedBits][edge][i] = calcHammingDist(state->edgeCodedBitsButterfly[edge][i], codedBits, n);
+                }
+            }
+        }
+    #endif
+}
+
+void resetBcjrDecoderButterflyk1(bcjrStateButterflyk1_t* state){
+    state->numReceived = 0;
+}
+
+//Computes the branch metrics for the 4 edges of butterfly b (see edgeCodedBitsButterfly for the order)
+#ifdef USE_POLY_SYMMETRY
+    #define BCJR_BRANCH_METRICS(STATE, BUTTERFLY, CODED_BITS) \
+        BCJR_METRIC_TYPE e0 = (STATE)->edgeMetricsSymm[CODED_BITS][BUTTERFLY]; \
+        BCJR_METRIC_TYPE e1 = n - e0; \
+        BCJR_METRIC_TYPE e2 = e1; \
+        BCJR_METRIC_TYPE e3 = e0;
+#else
+    #define BCJR_BRANCH_METRICS(STATE, BUTTERFLY, CODED_BITS) \
+        BCJR_METRIC_TYPE e0 = (STATE)->edgeMetricsButterfly[CODED_BITS][0][BUTTERFLY]; \
+        BCJR_METRIC_TYPE e1 = (STATE)->edgeMetricsButterfly[CODED_BITS][1][BUTTERFLY]; \
+        BCJR_METRIC_TYPE e2 = (STATE)->edgeMetricsButterfly[CODED_BITS][2][BUTTERFLY]; \
+        BCJR_METRIC_TYPE e3 = (STATE)->edgeMetricsButterfly[CODED_BITS][3][BUTTERFLY];
+#endif
+
+static inline void bcjrRenormalize(BCJR_METRIC_TYPE (* restrict metrics)[NUM_STATES]){
+    //Written so that the compiler infers a min reduction (see minMetricGeneric)
+    BCJR_METRIC_TYPE minMetric = (*metrics)[0];
+    for(unsigned int idx = 1; idx<NUM_STATES; idx++){
+        if((*metrics)[idx] < minMetric){
+            minMetric = (*metrics)[idx];
+        }
+    }
+
+    for(unsigned int idx = 0; idx<NUM_STATES; idx++){
+        (*metrics)[idx] -= minMetric;
+    }
+}
+
+/**
+ * Computes the alphas for the next step from the alphas of the current step
+ */
+static inline void bcjrForwardStep(const bcjrStateButterflyk1_t* restrict state, const BCJR_METRIC_TYPE (* restrict alpha)[NUM_STATES], BCJR_METRIC_TYPE (* restrict alphaNext)[NUM_STATES], uint8_t codedBits, bool renorm){
+    for(unsigned int butterfly = 0; butterfly<(NUM_STATES/2); butterfly++){
+        BCJR_BRANCH_METRICS(state, butterfly, codedBits)
+
+        BCJR_METRIC_TYPE a0 = (*alpha)[butterfly] + e0;
+        BCJR_METRIC_TYPE a1 = (*alpha)[NUM_STATES/2 + butterfly] + e1;
+        BCJR_METRIC_TYPE b0 = (*alpha)[butterfly] + e2;
+        BCJR_METRIC_TYPE b1 = (*alpha)[NUM_STATES/2 + butterfly] + e3;
+
+        (*alphaNext)[butterfly*2] = a0 < a1 ? a0 : a1;
+        (*alphaNext)[butterfly*2+1] = b0 < b1 ? b0 : b1;
+    }
+
+    if(renorm){
+        bcjrRenormalize(alphaNext);
+    }
+}
+
+/**
+ * Computes the betas for the current step from the betas of the next step
+ */
+static inline void bcjrBackwardStep(const bcjrStateButterflyk1_t* restrict state, const BCJR_METRIC_TYPE (* restrict betaNext)[NUM_STATES], BCJR_METRIC_TYPE (* restrict beta)[NUM_STATES], uint8_t codedBits, bool renorm){
+    for(unsigned int butterfly = 0; butterfly<(NUM_STATES/2); butterfly++){
+        BCJR_BRANCH_METRICS(state, butterfly, codedBits)
+
+        BCJR_METRIC_TYPE lower0 = (*betaNext)[butterfly*2] + e0;
+        BCJR_METRIC_TYPE lower1 = (*betaNext)[butterfly*2+1] + e2;
+        BCJR_METRIC_TYPE upper0 = (*betaNext)[butterfly*2] + e1;
+        BCJR_METRIC_TYPE upper1 = (*betaNext)[butterfly*2+1] + e3;
+
+        (*beta)[butterfly] = lower0 < lower1 ? lower0 : lower1;
+        (*beta)[NUM_STATES/2 + butterfly] = upper0 < upper1 ? upper0 : upper1;
+    }
+
+    if(renorm){
+        bcjrRenormalize(beta);
+    }
+}
+
+/**
+ * Computes the LLR of the input bit for a trellis step given the alphas before the step and the betas after the step
+ */
+static inline BCJR_LLR_TYPE bcjrLlrStep(const bcjrStateButterflyk1_t* restrict state, const BCJR_METRIC_TYPE (* restrict alpha)[NUM_STATES], const BCJR_METRIC_TYPE (* restrict betaNext)[NUM_STATES], uint8_t codedBits){
+    BCJR_METRIC_TYPE minCost0 = BCJR_COST_MAX;
+    BCJR_METRIC_TYPE minCost1 = BCJR_COST_MAX;
+
+    for(unsigned int butterfly = 0; butterfly<(NUM_STATES/2); butterfly++){
+        BCJR_BRANCH_METRICS(state, butterfly, codedBits)
+
+        BCJR_METRIC_TYPE p0Lower = (*alpha)[butterfly] + e0 + (*betaNext)[butterfly*2];
+        BCJR_METRIC_TYPE p0Upper = (*alpha)[NUM_STATES/2 + butterfly] + e1 + (*betaNext)[butterfly*2];
+        BCJR_METRIC_TYPE p1Lower = (*alpha)[butterfly] + e2 + (*betaNext)[butterfly*2+1];
+        BCJR_METRIC_TYPE p1Upper = (*alpha)[NUM_STATES/2 + butterfly] + e3 + (*betaNext)[butterfly*2+1];
+
+        BCJR_METRIC_TYPE p0 = p0Lower < p0Upper ? p0Lower : p0Upper;
+        BCJR_METRIC_TYPE p1 = p1Lower < p1Upper ? p1Lower : p1Upper;
+
+        minCost0 = p0 < minCost0 ? p0 : minCost0;
+        minCost1 = p1 < minCost1 ? p1 : minCost1;
+    }
+
+    return minCost1 - minCost0;
+}
+
+int bcjrDecoderButterflyk1(bcjrStateButterflyk1_t* restrict state, uint8_t* restrict codedSegments, uint8_t* restrict uncoded, BCJR_LLR_TYPE* restrict llrs, int segmentsIn, bool last){
+    //TODO: Remove check
+    if(state->numReceived + segmentsIn > MAX_PKT_LEN_SEGMENTS){
+        printf("Packet is longer than the BCJR decoder supports\n");
+        exit(1);
+    }
+
+    memcpy(state->received+state->numReceived, codedSegments, segmentsIn);
+    state->numReceived += segmentsIn;
+
+    if(!last){
+        return 0;
+    }
+
+    unsigned int totalSteps = state->numReceived;
+    unsigned int dataSteps = totalSteps - S;
+
+    BCJR_METRIC_TYPE betaA[NUM_STATES] __attribute__ ((aligned (64)));
+    BCJR_METRIC_TYPE betaB[NUM_STATES] __attribute__ ((aligned (64)));
+
+    //The alpha at the start of the packet
+    for(unsigned int idx = 0; idx<NUM_STATES; idx++){
+        state->alphaWindow[0][idx] = BCJR_INF;
+    }
+    state->alphaWindow[0][STARTING_STATE] = 0;
+
+    int segmentsOut = dataSteps/8;
+    memset(uncoded, 0, segmentsOut);
+
+    for(unsigned int windowStart = 0; windowStart<dataSteps; windowStart+=BCJR_WINDOW_LEN){
+        unsigned int windowEnd = windowStart+BCJR_WINDOW_LEN < dataSteps ? windowStart+BCJR_WINDOW_LEN : dataSteps;
+        unsigned int windowLen = windowEnd - windowStart;
+
+        //Forward recursion through the window
+        for(unsigned int i = 0; i<windowLen; i++){
+            bcjrForwardStep(state, &(state->alphaWindow[i]), &(state->alphaWindow[i+1]), state->received[windowStart+i], (windowStart+i)%BCJR_RENORM_INTERVAL == 0);
+        }
+
+        //Backward recursion through the learning period
+        BCJR_METRIC_TYPE (* restrict beta)[NUM_STATES] = &betaA;
+        BCJR_METRIC_TYPE (* restrict betaOther)[NUM_STATES] = &betaB;
+
+        unsigned int learningStart = windowEnd + BCJR_LEARNING_LEN;
+        if(learningStart >= totalSteps){
+            //The packet is terminated in the 0 state
+            learningStart = totalSteps;
+            for(unsigned int idx = 0; idx<NUM_STATES; idx++){
+                (*beta)[idx] = BCJR_INF;
+            }
+            (*beta)[0] = 0;
+        }else{
+            //Unknown state, all states are equally likely
+            for(unsigned int idx = 0; idx<NUM_STATES; idx++){
+                (*beta)[idx] = 0;
+            }
+        }
+
+        for(unsigned int t = learningStart; t>windowEnd; t--){
+            bcjrBackwardStep(state, beta, betaOther, state->received[t-1], t%BCJR_RENORM_INTERVAL == 0);
+            BCJR_METRIC_TYPE (* restrict tmp)[NUM_STATES] = beta;
+            beta = betaOther;
+            betaOther = tmp;
+        }
+
+        //Backward recursion through the window, computing the LLRs
+        for(unsigned int t = windowEnd; t>windowStart; t--){
+            unsigned int step = t-1;
+            BCJR_LLR_TYPE llr = bcjrLlrStep(state, &(state->alphaWindow[step-windowStart]), beta, state->received[step]);
+            llrs[step] = llr;
+
+            //The encoder transmits the MSb first
+            uint8_t decodedBit = llr < 0 ? 1 : 0;
+            uncoded[step/8] |= decodedBit << (7 - step%8);
+
+            if(step > windowStart){
+                bcjrBackwardStep(state, beta, betaOther, state->received[step], step%BCJR_RENORM_INTERVAL == 0);
+                BCJR_METRIC_TYPE (* restrict tmp)[NUM_STATES] = beta;
+                beta = betaOther;
+                betaOther = tmp;
+            }
+        }
+
+        //The alpha at the end of this window starts the next window
+        memcpy(state->alphaWindow[0], state->alphaWindow[windowLen], sizeof(state->alphaWindow[0]));
+    }
+
+    //Reset state for next packet
+    resetBcjrDecoderButterflyk1(state);
+
+    return segmentsOut;
+}
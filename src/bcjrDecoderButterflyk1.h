@@ -0,0 +1,74 @@
+#ifndef _BCJR_DECODER_BUTTERFLYk1_H_
+#define _BCJR_DECODER_BUTTERFLYk1_H_
+
+#include "viterbiDecoder.h"
+
+//Max-log-MAP (BCJR) soft-output decoder for k=1 codes
+//
+//Uses the same butterfly trellis layout as viterbiDecoderHardButterflyk1.  For butterfly b,
+//the source states are b and b+NUM_STATES/2 and the destination states are 2b (input 0) and
+//2b+1 (input 1).  Metrics are costs (Hamming distances) so the max-log-MAP max operations
+//become min operations.
+//
+//The forward (alpha) and backward (beta) recursions are computed over sliding windows to bound
+//memory.  The alphas for a window of BCJR_WINDOW_LEN steps are stored.  The backward recursion
+//for each window is started BCJR_LEARNING_LEN steps past the end of the window from an all-equal
+//state (or from the terminated state at the end of the packet) and is run back through the window
+//while computing the LLRs.
+
+//***** Decoder Options *******
+#define BCJR_WINDOW_LEN (64)
+#define BCJR_LEARNING_LEN (TRACEBACK_LEN)
+#define BCJR_RENORM_INTERVAL (32) //The alphas and betas are renormalized every BCJR_RENORM_INTERVAL steps
+//***** End Options ******
+
+#define BCJR_METRIC_TYPE int16_t
+#define BCJR_LLR_TYPE int16_t
+#define BCJR_INF (8192) //Used for states which are not possible.  Small enough that sums of 2 metrics do not overflow
+#define BCJR_COST_MAX INT16_MAX
+
+/**
+ * State for the BCJR decoder between calls.  The received segments are buffered until the last call
+ */
+typedef struct{
+    //Code Configuration
+    #ifdef USE_POLY_SYMMETRY
+        EDGE_METRIC_INDEX_TYPE edgeCodedBitsSymm[NUM_STATES/2];
+        //The Hamming distance of edgeCodedBitsSymm from each possible received segment.  The other edges have the complement metric
+        BCJR_METRIC_TYPE edgeMetricsSymm[POW2(n)][NUM_STATES/2] __attribute__ ((aligned (64)));
+    #else
+        //The coded bits for each of the 4 edges in each butterfly
+        //[0]: b -> 2b, [1]: b+NUM_STATES/2 -> 2b, [2]: b -> 2b+1, [3]: b+NUM_STATES/2 -> 2b+1
+        EDGE_METRIC_INDEX_TYPE edgeCodedBitsButterfly[4][NUM_STATES/2];
+        //The Hamming distance of edgeCodedBitsButterfly from each possible received segment
+        BCJR_METRIC_TYPE edgeMetricsButterfly[POW2(n)][4][NUM_STATES/2] __attribute__ ((aligned (64)));
+    #endif
+
+    //Received segments
+    uint8_t received[MAX_PKT_LEN_SEGMENTS];
+    unsigned int numReceived;
+
+    //The alphas for the current window
+    BCJR_METRIC_TYPE alphaWindow[BCJR_WINDOW_LEN+1][NUM_STATES] __attribute__ ((aligned (64)));
+} bcjrStateButterflyk1_t;
+
+void bcjrInitButterflyk1(bcjrStateButterflyk1_t* state);
+
+void resetBcjrDecoderButterflyk1(bcjrStateButterflyk1_t* state);
+
+/**
+ * @brief Performs max-log-MAP decoding of a terminated packet
+ *
+ * @note The code is expected to begin in the starting state and end in the 0 state.  The segments are buffered
+ *       and the packet is decoded when last is set.
+ *
+ * @param codedSegments an array of coded segments.  Each segment is in a separate byte
+ * @param uncoded an array of uncoded bytes (hard decisions).  Written when last is set
+ * @param llrs the log likelihood ratio of each decoded bit, in transmission order.  Positive values favor a 0 bit, negative values favor a 1 bit.  The units are Hamming distance.  Written when last is set
+ * @param segmentsIn The number of coded segements being provided
+ * @param last If true, decodes the packet and resets after this iteration
+ * @returns The number of uncoded bytes returned
+ */
+int bcjrDecoderButterflyk1(bcjrStateButterflyk1_t* restrict state, uint8_t* restrict codedSegments, uint8_t* restrict uncoded, BCJR_LLR_TYPE* restrict llrs, int segmentsIn, bool last);
+
+#endif
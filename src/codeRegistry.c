@@ -0,0 +1,42 @@
+#include "codeRegistry.h"
+#include <stdlib.h>
+#include <string.h>
+
+const codeRegistryEntry_t* codeRegistryLookup(int constraintLength, int inputBits, int outputBits, const uint64_t* generators){
+    for(int i = 0; i<codeRegistryNumCodes; i++){
+        const codeRegistryEntry_t* entry = codeRegistryTable[i];
+        if(entry->constraintLength != constraintLength || entry->inputBits != inputBits || entry->outputBits != outputBits){
+            continue;
+        }
+
+        bool match = true;
+        for(int j = 0; j<outputBits; j++){
+            if(entry->generators[j] != generators[j]){
+                match = false;
+            }
+        }
+
+        if(match){
+            return entry;
+        }
+    }
+
+    return NULL;
+}
+
+const codeRegistryEntry_t* codeRegistryLookupByName(const char* name){
+    for(int i = 0; i<codeRegistryNumCodes; i++){
+        if(strcmp(codeRegistryTable[i]->name, name) == 0){
+            return codeRegistryTable[i];
+        }
+    }
+
+    return NULL;
+}
+
+void* codeRegistryAllocState(const codeRegistryEntry_t* entry, size_t size){
+    //aligned_alloc requires the size to be a multiple of the alignment
+    size_t alignment = entry->stateAlignment;
+    size_t paddedSize = (size + alignment - 1) / alignment * alignment;
+    return aligned_alloc(alignment, paddedSize);
+}
@@ -0,0 +1,68 @@
+#ifndef _CODE_REGISTRY_H_
+#define _CODE_REGISTRY_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+//Registry of convolutional codes linked into a single binary
+//
+//The encoder and decoder take the code parameters (K, k, n, g) from convCodeParams.h at compile time
+//so that the hot loops are fully specialized.  To link more than one code into a binary,
+//scripts/multiCode/genMultiCode.py compiles the sources once per code and prefixes the symbols
+//in each copy with the code name.  codeRegistryEntry.c is compiled into each copy and provides an
+//entry with the code parameters and type-erased entry points.  The generator also emits the table
+//of entries used by codeRegistryLookup.
+//
+//This header does not depend on convCodeParams.h and can be included by code which uses the registry.
+//It avoids the names of the code parameter macros (K, k, n, g, S) so that it can also be included after convCodeParams.h.
+
+typedef struct{
+    const char* name;
+    const char* variant; //The compile flags used for this copy ("default" if none)
+
+    //Code parameters (K, k, n, and g in convCodeParams.h).  The names differ since the parameters are macros
+    int constraintLength;
+    int inputBits;
+    int outputBits;
+    const uint64_t* generators; //outputBits generator polynomials in the format of convCodeParams.c
+    uint64_t numStates;
+    int maxUncodedBits; //The longest packet (in uncoded bits) the decoder accepts
+
+    //Sizes of the state structures.  The states must be allocated with at least stateAlignment alignment
+    size_t encoderStateSize;
+    size_t decoderStateSize;
+    size_t stateAlignment;
+
+    //Entry points.  The state arguments point to the state structures of this code
+    void (*encoderInit)(void* encoderState); //Resets and initializes the encoder
+    int (*encode)(void* encoderState, uint8_t* uncoded, uint8_t* codedSegments, int bytesIn, bool last);
+    void (*decoderInit)(void* decoderState); //Resets and initializes the decoder
+    int (*decode)(void* decoderState, uint8_t* codedSegments, uint8_t* uncoded, int segmentsIn, bool last);
+} codeRegistryEntry_t;
+
+//Generated by scripts/multiCode/genMultiCode.py
+extern const codeRegistryEntry_t* const codeRegistryTable[];
+extern const int codeRegistryNumCodes;
+
+/**
+ * @brief Finds the registered code with the given parameters
+ *
+ * @param generators the outputBits generator polynomials
+ * @returns the registry entry or NULL if the code was not registered
+ */
+const codeRegistryEntry_t* codeRegistryLookup(int constraintLength, int inputBits, int outputBits, const uint64_t* generators);
+
+/**
+ * @brief Finds the registered code with the given name
+ *
+ * @returns the registry entry or NULL if the code was not registered
+ */
+const codeRegistryEntry_t* codeRegistryLookupByName(const char* name);
+
+/**
+ * @brief Allocates a state of the given size with the alignment required by the registered codes.  Free with free()
+ */
+void* codeRegistryAllocState(const codeRegistryEntry_t* entry, size_t size);
+
+#endif
@@ -0,0 +1,51 @@
+//Compiled once per code by scripts/multiCode/genMultiCode.py.  The symbols in this file,
+//along with the encoder and decoder, are prefixed with the code name after compilation.
+
+#include "codeRegistry.h"
+#include "convEncode.h"
+#include "viterbiDecoder.h"
+#include <stdalign.h>
+
+#ifndef CODE_REGISTRY_NAME
+    #error CODE_REGISTRY_NAME must be defined when compiling a registry entry
+#endif
+
+#ifndef CODE_REGISTRY_VARIANT
+    #define CODE_REGISTRY_VARIANT "default"
+#endif
+
+static void codeRegistryEncoderInit(void* encoderState){
+    resetConvEncoder((convEncoderState_t*) encoderState);
+    initConvEncoder((convEncoderState_t*) encoderState);
+}
+
+static int codeRegistryEncode(void* encoderState, uint8_t* uncoded, uint8_t* codedSegments, int bytesIn, bool last){
+    return convEnc((convEncoderState_t*) encoderState, uncoded, codedSegments, bytesIn, last);
+}
+
+static void codeRegistryDecoderInit(void* decoderState){
+    VITERBI_RESET((viterbiHardState_t*) decoderState);
+    VITERBI_INIT((viterbiHardState_t*) decoderState);
+}
+
+static int codeRegistryDecode(void* decoderState, uint8_t* codedSegments, uint8_t* uncoded, int segmentsIn, bool last){
+    return VITERBI_DECODER_HARD((viterbiHardState_t*) decoderState, codedSegments, uncoded, segmentsIn, last);
+}
+
+const codeRegistryEntry_t codeRegistryEntry = {
+    .name = CODE_REGISTRY_NAME,
+    .variant = CODE_REGISTRY_VARIANT,
+    .constraintLength = K,
+    .inputBits = k,
+    .outputBits = n,
+    .generators = g,
+    .numStates = NUM_STATES,
+    .maxUncodedBits = MAX_PKT_LEN_UNCODED_BITS,
+    .encoderStateSize = sizeof(convEncoderState_t),
+    .decoderStateSize = sizeof(viterbiHardState_t),
+    .stateAlignment = alignof(viterbiHardState_t) > alignof(convEncoderState_t) ? alignof(viterbiHardState_t) : alignof(convEncoderState_t),
+    .encoderInit = codeRegistryEncoderInit,
+    .encode = codeRegistryEncode,
+    .decoderInit = codeRegistryDecoderInit,
+    .decode = codeRegistryDecode
+};
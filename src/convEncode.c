@@ -2,6 +2,10 @@
 #include "exeParams.h"
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#ifdef __BMI2__
+    #include <immintrin.h>
+#endif
 
 void resetConvEncoder(convEncoderState_t* state){
     state->tappedDelay = STARTING_STATE;
@@ -129,6 +133,213 @@ int convEnc(convEncoderState_t* state, uint8_t* uncoded, uint8_t* codedSegments,
     return segmentsOut;
 }
 
+#if k==1 && n<=8
+/**
+ * Reverses the order of the bits within each byte of the word
+ */
+static inline uint64_t reverseBitsInBytes(uint64_t x){
+    x = ((x >> 1) & 0x5555555555555555ull) | ((x & 0x5555555555555555ull) << 1);
+    x = ((x >> 2) & 0x3333333333333333ull) | ((x & 0x3333333333333333ull) << 2);
+    x = ((x >> 4) & 0x0F0F0F0F0F0F0F0Full) | ((x & 0x0F0F0F0F0F0F0F0Full) << 4);
+    return x;
+}
+
+/**
+ * Deposits bit i of the byte into the LSb of byte i of the returned word
+ */
+static inline uint64_t spreadBitsToBytes(uint64_t b){
+    #ifdef __BMI2__
+        return _pdep_u64(b, 0x0101010101010101ull);
+    #else
+        //Isolate bit i in byte i then normalize each non-zero byte to 1
+        uint64_t isolated = (b * 0x0101010101010101ull) & 0x8040201008040201ull;
+        return ((isolated + 0x7F7F7F7F7F7F7F7Full) >> 7) & 0x0101010101010101ull;
+    #endif
+}
+
+/**
+ * Encodes 64 input bits and writes the 64 coded segments
+ *
+ * @param word the input bits with the first transmitted bit in the LSb
+ * @param prevWord the previous input bits in the same format
+ */
+static inline void convEncBitSlicedWord(const convEncoderState_t* state, uint64_t word, uint64_t prevWord, uint8_t* codedWord){
+    uint64_t genOutputs[n];
+    for(int genIdx = 0; genIdx<n; genIdx++){
+        genOutputs[genIdx] = 0;
+    }
+
+    for(int tap = 0; tap<k*K; tap++){
+        uint64_t delayed = tap == 0 ? word : (word << tap) | (prevWord >> (64-tap));
+        for(int genIdx = 0; genIdx<n; genIdx++){
+            uint64_t tapMask = -((uint64_t) ((state->polynomials[genIdx] >> tap) & 1));
+            genOutputs[genIdx] ^= delayed & tapMask;
+        }
+    }
+
+    //Interleave the generator outputs into coded segments, 8 segments at a time
+    //The 0th generator is output as the LSb (the same as computeEncOutputSegment)
+    for(int group = 0; group<8; group++){
+        uint64_t segments = 0;
+        for(int genIdx = 0; genIdx<n; genIdx++){
+            segments |= spreadBitsToBytes((genOutputs[genIdx] >> (group*8)) & 0xFF) << genIdx;
+        }
+        memcpy(codedWord+group*8, &segments, sizeof(segments));
+    }
+}
+
+/**
+ * Bytes are transmitted in increasing array index with the MSb first.  On a little endian machine, byte
+ * reversing each byte places the first transmitted bit in the LSb
+ */
+static inline uint64_t convEncLoadWord(const uint8_t* uncoded){
+    uint64_t rawWord;
+    memcpy(&rawWord, uncoded, sizeof(rawWord));
+    return reverseBitsInBytes(rawWord);
+}
+
+/**
+ * The previous word is the tapped delay (which has the most recent input in the LSb) bit reversed.
+ */
+static inline uint64_t convEncTappedDelayToWord(TAPPED_DELAY_TYPE tappedDelay){
+    return __builtin_bswap64(reverseBitsInBytes((uint64_t) tappedDelay));
+}
+
+/**
+ * The tapped delay contains the most recent bits with the last bit in the LSb (big endian byte order)
+ */
+static inline TAPPED_DELAY_TYPE convEncWordToTappedDelay(uint64_t word){
+    return (TAPPED_DELAY_TYPE) __builtin_bswap64(reverseBitsInBytes(word));
+}
+#endif
+
+int convEncBitSliced(convEncoderState_t* state, uint8_t* uncoded, uint8_t* codedSegments, int bytesIn, bool last){
+    #if k==1 && n<=8
+        int words = bytesIn/8;
+
+        //Within the word, bit t corresponds to the input bit transmitted at time t.  The input bit delayed by i is therefore
+        //obtained by shifting the word left by i and filling the LSbs with the MSbs of the previous word.
+        uint64_t prevWord = convEncTappedDelayToWord(state->tappedDelay);
+
+        for(int w = 0; w<words; w++){
+            uint64_t word = convEncLoadWord(uncoded+w*8);
+            convEncBitSlicedWord(state, word, prevWord, codedSegments+w*64);
+            prevWord = word;
+        }
+
+        int segmentsOut = words*64;
+
+        if(words > 0){
+            state->tappedDelay = convEncWordToTappedDelay(prevWord);
+        }
+
+        //Encode the remaining bytes and the padding
+        segmentsOut += convEnc(state, uncoded+words*8, codedSegments+segmentsOut, bytesIn-words*8, last);
+
+        return segmentsOut;
+    #else
+        return convEnc(state, uncoded, codedSegments, bytesIn, last);
+    #endif
+}
+
+/**
+ * Maps coded segments to symbols.  The bits of each segment are transmitted from the MSb.  A 0 is mapped to +amplitude and a 1 to -amplitude.
+ * Called with a constant format so that the switch is removed and the mapping loop is vectorized.
+ */
+static inline __attribute__((always_inline)) void convEncMapSegments(const uint8_t* restrict codedSegments, int numSegments, void* restrict symbols, convEncSymbolFormat_t format, float amplitude){
+    switch(format){
+        case CONV_ENC_SYMBOLS_INT8:
+            for(int i = 0; i<numSegments; i++){
+                for(int j = 0; j<n; j++){
+                    ((int8_t*) symbols)[i*n+j] = ((codedSegments[i] >> (n-1-j)) & 1) ? -1 : 1;
+                }
+            }
+            break;
+        case CONV_ENC_SYMBOLS_INT16:
+            for(int i = 0; i<numSegments; i++){
+                for(int j = 0; j<n; j++){
+                    ((int16_t*) symbols)[i*n+j] = ((codedSegments[i] >> (n-1-j)) & 1) ? -1 : 1;
+                }
+            }
+            break;
+        case CONV_ENC_SYMBOLS_FLOAT:
+        default:
+            for(int i = 0; i<numSegments; i++){
+                for(int j = 0; j<n; j++){
+                    ((float*) symbols)[i*n+j] = ((codedSegments[i] >> (n-1-j)) & 1) ? -amplitude : amplitude;
+                }
+            }
+            break;
+    }
+}
+
+static inline size_t convEncSymbolSize(convEncSymbolFormat_t format){
+    return format == CONV_ENC_SYMBOLS_INT8 ? sizeof(int8_t) : format == CONV_ENC_SYMBOLS_INT16 ? sizeof(int16_t) : sizeof(float);
+}
+
+/**
+ * Encodes a block of coded segments at a time into a small buffer which remains in the L1 cache and maps it to symbols.
+ * The coded segments for the packet are never written to memory
+ */
+static inline __attribute__((always_inline)) int convEncSymbols(convEncoderState_t* state, uint8_t* uncoded, void* symbols, convEncSymbolFormat_t format, float amplitude, int bytesIn, bool last){
+    uint8_t codedBlock[CONV_ENC_SYMBOL_BLOCK_BYTES*8/k+S] __attribute__ ((aligned (64)));
+    size_t symbolSize = convEncSymbolSize(format);
+    int segmentsOut = 0;
+    int bytesDone = 0;
+
+    #if k==1 && n<=8
+        int words = bytesIn/8;
+        uint64_t prevWord = convEncTappedDelayToWord(state->tappedDelay);
+
+        for(int w = 0; w<words; w++){
+            uint64_t word = convEncLoadWord(uncoded+w*8);
+            convEncBitSlicedWord(state, word, prevWord, codedBlock);
+            convEncMapSegments(codedBlock, 64, (uint8_t*) symbols+segmentsOut*n*symbolSize, format, amplitude);
+            segmentsOut += 64;
+            prevWord = word;
+        }
+
+        if(words > 0){
+            state->tappedDelay = convEncWordToTappedDelay(prevWord);
+        }
+        bytesDone = words*8;
+    #endif
+
+    //Encode the remaining bytes (all of the bytes if the bit-sliced kernel is not available) and the padding
+    do{
+        int blockBytes = bytesIn-bytesDone < CONV_ENC_SYMBOL_BLOCK_BYTES ? bytesIn-bytesDone : CONV_ENC_SYMBOL_BLOCK_BYTES;
+        bool blockLast = last && bytesDone+blockBytes == bytesIn;
+        int blockSegments = convEnc(state, uncoded+bytesDone, codedBlock, blockBytes, blockLast);
+        convEncMapSegments(codedBlock, blockSegments, (uint8_t*) symbols+segmentsOut*n*symbolSize, format, amplitude);
+        segmentsOut += blockSegments;
+        bytesDone += blockBytes;
+    }while(bytesDone < bytesIn);
+
+    return segmentsOut*n;
+}
+
+int convEncBpskInt8(convEncoderState_t* state, uint8_t* uncoded, int8_t* symbols, int bytesIn, bool last){
+    return convEncSymbols(state, uncoded, symbols, CONV_ENC_SYMBOLS_INT8, 1.0f, bytesIn, last);
+}
+
+int convEncBpskInt16(convEncoderState_t* state, uint8_t* uncoded, int16_t* symbols, int bytesIn, bool last){
+    return convEncSymbols(state, uncoded, symbols, CONV_ENC_SYMBOLS_INT16, 1.0f, bytesIn, last);
+}
+
+int convEncBpskFloat(convEncoderState_t* state, uint8_t* uncoded, float* symbols, int bytesIn, bool last){
+    return convEncSymbols(state, uncoded, symbols, CONV_ENC_SYMBOLS_FLOAT, 1.0f, bytesIn, last);
+}
+
+int convEncQpskFloat(convEncoderState_t* state, uint8_t* uncoded, float* symbols, int bytesIn, bool last){
+    #if n%2 != 0
+        printf("QPSK output requires an even number of coded bits per segment (n=%d)\n", n);
+        exit(1);
+    #endif
+
+    //Each of I and Q carries half of the symbol energy
+    return convEncSymbols(state, uncoded, symbols, CONV_ENC_SYMBOLS_FLOAT, 0.70710678118654752f, bytesIn, last)/2;
+}
+
 uint8_t computeEncOutputSegment(convEncoderState_t* state){
         //Take the dot product mod 2 for each generator
         int codedBits[n];
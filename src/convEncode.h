@@ -83,6 +83,23 @@ int convEnc(convEncoderState_t* state, uint8_t* uncoded, uint8_t* codedSegments,
  */
 uint8_t computeEncOutputSegment(convEncoderState_t* state);
 
+/**
+ * @brief Computes the coded segment for an arbitrary tapped delay value using the encoder polynomials.  Does not modify the encoder state.
+ * 
+ * Used by decoders which compute the trellis on the fly rather than using tables sized by the number of states
+ * 
+ * @param tappedDelay the tapped delay with the most recent input in the LSb
+ * 
+ * @returns the coded segment with the 0th generator in the LSb (the same as computeEncOutputSegment)
+ */
+static inline uint8_t computeEncOutputSegmentFor(const convEncoderState_t* state, uint64_t tappedDelay){
+    uint8_t codedSegment = 0;
+    for(int genIdx = n-1; genIdx>=0; genIdx--){
+        codedSegment = (codedSegment << 1) | __builtin_parityll(tappedDelay & state->polynomials[genIdx]);
+    }
+    return codedSegment;
+}
+
 /**
  * Encodes a single k bit segment.  Useful for determining the expected values for different edges in the trellis
  * 
@@ -94,5 +111,72 @@ uint8_t computeEncOutputSegment(convEncoderState_t* state);
  */
 int convEncOneInput(convEncoderState_t* state, uint8_t bitsToShiftIn);
 
+/**
+ * @brief Convolutionally encode packed data using a word-parallel (bit-sliced) kernel.  Produces the same output as convEnc.
+ * 
+ * Convolution over GF(2) is computed as the XOR of shifted 64 bit words of the input stream (one shift per tap in
+ * the generator polynomial).  64 coded bits are computed per generator at once and are then interleaved into the coded
+ * segments.  The remaining bytes which do not fill a 64 bit word, along with the final padding, are encoded with convEnc.
+ * 
+ * @note Only k=1 and n<=8 are accelerated.  Other codes fall back to convEnc.
+ * 
+ * @param uncoded an array of bytes to be encoded.  Has the same format as the uncoded array passed to convEnc
+ * @param codedSegemets an array of coded segments.  Has the same format and size requirements as the coded array passed to convEnc
+ * @param bytesIn the number of uncoded bytes sent to this function.
+ * @param last indicates that the passed uncoded data is the last in the packet and that the final padding should occure
+ * 
+ * @return the number of coded segements written
+ */
+int convEncBitSliced(convEncoderState_t* state, uint8_t* uncoded, uint8_t* codedSegments, int bytesIn, bool last);
+
+//Modulation mapped outputs
+//
+//The symbol encoders write BPSK symbols (or the I and Q of Gray mapped QPSK symbols) instead of coded segments.
+//The packet is encoded a block at a time (with the bit-sliced kernel when available) into a buffer which stays in
+//the L1 cache and each block is mapped to symbols with a vectorized loop, so the coded segments for the packet are not
+//written to memory and read back by a separate mapping pass.
+//
+//The coded bits of each segment are transmitted from the MSb (the same order as awgnChannelBpsk and the soft decision
+//decoder).  A 0 is mapped to a positive symbol and a 1 to a negative symbol.  The gray mapped QPSK symbol for a pair of
+//coded bits is the pair of BPSK symbols on I and Q, so the integer BPSK outputs can also be used as QPSK outputs.
+
+#define CONV_ENC_SYMBOL_BLOCK_BYTES (8*k) //Uncoded bytes encoded per block when the bit-sliced kernel is not used (and for the remainder)
+
+typedef enum{
+    CONV_ENC_SYMBOLS_INT8,
+    CONV_ENC_SYMBOLS_INT16,
+    CONV_ENC_SYMBOLS_FLOAT
+} convEncSymbolFormat_t;
+
+/**
+ * @brief Convolutionally encode packed data and emit +/-1 BPSK symbols (n per coded segment).  Accepts the same input as convEnc
+ *
+ * @param symbols the BPSK symbols.  Must be able to hold n times the number of coded segments produced by convEnc
+ *
+ * @return the number of symbols written
+ */
+int convEncBpskInt8(convEncoderState_t* state, uint8_t* uncoded, int8_t* symbols, int bytesIn, bool last);
+
+/**
+ * @brief Same as convEncBpskInt8 with int16 symbols
+ */
+int convEncBpskInt16(convEncoderState_t* state, uint8_t* uncoded, int16_t* symbols, int bytesIn, bool last);
+
+/**
+ * @brief Same as convEncBpskInt8 with float symbols
+ */
+int convEncBpskFloat(convEncoderState_t* state, uint8_t* uncoded, float* symbols, int bytesIn, bool last);
+
+/**
+ * @brief Convolutionally encode packed data and emit unit energy Gray mapped QPSK symbols (n/2 per coded segment)
+ *
+ * @note Requires n to be even
+ *
+ * @param symbols interleaved I and Q values of +/-1/sqrt(2).  The first coded bit of each pair is carried on I
+ *
+ * @return the number of QPSK symbols written
+ */
+int convEncQpskFloat(convEncoderState_t* state, uint8_t* uncoded, float* symbols, int bytesIn, bool last);
+
 
 #endif
\ No newline at end of file
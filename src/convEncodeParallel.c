@@ -0,0 +1,181 @@
+#include "convEncodeParallel.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <errno.h>
+
+/**
+ * Seeds the tapped delay for the chunk starting at startByte by shifting in the preceding bytes
+ *
+ * Only the last sizeof(TAPPED_DELAY_TYPE) bytes can influence the tapped delay
+ */
+static TAPPED_DELAY_TYPE seedTappedDelay(convEncParallelPool_t* pool, int startByte){
+    TAPPED_DELAY_TYPE tappedDelay = pool->carryTappedDelay;
+
+    int seedStart = startByte - (int) sizeof(TAPPED_DELAY_TYPE);
+    if(seedStart < 0){
+        seedStart = 0;
+    }
+
+    for(int i = seedStart; i<startByte; i++){
+        //Bytes are shifted in big endian bit order which is the same order convEnc shifts in individual bits
+        tappedDelay = (TAPPED_DELAY_TYPE) ((tappedDelay << 8) | pool->uncoded[i]);
+    }
+
+    return tappedDelay;
+}
+
+static void encodeChunk(convEncParallelPool_t* pool, int chunkIdx){
+    int startByte = chunkIdx*pool->chunkBytes;
+    int chunkBytes = pool->bytesIn - startByte < pool->chunkBytes ? pool->bytesIn - startByte : pool->chunkBytes;
+    bool lastChunk = chunkIdx == pool->numChunks-1;
+
+    convEncoderState_t chunkState = pool->protoState;
+    chunkState.tappedDelay = seedTappedDelay(pool, startByte);
+    chunkState.remainingUncoded = 0;
+    chunkState.remainingUncodedCount = 0;
+
+    //The chunks are a multiple of k bytes so each chunk starts on a coded segment boundary
+    int segmentOffset = startByte*8/k;
+    convEnc(&chunkState, pool->uncoded+startByte, pool->codedSegments+segmentOffset, chunkBytes, lastChunk && pool->last);
+}
+
+/**
+ * Grabs and encodes chunks until none are left.  Must be called with the lock held.  Returns with the lock held.
+ */
+static void encodeAvailableChunks(convEncParallelPool_t* pool){
+    while(pool->nextChunk < pool->numChunks){
+        int chunkIdx = pool->nextChunk;
+        pool->nextChunk++;
+
+        pthread_mutex_unlock(&pool->lock);
+        encodeChunk(pool, chunkIdx);
+        pthread_mutex_lock(&pool->lock);
+
+        pool->chunksDone++;
+        if(pool->chunksDone == pool->numChunks){
+            pthread_cond_broadcast(&pool->doneCond);
+        }
+    }
+}
+
+static void* convEncParallelWorker(void* arg){
+    convEncParallelPool_t* pool = (convEncParallelPool_t*) arg;
+
+    pthread_mutex_lock(&pool->lock);
+    unsigned int lastGeneration = pool->generation;
+    while(1){
+        while(pool->generation == lastGeneration && !pool->shutdown){
+            pthread_cond_wait(&pool->startCond, &pool->lock);
+        }
+
+        if(pool->shutdown){
+            break;
+        }
+
+        lastGeneration = pool->generation;
+        encodeAvailableChunks(pool);
+    }
+    pthread_mutex_unlock(&pool->lock);
+
+    return NULL;
+}
+
+void convEncParallelInit(convEncParallelPool_t* pool, int numThreads, int chunkBytes){
+    if(numThreads < 1 || numThreads > CONV_ENC_PARALLEL_MAX_THREADS+1){
+        printf("Parallel encoder thread count must be between 1 and %d\n", CONV_ENC_PARALLEL_MAX_THREADS+1);
+        exit(1);
+    }
+
+    if(chunkBytes < 1){
+        chunkBytes = CONV_ENC_PARALLEL_DEFAULT_CHUNK_BYTES;
+    }
+    //Round up to a multiple of k so that chunks start on a coded segment boundary
+    chunkBytes = (chunkBytes + k - 1)/k*k;
+
+    resetConvEncoder(&pool->protoState);
+    initConvEncoder(&pool->protoState);
+    pool->carryTappedDelay = STARTING_STATE;
+
+    pool->numWorkers = numThreads-1;
+    pool->chunkBytes = chunkBytes;
+    pool->generation = 0;
+    pool->shutdown = false;
+    pool->numChunks = 0;
+    pool->nextChunk = 0;
+    pool->chunksDone = 0;
+
+    pthread_mutex_init(&pool->lock, NULL);
+    pthread_cond_init(&pool->startCond, NULL);
+    pthread_cond_init(&pool->doneCond, NULL);
+
+    for(int i = 0; i<pool->numWorkers; i++){
+        int status = pthread_create(&pool->workers[i], NULL, convEncParallelWorker, pool);
+        if(status != 0){
+            printf("Could not create a parallel encoder thread ... exiting");
+            errno = status;
+            perror(NULL);
+            exit(1);
+        }
+    }
+}
+
+void convEncParallelDestroy(convEncParallelPool_t* pool){
+    pthread_mutex_lock(&pool->lock);
+    pool->shutdown = true;
+    pthread_cond_broadcast(&pool->startCond);
+    pthread_mutex_unlock(&pool->lock);
+
+    for(int i = 0; i<pool->numWorkers; i++){
+        pthread_join(pool->workers[i], NULL);
+    }
+
+    pthread_cond_destroy(&pool->doneCond);
+    pthread_cond_destroy(&pool->startCond);
+    pthread_mutex_destroy(&pool->lock);
+}
+
+void convEncParallelReset(convEncParallelPool_t* pool){
+    pool->carryTappedDelay = STARTING_STATE;
+}
+
+int convEncParallel(convEncParallelPool_t* pool, uint8_t* uncoded, uint8_t* codedSegments, int bytesIn, bool last){
+    //TODO: Remove check
+    if(bytesIn%k != 0){
+        printf("The parallel encoder requires the number of bytes to be a multiple of k\n");
+        exit(1);
+    }
+
+    if(bytesIn == 0 && !last){
+        return 0;
+    }
+
+    pthread_mutex_lock(&pool->lock);
+    pool->uncoded = uncoded;
+    pool->codedSegments = codedSegments;
+    pool->bytesIn = bytesIn;
+    pool->last = last;
+    pool->numChunks = bytesIn == 0 ? 1 : (bytesIn + pool->chunkBytes - 1)/pool->chunkBytes;
+    pool->nextChunk = 0;
+    pool->chunksDone = 0;
+
+    //Only wake the workers if there is more than one chunk to encode
+    if(pool->numChunks > 1){
+        pool->generation++;
+        pthread_cond_broadcast(&pool->startCond);
+    }
+
+    encodeAvailableChunks(pool);
+    while(pool->chunksDone < pool->numChunks){
+        pthread_cond_wait(&pool->doneCond, &pool->lock);
+    }
+    pthread_mutex_unlock(&pool->lock);
+
+    //Carry the state to the next call
+    if(last){
+        pool->carryTappedDelay = STARTING_STATE;
+    }else{
+        pool->carryTappedDelay = seedTappedDelay(pool, bytesIn);
+    }
+
+    return bytesIn*8/k + (last ? S : 0);
+}
@@ -0,0 +1,79 @@
+#ifndef _CONV_ENCODE_PARALLEL_H_
+#define _CONV_ENCODE_PARALLEL_H_
+
+#include "convEncode.h"
+#include <pthread.h>
+#include <stdbool.h>
+
+//The encoder state at any point in the message only depends on the previous
+//k*K input bits (the tapped delay).  This allows a large buffer to be split into
+//chunks which are encoded independently.  Each chunk's tapped delay is seeded
+//from the bytes immediately preceding the chunk.  Since each uncoded chunk
+//maps to a known number of coded segments, every chunk can write its output
+//directly into the final coded array without any merging step.
+
+#define CONV_ENC_PARALLEL_MAX_THREADS (64)
+#define CONV_ENC_PARALLEL_DEFAULT_CHUNK_BYTES (64*1024)
+
+/**
+ * A pool of worker threads used to encode chunks of a single large buffer
+ *
+ * The calling thread also encodes chunks while the workers are running
+ */
+typedef struct{
+    convEncoderState_t protoState; //Holds the polynomials used by each chunk
+    TAPPED_DELAY_TYPE carryTappedDelay; //The tapped delay carried between calls when last is false
+
+    int numWorkers; //Does not include the calling thread
+    int chunkBytes;
+    pthread_t workers[CONV_ENC_PARALLEL_MAX_THREADS];
+
+    pthread_mutex_t lock;
+    pthread_cond_t startCond;
+    pthread_cond_t doneCond;
+
+    //Job description (protected by lock)
+    unsigned int generation;
+    bool shutdown;
+    uint8_t* uncoded;
+    uint8_t* codedSegments;
+    int bytesIn;
+    bool last;
+    int numChunks;
+    int nextChunk;
+    int chunksDone;
+} convEncParallelPool_t;
+
+/**
+ * @brief Initializes the encoder polynomials and starts the worker threads
+ *
+ * @param numThreads the total number of threads encoding a buffer, including the calling thread.  Must be between 1 and CONV_ENC_PARALLEL_MAX_THREADS+1
+ * @param chunkBytes the number of uncoded bytes encoded by a thread at a time.  Rounded up to a multiple of k so that each chunk is a whole number of coded segments
+ */
+void convEncParallelInit(convEncParallelPool_t* pool, int numThreads, int chunkBytes);
+
+/**
+ * @brief Stops and joins the worker threads
+ */
+void convEncParallelDestroy(convEncParallelPool_t* pool);
+
+/**
+ * @brief Resets the carried encoder state to the starting state
+ */
+void convEncParallelReset(convEncParallelPool_t* pool);
+
+/**
+ * @brief Convolutionally encodes a buffer using the thread pool.  The output is identical to convEnc called on the same buffer.
+ *
+ * @note bytesIn must be a multiple of k (the same restriction as convEnc when 8%k != 0)
+ *
+ * @param uncoded an array of bytes to be encoded
+ * @param codedSegments an array of coded segments.  Must be able to hold bytesIn*8/k + S segments
+ * @param bytesIn the number of uncoded bytes
+ * @param last indicates that the buffer ends the packet and that the final padding should occur
+ *
+ * @return the number of coded segments written
+ */
+int convEncParallel(convEncParallelPool_t* pool, uint8_t* uncoded, uint8_t* codedSegments, int bytesIn, bool last);
+
+#endif
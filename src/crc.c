@@ -0,0 +1,133 @@
+#include "crc.h"
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+uint32_t crc32Tables[8][256];
+uint16_t crc16Tables[8][256];
+uint8_t crc32UnwindIdx[256];
+uint8_t crc16UnwindIdx[256];
+
+static pthread_once_t crcTablesOnce = PTHREAD_ONCE_INIT;
+
+static void crcBuildTables(){
+    for(int i = 0; i<256; i++){
+        uint32_t reg32 = i;
+        uint16_t reg16 = i << 8;
+        for(int bit = 0; bit<8; bit++){
+            reg32 = (reg32 & 1) ? (reg32 >> 1) ^ 0xEDB88320 : reg32 >> 1;
+            reg16 = (reg16 & 0x8000) ? (reg16 << 1) ^ 0x1021 : reg16 << 1;
+        }
+        crc32Tables[0][i] = reg32;
+        crc16Tables[0][i] = reg16;
+    }
+
+    //Table j advances a byte through j more zero bytes
+    for(int j = 1; j<8; j++){
+        for(int i = 0; i<256; i++){
+            crc32Tables[j][i] = (crc32Tables[j-1][i] >> 8) ^ crc32Tables[0][crc32Tables[j-1][i] & 0xFF];
+            crc16Tables[j][i] = (crc16Tables[j-1][i] << 8) ^ crc16Tables[0][crc16Tables[j-1][i] >> 8];
+        }
+    }
+
+    for(int i = 0; i<256; i++){
+        crc32UnwindIdx[crc32Tables[0][i] >> 24] = i;
+        crc16UnwindIdx[crc16Tables[0][i] & 0xFF] = i;
+    }
+}
+
+void crcInit(){
+    //The tables are shared by all decoders.  Only build them once so that initializing a decoder does not write them
+    //while another thread is decoding
+    pthread_once(&crcTablesOnce, crcBuildTables);
+}
+
+int crcBytes(crcType_t type){
+    switch(type){
+        case CRC_16:
+            return 2;
+        case CRC_32:
+            return 4;
+        default:
+            return 0;
+    }
+}
+
+uint32_t crcInitial(crcType_t type){
+    return type == CRC_32 ? CRC_32_INIT : CRC_16_INIT;
+}
+
+uint32_t crcResidue(crcType_t type){
+    return type == CRC_32 ? CRC_32_RESIDUE : CRC_16_RESIDUE;
+}
+
+static uint32_t crc32Update(uint32_t reg, const uint8_t* data, size_t len){
+    for(; len >= 8; len -= 8, data += 8){
+        uint32_t lo = reg ^ ((uint32_t) data[0] | ((uint32_t) data[1] << 8) | ((uint32_t) data[2] << 16) | ((uint32_t) data[3] << 24));
+        reg = crc32Tables[7][lo & 0xFF] ^ crc32Tables[6][(lo >> 8) & 0xFF] ^ crc32Tables[5][(lo >> 16) & 0xFF] ^ crc32Tables[4][lo >> 24] ^
+              crc32Tables[3][data[4]] ^ crc32Tables[2][data[5]] ^ crc32Tables[1][data[6]] ^ crc32Tables[0][data[7]];
+    }
+
+    for(; len > 0; len--, data++){
+        reg = (reg >> 8) ^ crc32Tables[0][(reg ^ *data) & 0xFF];
+    }
+
+    return reg;
+}
+
+static uint32_t crc16Update(uint32_t reg, const uint8_t* data, size_t len){
+    for(; len >= 8; len -= 8, data += 8){
+        reg = crc16Tables[7][data[0] ^ (reg >> 8)] ^ crc16Tables[6][data[1] ^ (reg & 0xFF)] ^ crc16Tables[5][data[2]] ^ crc16Tables[4][data[3]] ^
+              crc16Tables[3][data[4]] ^ crc16Tables[2][data[5]] ^ crc16Tables[1][data[6]] ^ crc16Tables[0][data[7]];
+    }
+
+    for(; len > 0; len--, data++){
+        reg = ((reg << 8) & 0xFFFF) ^ crc16Tables[0][((reg >> 8) ^ *data) & 0xFF];
+    }
+
+    return reg;
+}
+
+uint32_t crcUpdate(crcType_t type, uint32_t reg, const uint8_t* data, size_t len){
+    switch(type){
+        case CRC_16:
+            return crc16Update(reg, data, len);
+        case CRC_32:
+            return crc32Update(reg, data, len);
+        default:
+            return reg;
+    }
+}
+
+uint32_t crcCompute(crcType_t type, const uint8_t* data, size_t len){
+    uint32_t reg = crcUpdate(type, crcInitial(type), data, len);
+    return type == CRC_32 ? reg ^ 0xFFFFFFFF : reg;
+}
+
+int crcAppend(crcType_t type, uint8_t* packet, int payloadBytes){
+    uint32_t crc = crcCompute(type, packet, payloadBytes);
+
+    if(type == CRC_32){
+        for(int i = 0; i<4; i++){
+            packet[payloadBytes+i] = (crc >> (8*i)) & 0xFF;
+        }
+    }else if(type == CRC_16){
+        packet[payloadBytes] = crc >> 8;
+        packet[payloadBytes+1] = crc & 0xFF;
+    }
+
+    return payloadBytes+crcBytes(type);
+}
+
+bool crcCheck(crcType_t type, const uint8_t* frame, int frameBytes){
+    if(type == CRC_NONE){
+        return true;
+    }
+
+    if(frameBytes < crcBytes(type)){
+        return false;
+    }
+
+    return crcUpdate(type, crcInitial(type), frame, frameBytes) == crcResidue(type);
+}
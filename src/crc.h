@@ -0,0 +1,97 @@
+#ifndef _CRC_H_
+#define _CRC_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+//Packet CRCs for checking decoded frames
+//
+//Two CRCs are supported:
+//  CRC_16: CRC-16/CCITT-FALSE (poly 0x1021, init 0xFFFF, not reflected, no final XOR).  Appended MSB first.
+//  CRC_32: CRC-32/IEEE 802.3 (poly 0x04C11DB7 reflected, init 0xFFFFFFFF, final XOR 0xFFFFFFFF).  Appended LSB first.
+//A frame is the payload followed by its CRC.  Running the CRC register (without the final XOR) over a whole frame
+//leaves the fixed residue for the CRC type if the frame is intact.
+//
+//crcUpdate processes 8 bytes per iteration with slice-by-8 tables.
+//
+//The k=1 Viterbi traceback produces the packet from the last byte to the first.  To check the frame in the same pass,
+//the traceback runs the CRC register backwards: it starts from the residue and un-processes each byte as it is
+//decoded with crcUnwindByte.  The frame is intact if the register ends at the initial value.  A CRC step is
+//invertible because the table entries differ in the byte shifted out of the register (the top byte for the
+//reflected CRC-32, the bottom byte for CRC-16), so the table index can be recovered from the register.
+
+typedef enum{
+    CRC_NONE = 0,
+    CRC_16,
+    CRC_32
+} crcType_t;
+
+#define CRC_16_INIT (0xFFFF)
+#define CRC_16_RESIDUE (0x0000)
+#define CRC_32_INIT (0xFFFFFFFF)
+#define CRC_32_RESIDUE (0xDEBB20E3)
+
+extern uint32_t crc32Tables[8][256];
+extern uint16_t crc16Tables[8][256];
+extern uint8_t crc32UnwindIdx[256]; //Table index for each top byte of a CRC-32 table entry
+extern uint8_t crc16UnwindIdx[256]; //Table index for each bottom byte of a CRC-16 table entry
+
+/**
+ * @brief Builds the CRC tables on the first call.  Later calls return once the tables are built, so it is safe to call
+ *        from several threads.  Called by the Viterbi decoder init functions
+ */
+void crcInit();
+
+/**
+ * @returns The number of CRC bytes appended to a frame (0 for CRC_NONE)
+ */
+int crcBytes(crcType_t type);
+
+/**
+ * @returns The initial value of the CRC register
+ */
+uint32_t crcInitial(crcType_t type);
+
+/**
+ * @returns The value of the CRC register after an intact frame
+ */
+uint32_t crcResidue(crcType_t type);
+
+/**
+ * @brief Runs the CRC register over the given bytes.  Does not apply the final XOR
+ */
+uint32_t crcUpdate(crcType_t type, uint32_t reg, const uint8_t* data, size_t len);
+
+/**
+ * @brief Computes the CRC of the given bytes, including the final XOR
+ */
+uint32_t crcCompute(crcType_t type, const uint8_t* data, size_t len);
+
+/**
+ * @brief Appends the CRC of the payload to the payload
+ *
+ * @param packet the payload.  Must have room for crcBytes(type) more bytes
+ * @returns The number of bytes in the frame (payloadBytes+crcBytes(type))
+ */
+int crcAppend(crcType_t type, uint8_t* packet, int payloadBytes);
+
+/**
+ * @brief Checks a frame (payload followed by its CRC) in a separate pass.  Always true for CRC_NONE
+ */
+bool crcCheck(crcType_t type, const uint8_t* frame, int frameBytes);
+
+/**
+ * @brief Un-processes one byte from the CRC register.  Inverse of running the register over the byte
+ */
+static inline uint32_t crcUnwindByte(crcType_t type, uint32_t reg, uint8_t byte){
+    if(type == CRC_32){
+        uint8_t idx = crc32UnwindIdx[reg >> 24];
+        return ((reg ^ crc32Tables[0][idx]) << 8) | (uint8_t) (idx ^ byte);
+    }else{
+        uint8_t idx = crc16UnwindIdx[reg & 0xFF];
+        return ((uint32_t) (uint8_t) (idx ^ byte) << 8) | ((reg ^ crc16Tables[0][idx]) >> 8);
+    }
+}
+
+#endif
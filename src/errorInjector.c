@@ -0,0 +1,154 @@
+#include "errorInjector.h"
+#include <math.h>
+#include <string.h>
+
+void xoshiro256ssSeed(xoshiro256ss_t* rng, uint64_t seed){
+    uint64_t state = seed;
+    for(int i = 0; i<4; i++){
+        rng->s[i] = splitmix64(&state);
+    }
+}
+
+void xoshiro256ssJump(xoshiro256ss_t* rng){
+    static const uint64_t jump[] = {0x180ec6d33cfd0abaULL, 0xd5a61266f0c9392cULL, 0xa9582618e03fc9aaULL, 0x39abdc4529b1661cULL};
+
+    uint64_t s0 = 0;
+    uint64_t s1 = 0;
+    uint64_t s2 = 0;
+    uint64_t s3 = 0;
+    for(int i = 0; i<4; i++){
+        for(int b = 0; b<64; b++){
+            if(jump[i] & (((uint64_t) 1) << b)){
+                s0 ^= rng->s[0];
+                s1 ^= rng->s[1];
+                s2 ^= rng->s[2];
+                s3 ^= rng->s[3];
+            }
+            xoshiro256ssNext(rng);
+        }
+    }
+
+    rng->s[0] = s0;
+    rng->s[1] = s1;
+    rng->s[2] = s2;
+    rng->s[3] = s3;
+}
+
+/**
+ * Draws the number of error free bits before the next flip
+ */
+static inline int64_t errorInjectorGeometric(errorInjector_t* injector){
+    double u = 1.0 - xoshiro256ssUniform(&injector->rng); //(0, 1]
+    double skip = floor(log(u)*injector->invLogOneMinusP);
+    return skip < (double) (INT64_MAX/2) ? (int64_t) skip : INT64_MAX/2;
+}
+
+/**
+ * Generates 64 IID bits which are each 1 with probability pFixed/2^ERROR_INJECTOR_DENSE_PRECISION
+ *
+ * The binary digits of p are applied from the LSb: a 1 digit ORs in a random word (P' = (1+P)/2) and a
+ * 0 digit ANDs in a random word (P' = P/2).
+ */
+static inline uint64_t errorInjectorDenseWord(errorInjector_t* injector){
+    if(injector->pFixed >= (((uint64_t) 1) << ERROR_INJECTOR_DENSE_PRECISION)){
+        return UINT64_MAX;
+    }
+
+    uint64_t word = 0;
+    for(int i = __builtin_ctzll(injector->pFixed | (((uint64_t) 1) << ERROR_INJECTOR_DENSE_PRECISION)); i<ERROR_INJECTOR_DENSE_PRECISION; i++){
+        uint64_t r = xoshiro256ssNext(&injector->rng);
+        word = ((injector->pFixed >> i) & 1) ? (word | r) : (word & r);
+    }
+
+    return word;
+}
+
+void errorInjectorInit(errorInjector_t* injector, double errorProbability, uint64_t seed){
+    if(errorProbability < 0){
+        errorProbability = 0;
+    }else if(errorProbability > 1){
+        errorProbability = 1;
+    }
+
+    xoshiro256ssSeed(&injector->rng, seed);
+    injector->errorProbability = errorProbability;
+    injector->useGeometric = errorProbability <= ERROR_INJECTOR_GEOMETRIC_MAX_P;
+    injector->pFixed = (uint64_t) llround(errorProbability * (double) (((uint64_t) 1) << ERROR_INJECTOR_DENSE_PRECISION));
+
+    if(errorProbability == 0){
+        injector->invLogOneMinusP = 0;
+        injector->bitsToNextFlip = INT64_MAX; //Never flip
+    }else{
+        injector->invLogOneMinusP = 1.0/log1p(-errorProbability);
+        injector->bitsToNextFlip = injector->useGeometric ? errorInjectorGeometric(injector) : 0;
+    }
+}
+
+int64_t errorInjectorFlipMask(errorInjector_t* injector, uint64_t* mask, int64_t numBits){
+    int64_t numWords = (numBits+63)/64;
+    int64_t flips = 0;
+
+    if(injector->useGeometric){
+        memset(mask, 0, numWords*sizeof(uint64_t));
+
+        int64_t pos = injector->bitsToNextFlip;
+        while(pos < numBits){
+            mask[pos/64] |= ((uint64_t) 1) << (pos%64);
+            flips++;
+            pos += 1 + errorInjectorGeometric(injector);
+        }
+
+        if(injector->bitsToNextFlip != INT64_MAX){
+            injector->bitsToNextFlip = pos - numBits;
+        }
+    }else{
+        for(int64_t i = 0; i<numWords; i++){
+            uint64_t word = errorInjectorDenseWord(injector);
+            if(i == numWords-1 && numBits%64 != 0){
+                word &= (((uint64_t) 1) << (numBits%64)) - 1;
+            }
+            mask[i] = word;
+            flips += __builtin_popcountll(word);
+        }
+    }
+
+    return flips;
+}
+
+int64_t errorInjectorCorruptSegments(errorInjector_t* injector, uint8_t* segments, int numSegments, int bitsPerSegment){
+    int64_t numBits = ((int64_t) numSegments)*bitsPerSegment;
+    int64_t flips = 0;
+
+    if(injector->useGeometric){
+        int64_t pos = injector->bitsToNextFlip;
+        while(pos < numBits){
+            //The first bit of each segment in the stream is its MSb
+            segments[pos/bitsPerSegment] ^= 1 << (bitsPerSegment - 1 - pos%bitsPerSegment);
+            flips++;
+            pos += 1 + errorInjectorGeometric(injector);
+        }
+
+        if(injector->bitsToNextFlip != INT64_MAX){
+            injector->bitsToNextFlip = pos - numBits;
+        }
+    }else{
+        //The bits are IID so the bit order within the mask does not matter.  Leftover bits in a word are discarded
+        uint8_t segmentMask = (1 << bitsPerSegment) - 1;
+        uint64_t word = 0;
+        int bitsLeft = 0;
+        for(int i = 0; i<numSegments; i++){
+            if(bitsLeft < bitsPerSegment){
+                word = errorInjectorDenseWord(injector);
+                bitsLeft = 64;
+            }
+
+            uint8_t flipBits = word & segmentMask;
+            segments[i] ^= flipBits;
+            flips += __builtin_popcount(flipBits);
+            word >>= bitsPerSegment;
+            bitsLeft -= bitsPerSegment;
+        }
+    }
+
+    return flips;
+}
@@ -0,0 +1,109 @@
+#ifndef _ERROR_INJECTOR_H_
+#define _ERROR_INJECTOR_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+//Fast IID bit error injection for BER simulations
+//
+//Uses the xoshiro256** PRNG (see https://prng.di.unimi.it/) rather than libc rand(), which is not thread safe
+//and cannot resolve error probabilities below 1/RAND_MAX.  Each injector has its own generator state.
+//
+//For low error probabilities, the injector does not draw a random number per bit.  Instead, the number of
+//error free bits before the next flip is drawn from the geometric distribution (floor(log(U)/log(1-p)))
+//and the injector skips directly to the next flip.  The distance to the next flip is carried between calls
+//so a stream of packets sees the same IID channel as one long packet.  For high error probabilities, where
+//skipping has little benefit, 64 flips are generated at once by combining random words according to the
+//binary expansion of p (to ERROR_INJECTOR_DENSE_PRECISION bits).
+
+//***** Injector Options *******
+#define ERROR_INJECTOR_GEOMETRIC_MAX_P (0.25) //Geometric skipping is used for error probabilities up to this value
+#define ERROR_INJECTOR_DENSE_PRECISION (32) //Bits of p used when generating dense flip masks
+//***** End Options ******
+
+typedef struct{
+    uint64_t s[4];
+} xoshiro256ss_t;
+
+typedef struct{
+    xoshiro256ss_t rng;
+    double errorProbability;
+    bool useGeometric;
+    double invLogOneMinusP; //1/log(1-p) for the geometric skip
+    uint64_t pFixed; //p in ERROR_INJECTOR_DENSE_PRECISION bit fixed point for the dense masks
+    int64_t bitsToNextFlip; //Error free bits before the next flip (geometric mode)
+} errorInjector_t;
+
+/**
+ * @brief splitmix64, used to expand seeds (see https://prng.di.unimi.it/splitmix64.c)
+ */
+static inline uint64_t splitmix64(uint64_t* state){
+    uint64_t z = (*state += 0x9e3779b97f4a7c15ULL);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+}
+
+static inline uint64_t xoshiro256ssRotl(const uint64_t x, int shift){
+    return (x << shift) | (x >> (64 - shift));
+}
+
+static inline uint64_t xoshiro256ssNext(xoshiro256ss_t* rng){
+    uint64_t* s = rng->s;
+    const uint64_t result = xoshiro256ssRotl(s[1] * 5, 7) * 9;
+    const uint64_t t = s[1] << 17;
+
+    s[2] ^= s[0];
+    s[3] ^= s[1];
+    s[1] ^= s[2];
+    s[0] ^= s[3];
+
+    s[2] ^= t;
+
+    s[3] = xoshiro256ssRotl(s[3], 45);
+
+    return result;
+}
+
+/**
+ * @brief Uniform double in [0, 1) with 53 bits of resolution
+ */
+static inline double xoshiro256ssUniform(xoshiro256ss_t* rng){
+    return (xoshiro256ssNext(rng) >> 11) * 0x1.0p-53;
+}
+
+/**
+ * @brief Seeds the generator by expanding seed with splitmix64
+ */
+void xoshiro256ssSeed(xoshiro256ss_t* rng, uint64_t seed);
+
+/**
+ * @brief Advances the generator by 2^128 steps.  Can be used to create non-overlapping streams for threads
+ */
+void xoshiro256ssJump(xoshiro256ss_t* rng);
+
+/**
+ * @brief Initializes the injector
+ *
+ * @param errorProbability the probability that each bit is flipped (0 to 1)
+ */
+void errorInjectorInit(errorInjector_t* injector, double errorProbability, uint64_t seed);
+
+/**
+ * @brief Generates a packed flip mask
+ *
+ * @param mask the flip mask, bit i of the stream is bit (i%64) of mask[i/64].  (numBits+63)/64 words are written
+ * @returns the number of flipped bits
+ */
+int64_t errorInjectorFlipMask(errorInjector_t* injector, uint64_t* mask, int64_t numBits);
+
+/**
+ * @brief Flips bits of an array of coded segments in place (one segment of bitsPerSegment bits per byte)
+ *
+ * The bits of the stream are ordered from the MSb of each segment, matching the order the segments are transmitted
+ *
+ * @returns the number of flipped bits
+ */
+int64_t errorInjectorCorruptSegments(errorInjector_t* injector, uint8_t* segments, int numSegments, int bitsPerSegment);
+
+#endif
@@ -0,0 +1,227 @@
+#include "mAlgDecoder.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+void mAlgInit(mAlgDecoderState_t* state, int maxSurvivors, int threshold){
+    if(maxSurvivors < 1 || maxSurvivors > MALG_MAX_SURVIVORS){
+        printf("M must be between 1 and %d\n", MALG_MAX_SURVIVORS);
+        exit(1);
+    }
+
+    resetConvEncoder(&state->encoder);
+    initConvEncoder(&state->encoder);
+
+    state->maxSurvivors = maxSurvivors;
+    state->threshold = threshold;
+
+    for(int i = 0; i<MALG_HASH_SIZE; i++){
+        state->hashStamp[i] = 0;
+    }
+    state->stamp = 0;
+    state->candidatesEvaluated = 0;
+
+    printf("M/T-Algorithm Decoder (M=%d, T=%d)\n", maxSurvivors, threshold);
+}
+
+void mAlgReset(mAlgDecoderState_t* state){
+    state->numSurvivors = 1;
+    state->survivorStates[0] = STARTING_STATE;
+    state->survivorMetrics[0] = 0;
+    state->iteration = 0;
+}
+
+static inline uint32_t mAlgHash(MALG_STATE_TYPE decoderState){
+    return (uint32_t) ((decoderState * 0x9E3779B97F4A7C15ull) >> 32) & (MALG_HASH_SIZE-1);
+}
+
+/**
+ * Partially orders list such that the keep entries with the smallest metrics are in the first keep positions (quickselect)
+ */
+static void mAlgSelect(uint32_t* list, const MALG_METRIC_TYPE* metrics, int count, int keep){
+    int lo = 0;
+    int hi = count-1;
+
+    while(lo < hi){
+        MALG_METRIC_TYPE pivot = metrics[list[lo + (hi-lo)/2]];
+        int i = lo;
+        int j = hi;
+        while(i <= j){
+            while(metrics[list[i]] < pivot){
+                i++;
+            }
+            while(metrics[list[j]] > pivot){
+                j--;
+            }
+            if(i <= j){
+                uint32_t tmp = list[i];
+                list[i] = list[j];
+                list[j] = tmp;
+                i++;
+                j--;
+            }
+        }
+
+        //The first keep entries are those below the pivot in [lo, j], the ones equal to the pivot in (j, i), and possibly some of [i, hi]
+        if(keep-1 <= j){
+            hi = j;
+        }else if(keep-1 >= i){
+            lo = i;
+        }else{
+            break;
+        }
+    }
+}
+
+int mAlgDecoderHard(mAlgDecoderState_t* restrict state, uint8_t* restrict codedSegments, uint8_t* restrict uncoded, int segmentsIn, bool last){
+    MALG_STATE_TYPE stateMask = POW2(k*S)-1;
+
+    //TODO: Remove check
+    if(last && segmentsIn < S){
+        printf("The last call to the M-algorithm decoder must include the S termination segments\n");
+        exit(1);
+    }
+
+    for(int i = 0; i<segmentsIn; i++){
+        uint8_t codedBits = codedSegments[i];
+
+        //During the termination, only the 0 input is possible
+        int numInputs = (last && i >= segmentsIn-S) ? 1 : POW2(k);
+
+        state->stamp++;
+        if(state->stamp == 0){
+            //The stamp wrapped around, clear the hash table
+            for(int j = 0; j<MALG_HASH_SIZE; j++){
+                state->hashStamp[j] = 0;
+            }
+            state->stamp = 1;
+        }
+
+        //Extend each survivor and merge candidates which end in the same state
+        int numUnique = 0;
+        for(int survivor = 0; survivor<state->numSurvivors; survivor++){
+            MALG_STATE_TYPE survivorState = state->survivorStates[survivor];
+            MALG_METRIC_TYPE survivorMetric = state->survivorMetrics[survivor];
+
+            for(int input = 0; input<numInputs; input++){
+                uint32_t cand = survivor*POW2(k) + input;
+                MALG_STATE_TYPE tappedDelay = (survivorState << k) | input;
+                MALG_STATE_TYPE nextState = tappedDelay & stateMask;
+                MALG_METRIC_TYPE metric = survivorMetric + calcHammingDist(computeEncOutputSegmentFor(&state->encoder, tappedDelay), codedBits, n);
+
+                state->candStates[cand] = nextState;
+                state->candMetrics[cand] = metric;
+
+                uint32_t slot = mAlgHash(nextState);
+                while(1){
+                    if(state->hashStamp[slot] != state->stamp){
+                        //New state
+                        state->hashStamp[slot] = state->stamp;
+                        state->hashCand[slot] = numUnique;
+                        state->candList[numUnique] = cand;
+                        numUnique++;
+                        break;
+                    }
+
+                    uint32_t *existing = &(state->candList[state->hashCand[slot]]);
+                    if(state->candStates[*existing] == nextState){
+                        //Merge, keeping the lower metric
+                        if(metric < state->candMetrics[*existing]){
+                            *existing = cand;
+                        }
+                        break;
+                    }
+
+                    slot = (slot+1) & (MALG_HASH_SIZE-1);
+                }
+            }
+        }
+        state->candidatesEvaluated += state->numSurvivors*numInputs;
+
+        //Find the best metric
+        MALG_METRIC_TYPE bestMetric = state->candMetrics[state->candList[0]];
+        for(int j = 1; j<numUnique; j++){
+            MALG_METRIC_TYPE metric = state->candMetrics[state->candList[j]];
+            if(metric < bestMetric){
+                bestMetric = metric;
+            }
+        }
+
+        //T-algorithm: Discard candidates too far from the best
+        if(state->threshold >= 0){
+            MALG_METRIC_TYPE limit = bestMetric + state->threshold;
+            int kept = 0;
+            for(int j = 0; j<numUnique; j++){
+                uint32_t cand = state->candList[j];
+                if(state->candMetrics[cand] <= limit){
+                    state->candList[kept] = cand;
+                    kept++;
+                }
+            }
+            numUnique = kept;
+        }
+
+        //M-algorithm: Keep the best M
+        if(numUnique > state->maxSurvivors){
+            mAlgSelect(state->candList, state->candMetrics, numUnique, state->maxSurvivors);
+            numUnique = state->maxSurvivors;
+        }
+
+        //Record the new survivors
+        MALG_SURVIVOR_STORE_TYPE (* restrict store)[MALG_MAX_SURVIVORS] = &(state->survivorStore[state->iteration]);
+        for(int j = 0; j<numUnique; j++){
+            uint32_t cand = state->candList[j];
+            state->survivorStates[j] = state->candStates[cand];
+            state->survivorMetrics[j] = state->candMetrics[cand];
+            (*store)[j] = cand;
+        }
+        state->numSurvivors = numUnique;
+
+        (state->iteration)++;
+    }
+
+    int segmentsOut = 0;
+
+    if(last){
+        //Select the survivor in the terminated (0) state.  If it was discarded, fall back to the best survivor
+        int selected = -1;
+        int best = 0;
+        for(int j = 0; j<state->numSurvivors; j++){
+            if(state->survivorStates[j] == 0){
+                selected = j;
+            }
+            if(state->survivorMetrics[j] < state->survivorMetrics[best]){
+                best = j;
+            }
+        }
+        if(selected < 0){
+            selected = best;
+        }
+
+        //The padding is not returned
+        unsigned int dataSteps = state->iteration - S;
+        segmentsOut = dataSteps*k/8;
+        memset(uncoded, 0, segmentsOut);
+
+        //Traceback through the survivor store
+        for(int t = state->iteration-1; t>=0; t--){
+            MALG_SURVIVOR_STORE_TYPE cand = state->survivorStore[t][selected];
+            uint8_t decodedBits = cand & (POW2(k)-1);
+            selected = cand >> k;
+
+            if(t < dataSteps){
+                //The encoder transmits the MSb of the k bit segment first
+                for(int b = 0; b<k; b++){
+                    unsigned int bitPos = t*k + b;
+                    uint8_t bit = (decodedBits >> (k-1-b)) & 1;
+                    uncoded[bitPos/8] |= bit << (7 - bitPos%8);
+                }
+            }
+        }
+
+        //Reset state for next packet
+        mAlgReset(state);
+    }
+
+    return segmentsOut;
+}
@@ -0,0 +1,107 @@
+#ifndef _M_ALG_DECODER_H_
+#define _M_ALG_DECODER_H_
+
+#include "convCodeParams.h"
+#include "convHelpers.h"
+#include "convEncode.h"
+#include "viterbiDecoder.h"
+#include <stdbool.h>
+
+//Reduced-state breadth-first decoder (M-algorithm / T-algorithm)
+//
+//The full Viterbi decoder tracks all NUM_STATES = 2^(k*S) states which becomes infeasible
+//for large constraint lengths.  This decoder instead keeps a limited set of survivors at
+//each trellis step:
+//  - M-algorithm: only the best M survivors are kept
+//  - T-algorithm: only survivors within a threshold T of the best survivor are kept
+//Both limits can be active at the same time.  If M >= NUM_STATES and the threshold is disabled,
+//the decoder is equivalent to the full Viterbi decoder (survivors which end in the same state are merged).
+//
+//The trellis is computed on the fly from the encoder polynomials so there are no tables
+//sized by NUM_STATES.
+
+//***** Decoder Options *******
+#ifndef MALG_MAX_SURVIVORS
+    #define MALG_MAX_SURVIVORS (128) //The max value of M.  Sets the size of the survivor store
+#endif
+//***** End Options ******
+
+#define MALG_MAX_CANDIDATES (MALG_MAX_SURVIVORS*POW2(k))
+#define MALG_HASH_SIZE (2*MALG_MAX_CANDIDATES) //Must be a power of 2
+
+#define MALG_METRIC_TYPE uint32_t
+#define MALG_STATE_TYPE uint64_t
+#define MALG_THRESHOLD_DISABLED (-1)
+
+//The survivor store records the candidate index each survivor was selected from.
+//The candidate index encodes both the parent survivor and the input bits (parent*2^k + input)
+#if MALG_MAX_CANDIDATES <= POW2(16)
+    #define MALG_SURVIVOR_STORE_TYPE uint16_t
+#else
+    #define MALG_SURVIVOR_STORE_TYPE uint32_t
+#endif
+
+/**
+ * State for the M/T-algorithm decoder between calls
+ *
+ * @note This structure is large (the survivor store holds MAX_PKT_LEN_SEGMENTS*MALG_MAX_SURVIVORS entries).  Allocate it on the heap.
+ */
+typedef struct{
+    //Code Configuration
+    convEncoderState_t encoder; //Shares the trellis definition with the convolutional encoder
+    int maxSurvivors; //M
+    int threshold; //T, MALG_THRESHOLD_DISABLED if not used
+
+    //Decoder State
+    int numSurvivors;
+    MALG_STATE_TYPE survivorStates[MALG_MAX_SURVIVORS];
+    MALG_METRIC_TYPE survivorMetrics[MALG_MAX_SURVIVORS];
+
+    //Candidate scratch space (the successors of the survivors)
+    MALG_STATE_TYPE candStates[MALG_MAX_CANDIDATES];
+    MALG_METRIC_TYPE candMetrics[MALG_MAX_CANDIDATES];
+    uint32_t candList[MALG_MAX_CANDIDATES]; //The unique candidates remaining after merging
+
+    //Used to merge candidates which end in the same state.  Entries are valid when the stamp matches
+    uint32_t hashStamp[MALG_HASH_SIZE];
+    uint32_t hashCand[MALG_HASH_SIZE];
+    uint32_t stamp;
+
+    unsigned int iteration;
+
+    //The compact survivor store.  One entry per kept survivor per trellis step
+    MALG_SURVIVOR_STORE_TYPE survivorStore[MAX_PKT_LEN_SEGMENTS][MALG_MAX_SURVIVORS];
+
+    //Statistics
+    uint64_t candidatesEvaluated; //Total since init, can be used to report work per bit
+} mAlgDecoderState_t;
+
+/**
+ * @brief Initializes the M/T-algorithm decoder
+ *
+ * @param maxSurvivors M, the maximum number of survivors kept per step.  Must be between 1 and MALG_MAX_SURVIVORS
+ * @param threshold T, survivors with metrics more than T above the best survivor are discarded.  Pass MALG_THRESHOLD_DISABLED to only use M
+ */
+void mAlgInit(mAlgDecoderState_t* state, int maxSurvivors, int threshold);
+
+/**
+ * @brief Resets the decoder for a new packet.  The starting state is STARTING_STATE
+ */
+void mAlgReset(mAlgDecoderState_t* state);
+
+/**
+ * @brief Performs hard decision decoding with the M/T-algorithm.  Has the same interface as the Viterbi decoder
+ *
+ * @note The code is expected to begin in the starting state and end in the 0 state.  The final S segments of the
+ *       call with last set are treated as the termination and are only extended with 0 inputs.  The call with
+ *       last set must therefore contain at least S segments.
+ *
+ * @param codedSegments an array of coded segments.  Each segment is in a separate byte
+ * @param uncoded an array of uncoded bytes.  Written when last is set
+ * @param segmentsIn The number of coded segements being provided
+ * @param last If true, returns the traceback and resets after this iteration
+ * @returns The number of uncoded bytes returned
+ */
+int mAlgDecoderHard(mAlgDecoderState_t* restrict state, uint8_t* restrict codedSegments, uint8_t* restrict uncoded, int segmentsIn, bool last);
+
+#endif
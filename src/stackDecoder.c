@@ -0,0 +1,198 @@
+#include "stackDecoder.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+void stackDecoderInit(stackDecoderState_t* state, double crossoverProb, uint32_t budget){
+    if(crossoverProb <= 0 || crossoverProb >= 0.5){
+        printf("The stack decoder crossover probability must be between 0 and 0.5\n");
+        exit(1);
+    }
+
+    resetConvEncoder(&state->encoder);
+    initConvEncoder(&state->encoder);
+
+    //Fano metric for the BSC: log2(P(r|c)/P(r)) - R per coded bit
+    double matchMetric = log2(1-crossoverProb) + 1 - Rc;
+    double mismatchMetric = log2(crossoverProb) + 1 - Rc;
+    for(int dist = 0; dist<=n; dist++){
+        state->branchMetricByDist[dist] = (STACK_METRIC_TYPE) lround(((n-dist)*matchMetric + dist*mismatchMetric)*STACK_METRIC_SCALE);
+    }
+
+    uint32_t maxBudget = (STACK_MAX_NODES-1)/POW2(k);
+    if(budget == 0 || budget > maxBudget){
+        budget = maxBudget;
+    }
+    state->budget = budget;
+
+    state->totalExpansions = 0;
+    state->totalDecodedBits = 0;
+    state->abortedPackets = 0;
+    state->lastPacketAborted = false;
+
+    printf("Stack Decoder (p=%e, Budget=%u expansions/packet)\n", crossoverProb, budget);
+}
+
+void stackDecoderReset(stackDecoderState_t* state){
+    state->numReceived = 0;
+}
+
+static inline int32_t stackKey(STACK_METRIC_TYPE metric){
+    return metric >> STACK_BUCKET_WIDTH_LOG2; //Arithmetic shift (floor)
+}
+
+static inline void stackPush(stackDecoderState_t* state, uint32_t nodeIdx){
+    int32_t key = stackKey(state->nodes[nodeIdx].metric);
+
+    if(key > state->topKey){
+        //The buckets which now alias keys more than STACK_NUM_BUCKETS below the top are discarded
+        int32_t raise = key - state->topKey;
+        if(raise >= STACK_NUM_BUCKETS){
+            for(int i = 0; i<STACK_NUM_BUCKETS; i++){
+                state->bucketHeads[i] = STACK_NULL_NODE;
+            }
+        }else{
+            for(int32_t clearKey = state->topKey+1; clearKey<=key; clearKey++){
+                state->bucketHeads[clearKey & (STACK_NUM_BUCKETS-1)] = STACK_NULL_NODE;
+            }
+        }
+        state->topKey = key;
+    }else if(key <= state->topKey - STACK_NUM_BUCKETS){
+        //Too far below the top to ever be explored
+        return;
+    }
+
+    uint32_t bucket = key & (STACK_NUM_BUCKETS-1);
+    state->nodes[nodeIdx].next = state->bucketHeads[bucket];
+    state->bucketHeads[bucket] = nodeIdx;
+}
+
+/**
+ * Pops a node from the top non-empty bucket.  Returns STACK_NULL_NODE if the stack is empty
+ */
+static inline uint32_t stackPop(stackDecoderState_t* state){
+    for(int i = 0; i<STACK_NUM_BUCKETS; i++){
+        uint32_t bucket = state->topKey & (STACK_NUM_BUCKETS-1);
+        uint32_t nodeIdx = state->bucketHeads[bucket];
+        if(nodeIdx != STACK_NULL_NODE){
+            state->bucketHeads[bucket] = state->nodes[nodeIdx].next;
+            return nodeIdx;
+        }
+        state->topKey--;
+    }
+
+    return STACK_NULL_NODE;
+}
+
+int stackDecoderHard(stackDecoderState_t* restrict state, uint8_t* restrict codedSegments, uint8_t* restrict uncoded, int segmentsIn, bool last){
+    //TODO: Remove check
+    if(state->numReceived + segmentsIn > MAX_PKT_LEN_SEGMENTS){
+        printf("Packet is longer than the stack decoder supports\n");
+        exit(1);
+    }
+
+    memcpy(state->received+state->numReceived, codedSegments, segmentsIn);
+    state->numReceived += segmentsIn;
+
+    if(!last){
+        return 0;
+    }
+
+    unsigned int totalSteps = state->numReceived;
+    unsigned int dataSteps = totalSteps - S;
+    uint64_t stateMask = POW2(k*S)-1;
+
+    for(int i = 0; i<STACK_NUM_BUCKETS; i++){
+        state->bucketHeads[i] = STACK_NULL_NODE;
+    }
+
+    //The root node
+    state->nodes[0].state = STARTING_STATE;
+    state->nodes[0].metric = 0;
+    state->nodes[0].parent = STACK_NULL_NODE;
+    state->nodes[0].depth = 0;
+    state->nodes[0].input = 0;
+    state->numNodes = 1;
+    state->topKey = stackKey(0);
+    stackPush(state, 0);
+
+    uint32_t expansions = 0;
+    uint32_t deepestNode = 0;
+    uint32_t finalNode = STACK_NULL_NODE;
+
+    while(1){
+        uint32_t nodeIdx = stackPop(state);
+        if(nodeIdx == STACK_NULL_NODE){
+            break;
+        }
+
+        stackNode_t node = state->nodes[nodeIdx];
+        if(node.depth == totalSteps){
+            finalNode = nodeIdx;
+            break;
+        }
+
+        if(expansions >= state->budget){
+            break;
+        }
+        expansions++;
+
+        //During the termination, only the 0 input is possible
+        int numInputs = node.depth >= dataSteps ? 1 : POW2(k);
+        uint8_t codedBits = state->received[node.depth];
+
+        for(int input = 0; input<numInputs; input++){
+            uint64_t tappedDelay = (node.state << k) | input;
+            uint8_t dist = calcHammingDist(computeEncOutputSegmentFor(&state->encoder, tappedDelay), codedBits, n);
+
+            uint32_t childIdx = state->numNodes;
+            state->numNodes++;
+
+            stackNode_t* child = &(state->nodes[childIdx]);
+            child->state = tappedDelay & stateMask;
+            child->metric = node.metric + state->branchMetricByDist[dist];
+            child->parent = nodeIdx;
+            child->depth = node.depth+1;
+            child->input = input;
+
+            if(child->depth > state->nodes[deepestNode].depth || (child->depth == state->nodes[deepestNode].depth && child->metric > state->nodes[deepestNode].metric)){
+                deepestNode = childIdx;
+            }
+
+            stackPush(state, childIdx);
+        }
+    }
+
+    state->lastPacketAborted = finalNode == STACK_NULL_NODE;
+    if(state->lastPacketAborted){
+        //Return the deepest explored path.  The undecoded bits are returned as 0
+        finalNode = deepestNode;
+        state->abortedPackets++;
+    }
+
+    state->totalExpansions += expansions;
+    state->totalDecodedBits += dataSteps*k;
+
+    int segmentsOut = dataSteps*k/8;
+    memset(uncoded, 0, segmentsOut);
+
+    //Traceback through the parent links
+    for(uint32_t nodeIdx = finalNode; state->nodes[nodeIdx].parent != STACK_NULL_NODE; nodeIdx = state->nodes[nodeIdx].parent){
+        unsigned int t = state->nodes[nodeIdx].depth-1;
+        if(t < dataSteps){
+            uint8_t decodedBits = state->nodes[nodeIdx].input;
+            //The encoder transmits the MSb of the k bit segment first
+            for(int b = 0; b<k; b++){
+                unsigned int bitPos = t*k + b;
+                uint8_t bit = (decodedBits >> (k-1-b)) & 1;
+                uncoded[bitPos/8] |= bit << (7 - bitPos%8);
+            }
+        }
+    }
+
+    //Reset state for next packet
+    stackDecoderReset(state);
+
+    return segmentsOut;
+}
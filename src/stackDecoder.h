@@ -0,0 +1,99 @@
+#ifndef _STACK_DECODER_H_
+#define _STACK_DECODER_H_
+
+#include "convCodeParams.h"
+#include "convHelpers.h"
+#include "convEncode.h"
+#include "viterbiDecoder.h"
+#include <stdbool.h>
+
+//Sequential (stack algorithm) decoder
+//
+//The stack algorithm explores the code tree best-first using the Fano metric.  When the channel is
+//clean, the correct path is extended with very little backtracking so the work per bit is close to
+//2^k branch metric computations, independent of the number of states.  The work grows with the
+//channel noise.  A computational budget caps the number of node expansions per packet to bound the
+//worst-case latency.
+//
+//The stack is implemented as a bucketed priority queue (Jelinek's stack bucket algorithm).  Nodes
+//are placed in buckets by their quantized metric and the top non-empty bucket is popped.  The
+//buckets are circular; nodes which fall more than STACK_NUM_BUCKETS buckets below the top are
+//discarded since they would never be explored within the budget.
+
+//***** Decoder Options *******
+#ifndef STACK_MAX_NODES
+    #define STACK_MAX_NODES (1 << 20) //The size of the node pool.  Limits the budget to (STACK_MAX_NODES-1)/2^k expansions per packet
+#endif
+#define STACK_NUM_BUCKETS (1024) //Must be a power of 2
+#define STACK_BUCKET_WIDTH_LOG2 (2) //Metric units per bucket (log2)
+#define STACK_METRIC_SCALE (8.0) //The Fano metric (in bits) is scaled by this and rounded to integers
+//***** End Options ******
+
+#define STACK_METRIC_TYPE int32_t
+#define STACK_NULL_NODE (UINT32_MAX)
+
+typedef struct{
+    uint64_t state; //The encoder state (tapped delay excluding the next input)
+    STACK_METRIC_TYPE metric;
+    uint32_t parent;
+    uint32_t next; //The next node in the same bucket
+    uint32_t depth; //The number of trellis steps from the root
+    uint8_t input;
+} stackNode_t;
+
+/**
+ * State for the stack decoder between calls.  The received segments are buffered until the last call
+ *
+ * @note This structure is large.  Allocate it on the heap.
+ */
+typedef struct{
+    //Code Configuration
+    convEncoderState_t encoder; //Shares the trellis definition with the convolutional encoder
+    STACK_METRIC_TYPE branchMetricByDist[n+1]; //The Fano metric of a branch given its Hamming distance from the received segment
+    uint32_t budget; //Max node expansions per packet
+
+    //Received segments
+    uint8_t received[MAX_PKT_LEN_SEGMENTS];
+    unsigned int numReceived;
+
+    //Stack
+    uint32_t bucketHeads[STACK_NUM_BUCKETS];
+    int32_t topKey;
+    uint32_t numNodes;
+    stackNode_t nodes[STACK_MAX_NODES];
+
+    //Statistics
+    uint64_t totalExpansions;
+    uint64_t totalDecodedBits;
+    uint64_t abortedPackets;
+    bool lastPacketAborted;
+} stackDecoderState_t;
+
+/**
+ * @brief Initializes the stack decoder
+ *
+ * @param crossoverProb the assumed bit error probability of the binary symmetric channel.  Used to compute the Fano metric
+ * @param budget the max number of node expansions per packet.  When it is exceeded, the deepest explored path is returned (padded with 0s) and lastPacketAborted is set.  Pass 0 to use the largest budget the node pool supports.
+ */
+void stackDecoderInit(stackDecoderState_t* state, double crossoverProb, uint32_t budget);
+
+/**
+ * @brief Resets the decoder for a new packet
+ */
+void stackDecoderReset(stackDecoderState_t* state);
+
+/**
+ * @brief Performs hard decision sequential decoding.  Has the same interface as the Viterbi decoder
+ *
+ * @note The code is expected to begin in the starting state and end in the 0 state.  The segments are buffered
+ *       and the packet is decoded when last is set.
+ *
+ * @param codedSegments an array of coded segments.  Each segment is in a separate byte
+ * @param uncoded an array of uncoded bytes.  Written when last is set
+ * @param segmentsIn The number of coded segements being provided
+ * @param last If true, decodes the packet and resets after this iteration
+ * @returns The number of uncoded bytes returned
+ */
+int stackDecoderHard(stackDecoderState_t* restrict state, uint8_t* restrict codedSegments, uint8_t* restrict uncoded, int segmentsIn, bool last);
+
+#endif
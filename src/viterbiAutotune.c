@@ -0,0 +1,288 @@
+#include "viterbiAutotune.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <time.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+    #include <cpuid.h>
+#endif
+
+#define VITERBI_AUTOTUNE_NAME_LEN (128)
+#define VITERBI_AUTOTUNE_LINE_LEN (VITERBI_AUTOTUNE_FINGERPRINT_LEN+VITERBI_AUTOTUNE_KEY_LEN+VITERBI_AUTOTUNE_NAME_LEN+64)
+
+typedef struct timespec timespec_t;
+static double autotuneDiffTimespec(timespec_t* a, timespec_t* b){
+    double a_double = a->tv_sec + (a->tv_nsec)*(0.000000001);
+    double b_double = b->tv_sec + (b->tv_nsec)*(0.000000001);
+    return a_double - b_double;
+}
+
+//Replaces whitespace with _ so that the fingerprint is a single token in the wisdom file
+static void autotuneSanitize(char* str){
+    //Trim trailing whitespace
+    size_t len = strlen(str);
+    while(len > 0 && isspace((unsigned char) str[len-1])){
+        str[--len] = '\0';
+    }
+
+    //Trim leading whitespace
+    size_t start = 0;
+    while(isspace((unsigned char) str[start])){
+        start++;
+    }
+    memmove(str, str+start, len-start+1);
+
+    for(char* c = str; *c != '\0'; c++){
+        if(isspace((unsigned char) *c)){
+            *c = '_';
+        }
+    }
+}
+
+void viterbiAutotuneFingerprint(char* fingerprint, size_t len){
+    char brand[VITERBI_AUTOTUNE_FINGERPRINT_LEN] = "";
+
+    #if defined(__x86_64__) || defined(__i386__)
+        //The processor brand string is returned by cpuid leaves 0x80000002-0x80000004
+        unsigned int eax, ebx, ecx, edx;
+        if(__get_cpuid(0x80000000, &eax, &ebx, &ecx, &edx) && eax >= 0x80000004){
+            unsigned int regs[12];
+            for(unsigned int leaf = 0; leaf<3; leaf++){
+                __get_cpuid(0x80000002+leaf, &regs[leaf*4], &regs[leaf*4+1], &regs[leaf*4+2], &regs[leaf*4+3]);
+            }
+            memcpy(brand, regs, sizeof(regs));
+            brand[sizeof(regs)] = '\0';
+        }
+    #endif
+
+    if(brand[0] == '\0'){
+        //Fall back to /proc/cpuinfo
+        FILE* cpuinfo = fopen("/proc/cpuinfo", "r");
+        if(cpuinfo != NULL){
+            char line[VITERBI_AUTOTUNE_LINE_LEN];
+            while(fgets(line, sizeof(line), cpuinfo) != NULL){
+                if(strncmp(line, "model name", 10) == 0 || strncmp(line, "Model", 5) == 0 || strncmp(line, "CPU part", 8) == 0){
+                    char* value = strchr(line, ':');
+                    if(value != NULL){
+                        snprintf(brand, sizeof(brand), "%s", value+1);
+                        break;
+                    }
+                }
+            }
+            fclose(cpuinfo);
+        }
+    }
+
+    autotuneSanitize(brand);
+    snprintf(fingerprint, len, "%s", brand[0] == '\0' ? "unknownCPU" : brand);
+}
+
+void viterbiAutotuneCodeKey(int constraintLength, int inputBits, int outputBits, const uint64_t* generators, char* key, size_t len){
+    int pos = snprintf(key, len, "K%d_k%d_n%d_g", constraintLength, inputBits, outputBits);
+    for(int i = 0; i<outputBits && pos >= 0 && (size_t) pos<len; i++){
+        pos += snprintf(key+pos, len-pos, "%s0%lo", i == 0 ? "" : "_", generators[i]);
+    }
+}
+
+double viterbiAutotuneBenchmark(const codeRegistryEntry_t* entry){
+    int maxCodedSegments = 8*VITERBI_AUTOTUNE_PKT_BYTE_LEN/entry->inputBits + entry->constraintLength;
+
+    uint8_t (*uncodedPkts)[VITERBI_AUTOTUNE_PKT_BYTE_LEN] = malloc(sizeof(uint8_t[VITERBI_AUTOTUNE_PKTS][VITERBI_AUTOTUNE_PKT_BYTE_LEN]));
+    uint8_t* codedSegments = malloc(VITERBI_AUTOTUNE_PKTS*maxCodedSegments);
+    int codedSegmentsLen[VITERBI_AUTOTUNE_PKTS];
+    uint8_t decodedPkt[VITERBI_AUTOTUNE_PKT_BYTE_LEN];
+
+    void* encoderState = codeRegistryAllocState(entry, entry->encoderStateSize);
+    void* decoderState = codeRegistryAllocState(entry, entry->decoderStateSize);
+    if(uncodedPkts == NULL || codedSegments == NULL || encoderState == NULL || decoderState == NULL){
+        printf("Unable to allocate autotune buffers\n");
+        exit(1);
+    }
+
+    //Synthetic packets (error free).  A local generator is used so that the caller's rand() sequence is not disturbed
+    unsigned int seed = VITERBI_AUTOTUNE_SEED;
+    entry->encoderInit(encoderState);
+    for(int pkt = 0; pkt<VITERBI_AUTOTUNE_PKTS; pkt++){
+        for(int i = 0; i<VITERBI_AUTOTUNE_PKT_BYTE_LEN; i++){
+            uncodedPkts[pkt][i] = (uint8_t) rand_r(&seed);
+        }
+        codedSegmentsLen[pkt] = entry->encode(encoderState, uncodedPkts[pkt], codedSegments+pkt*maxCodedSegments, VITERBI_AUTOTUNE_PKT_BYTE_LEN, true);
+    }
+
+    entry->decoderInit(decoderState);
+
+    //Warm-up, also checks that the variant decodes correctly
+    bool correct = true;
+    for(int rep = 0; rep<VITERBI_AUTOTUNE_WARMUP_REPS; rep++){
+        for(int pkt = 0; pkt<VITERBI_AUTOTUNE_PKTS; pkt++){
+            int bytesOut = entry->decode(decoderState, codedSegments+pkt*maxCodedSegments, decodedPkt, codedSegmentsLen[pkt], true);
+            if(bytesOut != VITERBI_AUTOTUNE_PKT_BYTE_LEN || memcmp(decodedPkt, uncodedPkts[pkt], VITERBI_AUTOTUNE_PKT_BYTE_LEN) != 0){
+                correct = false;
+            }
+        }
+    }
+
+    double mbps = -1;
+    if(correct){
+        int64_t bytesDecoded = 0;
+        double duration = 0;
+
+        timespec_t startTime;
+        asm volatile ("" ::: "memory"); //Stop Re-ordering of timer
+        clock_gettime(CLOCK_MONOTONIC, &startTime);
+        asm volatile ("" ::: "memory"); //Stop Re-ordering of timer
+        while(duration < VITERBI_AUTOTUNE_MIN_DURATION){
+            for(int pkt = 0; pkt<VITERBI_AUTOTUNE_PKTS; pkt++){
+                entry->decode(decoderState, codedSegments+pkt*maxCodedSegments, decodedPkt, codedSegmentsLen[pkt], true);
+                bytesDecoded+=VITERBI_AUTOTUNE_PKT_BYTE_LEN;
+
+                asm volatile(""
+                :
+                : "r" (*(const uint8_t (*)[]) decodedPkt)
+                :);
+            }
+
+            timespec_t currentTime;
+            asm volatile ("" ::: "memory"); //Stop Re-ordering of timer
+            clock_gettime(CLOCK_MONOTONIC, &currentTime);
+            asm volatile ("" ::: "memory"); //Stop Re-ordering of timer
+            duration = autotuneDiffTimespec(&currentTime, &startTime);
+        }
+
+        mbps = bytesDecoded*8 / duration / 1e6;
+    }
+
+    free(uncodedPkts);
+    free(codedSegments);
+    free(encoderState);
+    free(decoderState);
+
+    return mbps;
+}
+
+static bool autotuneEntryMatches(const codeRegistryEntry_t* entry, const char* codeKey){
+    char entryKey[VITERBI_AUTOTUNE_KEY_LEN];
+    viterbiAutotuneCodeKey(entry->constraintLength, entry->inputBits, entry->outputBits, entry->generators, entryKey, sizeof(entryKey));
+    return strcmp(entryKey, codeKey) == 0;
+}
+
+/**
+ * Looks up the selection for the given fingerprint and code in the wisdom file.  Returns false if there is no usable entry
+ */
+static bool autotuneReadWisdom(const char* wisdomPath, const char* fingerprint, const char* codeKey, viterbiAutotuneResult_t* result){
+    FILE* wisdom = fopen(wisdomPath, "r");
+    if(wisdom == NULL){
+        return false;
+    }
+
+    bool found = false;
+    char line[VITERBI_AUTOTUNE_LINE_LEN];
+    while(!found && fgets(line, sizeof(line), wisdom) != NULL){
+        char lineFingerprint[VITERBI_AUTOTUNE_FINGERPRINT_LEN];
+        char lineKey[VITERBI_AUTOTUNE_KEY_LEN];
+        char lineName[VITERBI_AUTOTUNE_NAME_LEN];
+        double lineMbps;
+        if(sscanf(line, "%127s %255s %127s %lf", lineFingerprint, lineKey, lineName, &lineMbps) != 4){
+            continue;
+        }
+
+        if(strcmp(lineFingerprint, fingerprint) != 0 || strcmp(lineKey, codeKey) != 0){
+            continue;
+        }
+
+        //The binary may have been rebuilt with a different set of variants
+        const codeRegistryEntry_t* entry = codeRegistryLookupByName(lineName);
+        if(entry != NULL && autotuneEntryMatches(entry, codeKey)){
+            result->entry = entry;
+            result->mbps = lineMbps;
+            result->fromWisdom = true;
+            found = true;
+        }
+    }
+
+    fclose(wisdom);
+    return found;
+}
+
+/**
+ * Replaces the selection for the given fingerprint and code in the wisdom file.  Other lines are preserved
+ */
+static void autotuneWriteWisdom(const char* wisdomPath, const char* fingerprint, const char* codeKey, const viterbiAutotuneResult_t* result){
+    char tmpPath[VITERBI_AUTOTUNE_LINE_LEN];
+    snprintf(tmpPath, sizeof(tmpPath), "%s.tmp", wisdomPath);
+
+    FILE* tmp = fopen(tmpPath, "w");
+    if(tmp == NULL){
+        printf("Unable to write the autotune wisdom file %s\n", tmpPath);
+        return;
+    }
+
+    FILE* wisdom = fopen(wisdomPath, "r");
+    if(wisdom != NULL){
+        char line[VITERBI_AUTOTUNE_LINE_LEN];
+        while(fgets(line, sizeof(line), wisdom) != NULL){
+            char lineFingerprint[VITERBI_AUTOTUNE_FINGERPRINT_LEN];
+            char lineKey[VITERBI_AUTOTUNE_KEY_LEN];
+            if(sscanf(line, "%127s %255s", lineFingerprint, lineKey) == 2 && strcmp(lineFingerprint, fingerprint) == 0 && strcmp(lineKey, codeKey) == 0){
+                continue;
+            }
+            fputs(line, tmp);
+        }
+        fclose(wisdom);
+    }
+
+    fprintf(tmp, "%s %s %s %.2f\n", fingerprint, codeKey, result->entry->name, result->mbps);
+    fclose(tmp);
+
+    if(rename(tmpPath, wisdomPath) != 0){
+        printf("Unable to write the autotune wisdom file %s\n", wisdomPath);
+        remove(tmpPath);
+    }
+}
+
+void viterbiAutotune(int constraintLength, int inputBits, int outputBits, const uint64_t* generators, const char* wisdomPath, bool retune, viterbiAutotuneResult_t* result){
+    if(wisdomPath == NULL){
+        wisdomPath = VITERBI_AUTOTUNE_WISDOM_FILE;
+    }
+
+    result->entry = NULL;
+    result->mbps = 0;
+    result->fromWisdom = false;
+    result->variantsBenchmarked = 0;
+
+    char fingerprint[VITERBI_AUTOTUNE_FINGERPRINT_LEN];
+    char codeKey[VITERBI_AUTOTUNE_KEY_LEN];
+    viterbiAutotuneFingerprint(fingerprint, sizeof(fingerprint));
+    viterbiAutotuneCodeKey(constraintLength, inputBits, outputBits, generators, codeKey, sizeof(codeKey));
+
+    if(!retune && autotuneReadWisdom(wisdomPath, fingerprint, codeKey, result)){
+        return;
+    }
+
+    for(int i = 0; i<codeRegistryNumCodes; i++){
+        const codeRegistryEntry_t* entry = codeRegistryTable[i];
+        if(!autotuneEntryMatches(entry, codeKey)){
+            continue;
+        }
+
+        double mbps = viterbiAutotuneBenchmark(entry);
+        result->variantsBenchmarked++;
+        printf("Autotune: %s (%s): ", entry->name, entry->variant);
+        if(mbps < 0){
+            printf("Decode Check Failed\n");
+            continue;
+        }
+        printf("%8.3f Mbps\n", mbps);
+
+        if(mbps > result->mbps){
+            result->entry = entry;
+            result->mbps = mbps;
+        }
+    }
+
+    if(result->entry != NULL){
+        autotuneWriteWisdom(wisdomPath, fingerprint, codeKey, result);
+    }
+}
@@ -0,0 +1,65 @@
+#ifndef _VITERBI_AUTOTUNE_H_
+#define _VITERBI_AUTOTUNE_H_
+
+#include "codeRegistry.h"
+
+//Startup autotuner which selects the fastest decoder variant of a code on the current machine
+//
+//The decoder variants (ex. with/without popcnt, with/without the polynomial symmetry, different
+//renormalization intervals) are compiled into the binary as separate registry entries with the
+//same code parameters (see the -D flags in scripts/multiCode/genMultiCode.py).  viterbiAutotune
+//benchmarks each matching entry on synthetic packets and returns the fastest one.
+//
+//Like FFTW's wisdom, the result is persisted in a small text file so that later runs on the same
+//machine skip the benchmark.  Each line of the file is
+//    <cpu fingerprint> <code key> <entry name> <Mbps>
+//Results from other machines (different fingerprint) are kept but ignored.
+
+//***** Autotune Options *******
+#define VITERBI_AUTOTUNE_WISDOM_FILE ".viterbiWisdom"
+#define VITERBI_AUTOTUNE_PKT_BYTE_LEN (2048/8)
+#define VITERBI_AUTOTUNE_PKTS (8)
+#define VITERBI_AUTOTUNE_WARMUP_REPS (2) //Passes over the packets before timing (also used to check the decoded packets)
+#define VITERBI_AUTOTUNE_MIN_DURATION (0.25) //Minimum time (in seconds) to benchmark each variant
+#define VITERBI_AUTOTUNE_SEED (2718)
+//***** End Options ******
+
+#define VITERBI_AUTOTUNE_FINGERPRINT_LEN (128)
+#define VITERBI_AUTOTUNE_KEY_LEN (256)
+
+typedef struct{
+    const codeRegistryEntry_t* entry; //The selected variant
+    double mbps; //The measured (or remembered) throughput of the selected variant
+    bool fromWisdom; //True if the selection was read from the wisdom file
+    int variantsBenchmarked;
+} viterbiAutotuneResult_t;
+
+/**
+ * @brief Selects the fastest registered decoder variant for the given code
+ *
+ * @param generators the outputBits generator polynomials
+ * @param wisdomPath the wisdom file.  If NULL, VITERBI_AUTOTUNE_WISDOM_FILE is used
+ * @param retune if true, the wisdom file is ignored and the variants are benchmarked again
+ * @param result the selected variant.  result->entry is NULL if no variant of the code is registered
+ *               or no variant decoded the synthetic packets correctly
+ */
+void viterbiAutotune(int constraintLength, int inputBits, int outputBits, const uint64_t* generators, const char* wisdomPath, bool retune, viterbiAutotuneResult_t* result);
+
+/**
+ * @brief Benchmarks a single registry entry
+ *
+ * @returns the decode throughput in Mbps or a negative value if the synthetic packets were not decoded correctly
+ */
+double viterbiAutotuneBenchmark(const codeRegistryEntry_t* entry);
+
+/**
+ * @brief Writes a fingerprint of the CPU (the brand string without whitespace) to fingerprint
+ */
+void viterbiAutotuneFingerprint(char* fingerprint, size_t len);
+
+/**
+ * @brief Writes a key identifying the code parameters (ex. K7_k1_n2_g0113_0171) to key
+ */
+void viterbiAutotuneCodeKey(int constraintLength, int inputBits, int outputBits, const uint64_t* generators, char* key, size_t len);
+
+#endif
@@ -37,6 +37,7 @@ void viterbiInit(viterbiHardState_t* state){
     initConvEncoder(&tmpEncoder);
 
     // printf("Decoder Trellis Init\n");
+    crcInit();
 
     for(int edgeInd = 0; edgeInd < POW2(k); edgeInd++){
         for(int stateInd = 0; stateInd < NUM_STATES; stateInd++){
@@ -233,6 +234,89 @@ int viterbiDecoderHard(viterbiHardState_t* restrict state, uint8_t* restrict cod
     return segmentsOut;
 }
 
+/**
+ * The metric difference between the best and second best paths into the terminating state (0) for the next trellis step.
+ * State 0 is reached with the 0 input from the states with only the k MSbs set
+ */
+static uint32_t viterbiTerminatingMargin(const viterbiHardState_t* state, uint8_t codedBits){
+    uint32_t best = UINT32_MAX;
+    uint32_t secondBest = UINT32_MAX;
+    for(int edgeIn = 0; edgeIn<POW2(k); edgeIn++){
+        int srcNodeIdx = edgeIn*POW2((S-1)*k);
+        uint32_t pathMetric = (*state->nodeMetricsCur)[srcNodeIdx] + calcHammingDist(state->edgeCodedBits[0][srcNodeIdx], codedBits, n);
+        if(pathMetric < best){
+            secondBest = best;
+            best = pathMetric;
+        }else if(pathMetric < secondBest){
+            secondBest = pathMetric;
+        }
+    }
+
+    return secondBest-best;
+}
+
+viterbiDecodeResult_t viterbiDecoderHardEx(viterbiHardState_t* restrict state, uint8_t* restrict codedSegments, uint8_t* restrict uncoded, int segmentsIn, bool last, crcType_t crc){
+    if(state->iteration == 0){
+        state->crcRegister = crcInitial(crc);
+    }
+
+    viterbiDecodeResult_t result = {0, false, 0, 0};
+
+    //The last step is run on its own to measure the margin into the terminating state and the final traceback is
+    //run once the path metric has been read.  The packet is returned in order as the traceback window advances
+    int leadingSegments = last && segmentsIn > 0 ? segmentsIn-1 : segmentsIn;
+    result.bytesOut = viterbiDecoderHard(state, codedSegments, uncoded, leadingSegments, false);
+
+    if(last){
+        if(segmentsIn > 0){
+            result.margin = viterbiTerminatingMargin(state, codedSegments[segmentsIn-1]);
+            result.bytesOut += viterbiDecoderHard(state, codedSegments+leadingSegments, uncoded+result.bytesOut, 1, false);
+        }
+        result.pathMetric = (*state->nodeMetricsCur)[0];
+        result.bytesOut += viterbiDecoderHard(state, NULL, uncoded+result.bytesOut, 0, true);
+    }
+
+    state->crcRegister = crcUpdate(crc, state->crcRegister, uncoded, result.bytesOut);
+    result.crcOk = last && (crc == CRC_NONE || state->crcRegister == crcResidue(crc));
+
+    return result;
+}
+
+int viterbiDecoderHardBatch(viterbiHardState_t* restrict state, uint8_t* restrict codedSegments, uint8_t* restrict uncoded, const viterbiBatchFrame_t* frames, int numFrames){
+    return viterbiDecoderHardBatchEx(state, codedSegments, uncoded, frames, numFrames, CRC_NONE, NULL);
+}
+
+int viterbiDecoderHardBatchEx(viterbiHardState_t* restrict state, uint8_t* restrict codedSegments, uint8_t* restrict uncoded, const viterbiBatchFrame_t* frames, int numFrames, crcType_t crc, bool* crcOk){
+    if(state->iteration != 0){
+        printf("Batch decode started part way through a packet\n");
+        exit(1);
+    }
+
+    int bytesOut = 0;
+    for(int i = 0; i<numFrames; i++){
+        if(frames[i].numSegments <= S || frames[i].numSegments > MAX_PKT_LEN_SEGMENTS){
+            printf("Batch frame %d has %d segments, must be more than %d and at most %d\n", i, frames[i].numSegments, S, MAX_PKT_LEN_SEGMENTS);
+            exit(1);
+        }
+
+        //The frames are small, start loading the next frame while this one is decoded
+        if(i+1<numFrames){
+            __builtin_prefetch(codedSegments+frames[i+1].codedOffset);
+        }
+
+        //Decoding with last set resets the node metrics for the next frame
+        if(crcOk == NULL){
+            bytesOut += VITERBI_DECODER_HARD(state, codedSegments+frames[i].codedOffset, uncoded+frames[i].uncodedOffset, frames[i].numSegments, true);
+        }else{
+            viterbiDecodeResult_t result = VITERBI_DECODER_HARD_EX(state, codedSegments+frames[i].codedOffset, uncoded+frames[i].uncodedOffset, frames[i].numSegments, true, crc);
+            bytesOut += result.bytesOut;
+            crcOk[i] = result.crcOk;
+        }
+    }
+
+    return bytesOut;
+}
+
 void resetViterbiDecoderHard(viterbiHardState_t* state){
     state->nodeMetricsCur = &(state->nodeMetricsA);
     state->nodeMetricsNext = &(state->nodeMetricsB);
@@ -243,7 +327,7 @@ void resetViterbiDecoderHard(viterbiHardState_t* state){
     (*state->nodeMetricsCur)[STARTING_STATE] = 0;
 
     //Need to set the node metrics so that the initial path is the only non
-    METRIC_TYPE forceNot = NUM_STATES+1;
+    METRIC_TYPE forceNot = (S+1)*MAX_EDGE_WEIGHT;
     for(int i = 0; i<NUM_STATES; i++){
         if(i != STARTING_STATE){
             (*state->nodeMetricsCur)[i] = forceNot;
@@ -253,6 +337,7 @@ void resetViterbiDecoderHard(viterbiHardState_t* state){
     }
 
     state->iteration = 0;
+    state->renormOffset = 0;
     state->decodeCarryOver = 0;
     state->decodeCarryOverCount = 0;
 }
@@ -297,6 +382,10 @@ int argminPathMetrics(const METRIC_TYPE (*metrics)[POW2(k)]){
         return argmin32(metrics);
     #elif POW2(k) == 64
         return argmin64(metrics);
+    #elif POW2(k) == 128
+        return argmin128(metrics);
+    #elif POW2(k) == 256
+        return argmin256(metrics);
     #elif !defined(SIMPLE_MIN)
         #warning using unspecialized argmin
         //There are 2^k paths to check
@@ -361,6 +450,10 @@ int argminNodeMetrics(const METRIC_TYPE (*metrics)[NUM_STATES]){
         return argmin32(metrics);
     #elif NUM_STATES == 64
         return argmin64(metrics);
+    #elif NUM_STATES == 128
+        return argmin128(metrics);
+    #elif NUM_STATES == 256
+        return argmin256(metrics);
     #elif !defined(SIMPLE_MIN)
         #warning using unspecialized argmin
         //There are 2^k paths to check
@@ -495,5 +588,47 @@ int argmin64(const METRIC_TYPE (*metrics)[64]){
     ARGMIN_LAST_STAGE(stage5, (*metrics))
 }
 
+int argmin128(const METRIC_TYPE (*metrics)[128]){
+    //Do this in a tree fashion - hopefully it gives the compiler opertunities to overlap computatation
+
+    //Stage 1, Reduce from 128 to 64
+    ARGMIN_FIRST_STAGE(stage1, (*metrics), 64)
+    //Stage 2, Reduce from 64 to 32
+    ARGMIN_INNER_STAGE(stage2, stage1, (*metrics), 32)
+    //Stage 3, Reduce from 32 to 16
+    ARGMIN_INNER_STAGE(stage3, stage2, (*metrics), 16)
+    //Stage 4, Reduce from 16 to 8
+    ARGMIN_INNER_STAGE(stage4, stage3, (*metrics), 8)
+    //Stage 5, Reduce from 8 to 4
+    ARGMIN_INNER_STAGE(stage5, stage4, (*metrics), 4)
+    //Stage 6, Reduce from 4 to 2
+    ARGMIN_INNER_STAGE(stage6, stage5, (*metrics), 2)
+    //Stage 7, Reduce from 2 to 1
+    ARGMIN_LAST_STAGE(stage6, (*metrics))
+}
+
+int argmin256(const METRIC_TYPE (*metrics)[256]){
+    //Do this in a tree fashion - hopefully it gives the compiler opertunities to overlap computatation
+
+    //Stage 1, Reduce from 256 to 128
+    ARGMIN_FIRST_STAGE(stage1, (*metrics), 128)
+    //Stage 2, Reduce from 128 to 64
+    ARGMIN_INNER_STAGE(stage2, stage1, (*metrics), 64)
+    //Stage 3, Reduce from 64 to 32
+    ARGMIN_INNER_STAGE(stage3, stage2, (*metrics), 32)
+    //Stage 4, Reduce from 32 to 16
+    ARGMIN_INNER_STAGE(stage4, stage3, (*metrics), 16)
+    //Stage 5, Reduce from 16 to 8
+    ARGMIN_INNER_STAGE(stage5, stage4, (*metrics), 8)
+    //Stage 6, Reduce from 8 to 4
+    ARGMIN_INNER_STAGE(stage6, stage5, (*metrics), 4)
+    //Stage 7, Reduce from 4 to 2
+    ARGMIN_INNER_STAGE(stage7, stage6, (*metrics), 2)
+    //Stage 8, Reduce from 2 to 1
+    ARGMIN_LAST_STAGE(stage7, (*metrics))
+}
+
 //Include the specialized butterfly versions
-#include "viterbiDecoderButterflyk1.c"
\ No newline at end of file
+#include "viterbiDecoderButterflyk1.c"
+#include "viterbiDecoderSovaButterflyk1.c"
+#include "viterbiDecoderSoftButterflyk1.c"
\ No newline at end of file
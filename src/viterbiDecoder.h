@@ -3,6 +3,7 @@
 
 #include "convCodeParams.h"
 #include "convHelpers.h"
+#include "crc.h"
 #include <stdbool.h>
 
 //Note, this is being written in pure C to match
@@ -27,7 +28,10 @@
 
 #define NUM_STATES (POW2(k*S))
 
-#define FORCE_NO_POPCNT_DECODER
+//The popcnt Hamming distance can be enabled with -DALLOW_POPCNT_DECODER
+#ifndef ALLOW_POPCNT_DECODER
+    #define FORCE_NO_POPCNT_DECODER
+#endif
 // #define SIMPLE_MIN
 
 //If true, k=1 specialized decoder will simplify the butterfly computation
@@ -36,7 +40,16 @@
 //enable this
 //See "Viterbi Decoding Techniques for the TMS320C55x DSP Generation" by Henry Hendrix
 //for annother explanation.
-#define USE_POLY_SYMMETRY
+//Can be disabled with -DDISABLE_POLY_SYMMETRY
+#ifndef DISABLE_POLY_SYMMETRY
+    #define USE_POLY_SYMMETRY
+#endif
+
+//The number of trellis iterations between renormalizations of the node metrics in the k=1 specialized decoders.
+//Must be small enough that the metrics cannot overflow METRIC_TYPE between renormalizations
+#ifndef VITERBI_RENORM_INTERVAL
+    #define VITERBI_RENORM_INTERVAL (120)
+#endif
 
 //TODO: Look into re-normalizing metrics.  Can we set an upper bound on the difference between nodes in the trellis?
 
@@ -44,7 +57,7 @@
 
 #define MAX_PKT_LEN_SEGMENTS (MAX_PKT_LEN_UNCODED_BITS + S)
 
-#if k==1
+#if k==1 && !defined(FORCE_GENERIC_DECODER)
     //Using renormalization
     //in the k=1 implementation
     #define METRIC_TYPE uint8_t
@@ -72,24 +85,32 @@
     #define EDGE_METRIC_INDEX_TYPE uint64_t 
 #endif
 
-#define TRACEBACK_TYPE uint8_t
 #define TRACEBACK_BITS 8
-// #if TRACEBACK_LEN*k <= 8
-//     #define TRACEBACK_TYPE uint8_t
-// #elif TRACEBACK_LEN*k <= 16
-//     #define TRACEBACK_TYPE uint16_t
-// #elif TRACEBACK_LEN*k <= 32
-//     #define TRACEBACK_TYPE uint32_t
-// #else
-//     #define TRACEBACK_TYPE uint64_t
-// #endif
-
-#if k==1
+#if k==1 && !defined(FORCE_GENERIC_DECODER)
+    //The k=1 decoder stores one decision per state per iteration
+    #define TRACEBACK_TYPE uint8_t
+#else
+    //The generic decoder keeps the last TRACEBACK_LEN decisions of each path in a single word
+    #if TRACEBACK_LEN*k <= 8
+        #define TRACEBACK_TYPE uint8_t
+    #elif TRACEBACK_LEN*k <= 16
+        #define TRACEBACK_TYPE uint16_t
+    #elif TRACEBACK_LEN*k <= 32
+        #define TRACEBACK_TYPE uint32_t
+    #else
+        #define TRACEBACK_TYPE uint64_t
+    #endif
+#endif
+
+//The generic decoder can be selected for k=1 codes with -DFORCE_GENERIC_DECODER (ex. for benchmarking)
+#if k==1 && !defined(FORCE_GENERIC_DECODER)
     #define VITERBI_DECODER_HARD viterbiDecoderHardButterflyk1
+    #define VITERBI_DECODER_HARD_EX viterbiDecoderHardButterflyk1Ex
     #define VITERBI_INIT viterbiInitButterflyk1
     #define VITERBI_RESET resetViterbiDecoderHardButterflyk1
 #else
     #define VITERBI_DECODER_HARD viterbiDecoderHard
+    #define VITERBI_DECODER_HARD_EX viterbiDecoderHardEx
     #define VITERBI_INIT viterbiInit
     #define VITERBI_RESET resetViterbiDecoderHard
 #endif
@@ -135,6 +156,8 @@ typedef struct{
     unsigned int renormCounter;
     uint8_t decodeCarryOver;
     uint8_t decodeCarryOverCount;
+    uint32_t crcRegister; //CRC of the bytes returned so far in the packet (viterbiDecoderHardEx)
+    uint32_t renormOffset; //Sum of the minimums subtracted from the node metrics by renormalization in the current packet
 
     //Traceback as a series of  buffers
     //One buffer for each node but arranged such that
@@ -159,6 +182,63 @@ typedef struct{
  */ 
 int viterbiDecoderHard(viterbiHardState_t* restrict state, uint8_t* restrict codedSegments, uint8_t* restrict uncoded, int segmentsIn, bool last);
 
+/**
+ * Result of a decode call with a fused CRC check
+ */
+typedef struct{
+    int bytesOut; //The number of uncoded bytes returned
+    bool crcOk; //True if the packet is complete and the frame passed the CRC check (always passes with CRC_NONE)
+
+    //Decode quality, set when the packet is complete.  Can be used to estimate the channel quality without re-encoding the packet
+    uint32_t pathMetric; //Metric of the decoded (terminated) path, including the minimums removed by renormalization.  For hard decisions, the number of coded bits corrected
+    uint32_t margin; //Metric difference between the best and second best paths into the terminating state at the last step.  A small margin indicates an unreliable packet
+} viterbiDecodeResult_t;
+
+/**
+ * @brief Same as viterbiDecoderHard but also checks the CRC of the decoded frame
+ *
+ * The frame is the decoded packet, with the CRC in its last crcBytes(crc) bytes (see crc.h).  Each call runs
+ * the CRC over the bytes it returns while they are still in the cache, so no separate pass over the packet is needed.
+ *
+ * The decode quality is measured on the last trellis step, which must be provided in the call with last set.
+ *
+ * @returns The number of uncoded bytes returned and, when last is set, the result of the CRC check and the decode quality
+ */
+viterbiDecodeResult_t viterbiDecoderHardEx(viterbiHardState_t* restrict state, uint8_t* restrict codedSegments, uint8_t* restrict uncoded, int segmentsIn, bool last, crcType_t crc);
+
+/**
+ * Describes one terminated frame within a batch of back-to-back frames
+ */
+typedef struct{
+    int codedOffset; //Index of the first coded segment of the frame in the coded buffer
+    int numSegments; //Number of coded segments in the frame, including the S padding segments
+    int uncodedOffset; //Byte offset of the decoded frame in the uncoded buffer
+} viterbiBatchFrame_t;
+
+/**
+ * @brief Decodes a batch of terminated frames from one contiguous coded buffer
+ *
+ * The frames are decoded back to back with the same decoder state, which stays in the cache between frames.
+ * Since each frame is terminated, the decoder is only re-initialized by the metric reset at the end of each
+ * frame and no separate VITERBI_RESET is required between frames.
+ *
+ * @note The decoder must not be part way through a packet
+ *
+ * @param codedSegments the coded buffer containing all of the frames
+ * @param uncoded the uncoded buffer.  Frame i is written to uncoded+frames[i].uncodedOffset
+ * @param frames the frame descriptors.  Each frame must contain more than S (the frame is not empty) and at most MAX_PKT_LEN_SEGMENTS segments
+ * @param numFrames the number of frames
+ * @returns The total number of uncoded bytes returned
+ */
+int viterbiDecoderHardBatch(viterbiHardState_t* restrict state, uint8_t* restrict codedSegments, uint8_t* restrict uncoded, const viterbiBatchFrame_t* frames, int numFrames);
+
+/**
+ * @brief Same as viterbiDecoderHardBatch but also checks the CRC of each decoded frame (see viterbiDecoderHardEx)
+ *
+ * @param crcOk set to the result of the CRC check for each frame.  If NULL, the CRC is not checked
+ */
+int viterbiDecoderHardBatchEx(viterbiHardState_t* restrict state, uint8_t* restrict codedSegments, uint8_t* restrict uncoded, const viterbiBatchFrame_t* frames, int numFrames, crcType_t crc, bool* crcOk);
+
 /**
  * @brief Swaps the node metric and traceback arrays.  Used to update both the node metrics and traceback arrays after a trellis iteration.
  * 
@@ -184,8 +264,12 @@ int argmin8(const METRIC_TYPE (*metrics)[8]);
 int argmin16(const METRIC_TYPE (*metrics)[16]);
 int argmin32(const METRIC_TYPE (*metrics)[32]);
 int argmin64(const METRIC_TYPE (*metrics)[64]);
+int argmin128(const METRIC_TYPE (*metrics)[128]);
+int argmin256(const METRIC_TYPE (*metrics)[256]);
 
 //Include the specialization headers
 #include "viterbiDecoderButterflyk1.h"
+#include "viterbiDecoderSovaButterflyk1.h"
+#include "viterbiDecoderSoftButterflyk1.h"
 
 #endif
\ No newline at end of file
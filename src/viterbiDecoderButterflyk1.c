@@ -4,6 +4,7 @@
 #include "exeParams.h"
 #include <stdbool.h>
 #include <stdlib.h>
+#include <string.h>
 
 void viterbiInitButterflyk1(viterbiHardState_t* state){
     //Populate the edgeCompareIdx entries.
@@ -15,6 +16,8 @@ void viterbiInitButterflyk1(viterbiHardState_t* state){
     // printf("Decoder Trellis Init\n");
     printf("Specialized Viterbi Decoder for k=1\n");
 
+    crcInit();
+
     //TODO: can actually support symmetry if only the input bit or last bit are relied on by all generators.
     //      It requires 2 comparisons per 
     #ifdef USE_POLY_SYMMETRY
@@ -35,8 +38,9 @@ void viterbiInitButterflyk1(viterbiHardState_t* state){
                 tmpEncoder.tappedDelay = stateInd;
                 //These edge metrics need to be re-ordered according to the shuffle network to be in the same order as the butterflies
                 //Edit. actually, don't do thios because having the butterflies interleaved works better for vectorization
-                int newInd = ROTATE_RIGHT(stateInd, k, k*S);
-                // int newInd = stateInd;
+                //The butterflies index the source states directly (b and b+NUM_STATES/2)
+                // int newInd = ROTATE_RIGHT(stateInd, k, k*S);
+                int newInd = stateInd;
                 state->edgeCodedBits[edgeInd][newInd] = convEncOneInput(&tmpEncoder, edgeInd);
             }
         }
@@ -59,7 +63,7 @@ void resetViterbiDecoderHardButterflyk1(viterbiHardState_t* state){
     state->nodeMetricsA[newStartingIdx] = 0;
 
     //Need to set the node metrics so that the initial path is the only non
-    METRIC_TYPE forceNot = NUM_STATES+1;
+    METRIC_TYPE forceNot = (S+1)*MAX_EDGE_WEIGHT;
     for(int i = 1; i<NUM_STATES; i++){
         // int newIdx = ROTATE_RIGHT(i, k, k*S);
         int newIdx = i;
@@ -75,6 +79,7 @@ void resetViterbiDecoderHardButterflyk1(viterbiHardState_t* state){
 
     state->iteration = 0;
     state->renormCounter = 0;
+    state->renormOffset = 0;
     state->decodeCarryOver = 0;
     state->decodeCarryOverCount = 0;
 }
@@ -114,13 +119,14 @@ int viterbiDecoderHardButterflyk1(viterbiHardState_t* restrict state, uint8_t* r
                 b[0] = state->nodeMetricsA[butterfly] + edgeMetricComplement;
                 b[1] = state->nodeMetricsA[NUM_STATES/2 + butterfly] + edgeMetric;
             #else
+                //The butterfly has the same layout as the symmetric case but each edge has its own coded bits
                 METRIC_TYPE a[2];
-                a[0] = state->nodeMetricsA[butterfly*2] + calcHammingDist(state->edgeCodedBits[0][butterfly*2], codedBits, n);
-                a[1] = state->nodeMetricsA[butterfly*2+1] + calcHammingDist(state->edgeCodedBits[0][butterfly*2+1], codedBits, n);
+                a[0] = state->nodeMetricsA[butterfly] + calcHammingDist(state->edgeCodedBits[0][butterfly], codedBits, n);
+                a[1] = state->nodeMetricsA[NUM_STATES/2 + butterfly] + calcHammingDist(state->edgeCodedBits[0][NUM_STATES/2 + butterfly], codedBits, n);
 
                 METRIC_TYPE b[2];
-                b[0] = state->nodeMetricsA[butterfly*2] + calcHammingDist(state->edgeCodedBits[1][butterfly*2], codedBits, n);
-                b[1] = state->nodeMetricsA[butterfly*2+1] + calcHammingDist(state->edgeCodedBits[1][butterfly*2+1], codedBits, n);
+                b[0] = state->nodeMetricsA[butterfly] + calcHammingDist(state->edgeCodedBits[1][butterfly], codedBits, n);
+                b[1] = state->nodeMetricsA[NUM_STATES/2 + butterfly] + calcHammingDist(state->edgeCodedBits[1][NUM_STATES/2 + butterfly], codedBits, n);
             #endif
 
             //It is essential to perform these operations without computing the index to select once
@@ -156,7 +162,7 @@ int viterbiDecoderHardButterflyk1(viterbiHardState_t* restrict state, uint8_t* r
         //inferred a bunch of branching
         //Instead, will do a tree reduction in stages
         
-        if(state->renormCounter >= 120){
+        if(state->renormCounter >= VITERBI_RENORM_INTERVAL){
             // METRIC_TYPE minPathMetric = minMetricGeneric(&newMetrics);
             //The Compiler is not inlining the call for some reason
             //However, manually inlining it results in the compier
@@ -177,6 +183,7 @@ int viterbiDecoderHardButterflyk1(viterbiHardState_t* restrict state, uint8_t* r
                 newMetrics[idx] = newMetrics[idx] - minPathMetric;
             }
 
+            state->renormOffset += minPathMetric;
             state->renormCounter = 0;
         }else{
             (state->renormCounter)++;
@@ -198,68 +205,297 @@ int viterbiDecoderHardButterflyk1(viterbiHardState_t* restrict state, uint8_t* r
     //Perform traceback
     //TODO: Support returning the reaminder of traceback after block traceback implemented
     if(last){
-        //The number of traceback itterations is state->iteration-1
-        unsigned int numPaddingSegments = S;
+        segmentsOut = viterbiTracebackButterflyk1(state->tracebackBufs, state->iteration, uncoded);
+
+        //Reset state for next packet
+        resetViterbiDecoderHardButterflyk1(state);
+    }
+
+    return segmentsOut;
+}
+
+int viterbiTracebackButterflyk1Reference(TRACEBACK_TYPE (* restrict tracebackBufs)[NUM_STATES], unsigned int iterations, uint8_t* restrict uncoded){
+    //The number of traceback itterations is iterations-1
+    unsigned int numPaddingSegments = S;
+
+    //Select the terminated state
+    uint8_t decodedLastState = 0;
+
+    //Traceback padding segments
+    for(unsigned int i = 0; i<numPaddingSegments; i++){
+        unsigned int wordIdx = iterations-1-i;
+
+        //Given a node index, we need to find the index this index is stored in before the reshuffeling (interleaving)
+        //The node would be in a position before interleaving.  The group would be determined by the lower k LSbs
+        //The position in the group would be determined by the remaining bits.  By right rotationally shifting the index
+        //we get the stored position
+        // unsigned int storedTracebackNodeIdx = ROTATE_RIGHT(decodedLastState, 1, k*S);
+        unsigned int storedTracebackNodeIdx = decodedLastState;
+        uint8_t decision = tracebackBufs[wordIdx][storedTracebackNodeIdx];
+
+        //We do not store the decoded bits since they are padding.  If we did, it would be the k LSbs of the decoded state
+
+        //Because the new bits are shifted left onto the LSb, we can get the origin node by shifting right then appending the decision as the MSbs.
+        decodedLastState = (decodedLastState >> k) | (decision << ((S-1)*k));
+    }
+
+    //How many bytes are expected
+    unsigned int lastDecodedWordIdx = (iterations-numPaddingSegments-1)*k/TRACEBACK_BITS;
+    uncoded[lastDecodedWordIdx] = 0;
+
+    //Zero out the last byte of the returned message since it may be partially filled
+    //The other 
+
+    for(unsigned int i = numPaddingSegments; i<iterations; i++){
+        //Same routine as before except that we do now record the traceback
+        unsigned int wordIdx = iterations-1-i;
+
+        // unsigned int storedTracebackNodeIdx = ROTATE_RIGHT(decodedLastState, 1, k*S);
+        unsigned int storedTracebackNodeIdx = decodedLastState;
+
+        uint8_t decision = tracebackBufs[wordIdx][storedTracebackNodeIdx];
 
-        //Select the terminated state
-        uint8_t decodedLastState = 0;
+        //Get the decoded byte idx.  Because we are tracing back, we get the end of the message first
+        //The last byte of the message may be partially filled
+        unsigned int decodedByteIdx = wordIdx*k/8;
 
-        //Traceback padding segments
-        for(unsigned int i = 0; i<numPaddingSegments; i++){
-            unsigned int wordIdx = state->iteration-1-i;
+        uint8_t decodedBits = decodedLastState & (POW2(k)-1);
 
-            //Given a node index, we need to find the index this index is stored in before the reshuffeling (interleaving)
-            //The node would be in a position before interleaving.  The group would be determined by the lower k LSbs
-            //The position in the group would be determined by the remaining bits.  By right rotationally shifting the index
-            //we get the stored position
-            // unsigned int storedTracebackNodeIdx = ROTATE_RIGHT(decodedLastState, 1, k*S);
-            unsigned int storedTracebackNodeIdx = decodedLastState;
-            uint8_t decision = state->tracebackBufs[wordIdx][storedTracebackNodeIdx];
+        //The encoder transmits with the MSbs first then ends with the LSbs.  Since
+        //we are tracing back, we start with the LSbs and end with the MSbs
+        uncoded[decodedByteIdx] = (uncoded[decodedByteIdx] >> k) | (decodedBits << (8-k));
 
-            //We do not store the decoded bits since they are padding.  If we did, it would be the k LSbs of the decoded state
+        //For that byte, we need to zero out the other 
 
-            //Because the new bits are shifted left onto the LSb, we can get the origin node by shifting right then appending the decision as the MSbs.
-            decodedLastState = (decodedLastState >> k) | (decision << ((S-1)*k));
+        decodedLastState = (decodedLastState >> k) | (decision << ((S-1)*k));
+    }
+
+    return (iterations-numPaddingSegments-1)*k/8+1;
+}
+
+/**
+ * Traces back VITERBI_TRACEBACK_STEPS steps from the given state at step t and returns the state at step t-VITERBI_TRACEBACK_STEPS
+ *
+ * Going back j steps shifts j decisions into the MSbs of the state, so the state at step t-j is (state >> j) with one of
+ * 2^j values in the MSbs.  The decisions for each of these states are loaded before any of them are resolved, which
+ * removes the dependent load from each step.  The candidates for a step are packed into a mask so that the decision is
+ * selected with a shift.
+ */
+static inline unsigned int viterbiTracebackMultiStep(TRACEBACK_TYPE (* restrict tracebackBufs)[NUM_STATES], unsigned int t, unsigned int state){
+    uint32_t candidates[VITERBI_TRACEBACK_STEPS];
+    for(unsigned int j = 0; j<VITERBI_TRACEBACK_STEPS; j++){
+        candidates[j] = 0;
+        for(unsigned int msbs = 0; msbs<POW2(j); msbs++){
+            unsigned int candidateState = (state >> j) | (msbs << (S-j));
+            candidates[j] |= ((uint32_t) tracebackBufs[t-j][candidateState]) << msbs;
         }
+    }
 
-        //How many bytes are expected
-        unsigned int lastDecodedWordIdx = (state->iteration-numPaddingSegments-1)*k/TRACEBACK_BITS;
-        uncoded[lastDecodedWordIdx] = 0;
+    //Decision j selects the MSb of the state at step t-j-1
+    unsigned int msbs = 0;
+    for(unsigned int j = 0; j<VITERBI_TRACEBACK_STEPS; j++){
+        msbs |= ((candidates[j] >> msbs) & 1) << j;
+    }
 
-        //Zero out the last byte of the returned message since it may be partially filled
-        //The other 
+    return (state >> VITERBI_TRACEBACK_STEPS) | (msbs << (S-VITERBI_TRACEBACK_STEPS));
+}
 
-        for(unsigned int i = numPaddingSegments; i<state->iteration; i++){
-            //Same routine as before except that we do now record the traceback
-            unsigned int wordIdx = state->iteration-1-i;
+//The CRC type is a constant in each caller so the CRC is removed from the plain traceback
+static inline __attribute__((always_inline)) int viterbiTracebackWords(TRACEBACK_TYPE (* restrict tracebackBufs)[NUM_STATES], unsigned int iterations, uint8_t* restrict uncoded, crcType_t crc, uint32_t* crcRegister){
+    //Traceback padding segments from the terminated state.  The decoded bits are not stored
+    unsigned int state = 0;
+    for(unsigned int i = 0; i<S; i++){
+        state = (state >> 1) | (tracebackBufs[iterations-1-i][state] << (S-1));
+    }
 
-            // unsigned int storedTracebackNodeIdx = ROTATE_RIGHT(decodedLastState, 1, k*S);
-            unsigned int storedTracebackNodeIdx = decodedLastState;
+    //The decoded bit for step t is the LSb of the state at step t, so the bits for the next VITERBI_TRACEBACK_STEPS
+    //steps are already known.  The bits are shifted into the MSbs of a 64 bit word (the earliest step ends in the MSb)
+    //and the word is stored big endian once it holds 64 steps.  The last word of the packet may be partially filled,
+    //in which case its bits end in the MSbs and the rest of its last byte is 0, as with the reference traceback
+    unsigned int dataSteps = iterations-S;
+    unsigned int wordSteps = dataSteps%64 == 0 ? 64 : dataSteps%64;
+    unsigned int t = dataSteps;
+    uint64_t decodedWord = 0;
+    while(t > 0){
+        unsigned int wordStart = t-wordSteps;
+
+        //Single steps until the rest of the word is a whole number of multi-steps.  Only the partial word can need them
+        for(; (t-wordStart)%VITERBI_TRACEBACK_STEPS != 0; t--){
+            decodedWord = (decodedWord >> 1) | (((uint64_t) (state & 1)) << 63);
+            state = (state >> 1) | (tracebackBufs[t-1][state] << (S-1));
+        }
 
-            uint8_t decision = state->tracebackBufs[wordIdx][storedTracebackNodeIdx];
+        for(; t > wordStart; t -= VITERBI_TRACEBACK_STEPS){
+            //The decisions are read backwards through memory, one NUM_STATES row per step
+            __builtin_prefetch(tracebackBufs[t > VITERBI_TRACEBACK_PREFETCH_DIST ? t-VITERBI_TRACEBACK_PREFETCH_DIST : 0]);
 
-            //Get the decoded byte idx.  Because we are tracing back, we get the end of the message first
-            //The last byte of the message may be partially filled
-            unsigned int decodedByteIdx = wordIdx*k/8;
+            decodedWord = (decodedWord >> VITERBI_TRACEBACK_STEPS) | (((uint64_t) (state & (POW2(VITERBI_TRACEBACK_STEPS)-1))) << (64-VITERBI_TRACEBACK_STEPS));
+            state = viterbiTracebackMultiStep(tracebackBufs, t-1, state);
+        }
 
-            uint8_t decodedBits = decodedLastState & (POW2(k)-1);
+        uint64_t decodedBigEndian = __builtin_bswap64(decodedWord);
+        unsigned int wordBytes = (wordSteps+7)/8;
+        if(wordSteps == 64){
+            memcpy(uncoded+wordStart/8, &decodedBigEndian, sizeof(decodedBigEndian));
+        }else{
+            memcpy(uncoded+wordStart/8, &decodedBigEndian, wordBytes);
+        }
 
-            //The encoder transmits with the MSbs first then ends with the LSbs.  Since
-            //we are tracing back, we start with the LSbs and end with the MSbs
-            uncoded[decodedByteIdx] = (uncoded[decodedByteIdx] >> k) | (decodedBits << (8-k));
+        if(crc != CRC_NONE){
+            //The bytes of the word are un-processed from the CRC register starting from the last
+            for(unsigned int byte = wordBytes; byte > 0; byte--){
+                *crcRegister = crcUnwindByte(crc, *crcRegister, (decodedWord >> (64-8*byte)) & 0xFF);
+            }
+        }
 
-            //For that byte, we need to zero out the other 
+        wordSteps = 64;
+    }
 
-            decodedLastState = (decodedLastState >> k) | (decision << ((S-1)*k));
+    return (iterations-S-1)*k/8+1;
+}
+
+int viterbiTracebackButterflyk1(TRACEBACK_TYPE (* restrict tracebackBufs)[NUM_STATES], unsigned int iterations, uint8_t* restrict uncoded){
+    #ifdef VITERBI_REFERENCE_TRACEBACK
+        return viterbiTracebackButterflyk1Reference(tracebackBufs, iterations, uncoded);
+    #else
+        return viterbiTracebackWords(tracebackBufs, iterations, uncoded, CRC_NONE, NULL);
+    #endif
+}
+
+viterbiDecodeResult_t viterbiTracebackButterflyk1Crc(TRACEBACK_TYPE (* restrict tracebackBufs)[NUM_STATES], unsigned int iterations, uint8_t* restrict uncoded, crcType_t crc){
+    viterbiDecodeResult_t result = {0, false, 0, 0};
+
+    #ifdef VITERBI_REFERENCE_TRACEBACK
+        result.bytesOut = viterbiTracebackButterflyk1Reference(tracebackBufs, iterations, uncoded);
+        result.crcOk = crcCheck(crc, uncoded, result.bytesOut);
+    #else
+        if(crc == CRC_NONE){
+            result.bytesOut = viterbiTracebackWords(tracebackBufs, iterations, uncoded, CRC_NONE, NULL);
+            result.crcOk = true;
+        }else if(crc == CRC_16){
+            uint32_t crcRegister = crcResidue(CRC_16);
+            result.bytesOut = viterbiTracebackWords(tracebackBufs, iterations, uncoded, CRC_16, &crcRegister);
+            result.crcOk = result.bytesOut >= crcBytes(CRC_16) && crcRegister == crcInitial(CRC_16);
+        }else{
+            uint32_t crcRegister = crcResidue(CRC_32);
+            result.bytesOut = viterbiTracebackWords(tracebackBufs, iterations, uncoded, CRC_32, &crcRegister);
+            result.crcOk = result.bytesOut >= crcBytes(CRC_32) && crcRegister == crcInitial(CRC_32);
+        }
+    #endif
+
+    return result;
+}
+
+/**
+ * The metric difference between the 2 paths into the terminating state (0) for the next trellis step.  State 0 is reached
+ * from states 0 and NUM_STATES/2 (the first butterfly)
+ */
+static uint32_t viterbiTerminatingMarginButterflyk1(const viterbiHardState_t* state, uint8_t codedBits){
+    #ifdef USE_POLY_SYMMETRY
+        uint8_t edgeMetric = calcHammingDist(state->edgeCodedBitsSymm[0], codedBits, n);
+        uint32_t fromLower = state->nodeMetricsA[0] + edgeMetric;
+        uint32_t fromUpper = state->nodeMetricsA[NUM_STATES/2] + n - edgeMetric;
+    #else
+        uint32_t fromLower = state->nodeMetricsA[0] + calcHammingDist(state->edgeCodedBits[0][0], codedBits, n);
+        uint32_t fromUpper = state->nodeMetricsA[NUM_STATES/2] + calcHammingDist(state->edgeCodedBits[0][NUM_STATES/2], codedBits, n);
+    #endif
+
+    return fromLower > fromUpper ? fromLower-fromUpper : fromUpper-fromLower;
+}
+
+viterbiDecodeResult_t viterbiDecoderHardButterflyk1Ex(viterbiHardState_t* restrict state, uint8_t* restrict codedSegments, uint8_t* restrict uncoded, int segmentsIn, bool last, crcType_t crc){
+    viterbiDecodeResult_t result = {0, false, 0, 0};
+
+    //ACS only, the traceback is performed here so the CRC can be checked with it.
+    //The last step is run on its own to measure the margin into the terminating state
+    int leadingSegments = last && segmentsIn > 0 ? segmentsIn-1 : segmentsIn;
+    viterbiDecoderHardButterflyk1(state, codedSegments, NULL, leadingSegments, false);
+
+    if(last){
+        uint32_t margin = 0;
+        if(segmentsIn > 0){
+            margin = viterbiTerminatingMarginButterflyk1(state, codedSegments[segmentsIn-1]);
+            viterbiDecoderHardButterflyk1(state, codedSegments+leadingSegments, NULL, 1, false);
         }
+        uint32_t pathMetric = state->renormOffset + state->nodeMetricsA[0];
 
-        segmentsOut = (state->iteration-numPaddingSegments-1)*k/8+1;
+        result = viterbiTracebackButterflyk1Crc(state->tracebackBufs, state->iteration, uncoded, crc);
+        result.pathMetric = pathMetric;
+        result.margin = margin;
 
         //Reset state for next packet
         resetViterbiDecoderHardButterflyk1(state);
     }
 
-    return segmentsOut;
+    return result;
+}
+
+/**
+ * Traces back from the given state after step end-1 to step start, writing the decoded bits of steps before outEnd.
+ * Returns the state before step start
+ */
+static unsigned int viterbiTracebackWindow(TRACEBACK_TYPE (* restrict tracebackBufs)[NUM_STATES], unsigned int start, unsigned int end, unsigned int outEnd, unsigned int decodedState, uint8_t* restrict uncoded){
+    for(unsigned int t = end; t > start; t--){
+        unsigned int step = t-1;
+        if(step < outEnd){
+            //The bits are transmitted MSb first
+            uncoded[step/8] |= (decodedState & 1) << (7 - step%8);
+        }
+        decodedState = (decodedState >> 1) | (tracebackBufs[step][decodedState] << (S-1));
+    }
+
+    return decodedState;
+}
+
+int viterbiDecoderHardButterflyk1Window(viterbiHardState_t* restrict state, uint8_t* restrict codedSegments, uint8_t* restrict uncoded, int segmentsIn, unsigned int depth, unsigned int blockLen){
+    if(state->iteration != 0){
+        printf("Window decode started part way through a packet\n");
+        exit(1);
+    }
+    if(segmentsIn <= S || segmentsIn > MAX_PKT_LEN_SEGMENTS){
+        printf("Window decoder packet has %d segments, must be more than %d and at most %d\n", segmentsIn, S, MAX_PKT_LEN_SEGMENTS);
+        exit(1);
+    }
+    if(blockLen == 0){
+        printf("Window decoder block length must be at least 1\n");
+        exit(1);
+    }
+
+    unsigned int uncodedBits = segmentsIn-S;
+    int bytesOut = (uncodedBits+7)/8;
+    memset(uncoded, 0, bytesOut);
+
+    unsigned int decodedSteps = 0;
+    int segmentsDone = 0;
+    while(segmentsDone < segmentsIn){
+        //Run the trellis until it is exactly depth steps past the next block, or to the end of the packet if no
+        //full block is left.  Running further before the traceback would lengthen the decision depth
+        bool blockLeft = decodedSteps+blockLen <= uncodedBits;
+        unsigned int tracebackStep = decodedSteps+blockLen+depth;
+        int segments = segmentsIn-segmentsDone;
+        if(blockLeft && tracebackStep-state->iteration < (unsigned int) segments){
+            segments = tracebackStep-state->iteration;
+        }
+        viterbiDecoderHardButterflyk1(state, codedSegments+segmentsDone, NULL, segments, false);
+        segmentsDone += segments;
+
+        //The path is traced back from the state with the best metric since the end of the packet (and its terminating
+        //state) has not been received yet
+        if(blockLeft && state->iteration == tracebackStep){
+            unsigned int bestState = argminNodeMetrics((const METRIC_TYPE (*)[NUM_STATES]) &state->nodeMetricsA);
+            viterbiTracebackWindow(state->tracebackBufs, decodedSteps, state->iteration, decodedSteps+blockLen, bestState, uncoded);
+            decodedSteps += blockLen;
+        }
+    }
+
+    //The rest of the packet is traced back from the terminating state
+    if(decodedSteps < uncodedBits){
+        viterbiTracebackWindow(state->tracebackBufs, decodedSteps, state->iteration, uncodedBits, 0, uncoded);
+    }
+
+    resetViterbiDecoderHardButterflyk1(state);
+
+    return bytesOut;
 }
 
 //Note: Clang was able to infer the minimum operation in the general C implementation
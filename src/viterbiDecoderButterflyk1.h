@@ -3,12 +3,84 @@
 
 #include "viterbiDecoder.h"
 
+//***** Decoder Options *******
+//The number of trellis steps traced back per iteration of the traceback loop.  Must be 1, 2, or 4 and at most S.
+//Resolving j steps at once loads 2^j-1 candidate decisions.  On the machines measured so far, this cost more than the
+//shorter dependency chain saved for j>1, so the default is 1.
+//The original traceback, which writes the output one bit at a time, can be selected with -DVITERBI_REFERENCE_TRACEBACK
+#ifndef VITERBI_TRACEBACK_STEPS
+    #define VITERBI_TRACEBACK_STEPS (1)
+#endif
+#ifndef VITERBI_TRACEBACK_PREFETCH_DIST
+    #define VITERBI_TRACEBACK_PREFETCH_DIST (16) //Trellis steps ahead of the traceback to prefetch
+#endif
+//***** End Options ******
+
+//The 2^(VITERBI_TRACEBACK_STEPS-1) candidate decisions of the last step are packed into a 32 bit mask, which rules out 8
+#if 8%VITERBI_TRACEBACK_STEPS != 0 || VITERBI_TRACEBACK_STEPS > 4 || VITERBI_TRACEBACK_STEPS > S
+    #error VITERBI_TRACEBACK_STEPS must be 1, 2, or 4 and at most S
+#endif
+
 int viterbiDecoderHardButterflyk1(viterbiHardState_t* restrict state, uint8_t* restrict codedSegments, uint8_t* restrict uncoded, int segmentsIn, bool last);
 
+/**
+ * @brief Same as viterbiDecoderHardButterflyk1 but also checks the CRC of the decoded frame
+ *
+ * The frame is the decoded packet, with the CRC in its last crcBytes(crc) bytes (see crc.h).  The CRC is checked
+ * by the traceback as the bytes are decoded (see viterbiTracebackButterflyk1Crc), so no separate pass over the
+ * packet is needed.
+ *
+ * The node metric renormalizations are accumulated so the metric of the decoded path can be returned.  The last trellis
+ * step is run on its own to record the 2 paths into the terminating state, so it must be provided in the call with last set.
+ *
+ * @returns The number of uncoded bytes returned and, when last is set, the result of the CRC check and the decode quality
+ */
+viterbiDecodeResult_t viterbiDecoderHardButterflyk1Ex(viterbiHardState_t* restrict state, uint8_t* restrict codedSegments, uint8_t* restrict uncoded, int segmentsIn, bool last, crcType_t crc);
+
+/**
+ * @brief Decodes a terminated packet as a streaming decoder with a fixed decision depth would
+ *
+ * The oldest blockLen undecoded trellis steps are decoded once the trellis has been run exactly depth steps past them:
+ * the path ending at the state with the best metric is traced back depth+blockLen steps and the bits of the oldest
+ * blockLen steps are kept.  The steps left at the end of the packet are traced back from the terminating state.  The
+ * decoding delay is depth+blockLen steps.
+ *
+ * The whole packet, more than S and at most MAX_PKT_LEN_SEGMENTS segments, must be provided in one call.  The decisions of the packet are kept in the traceback buffer, but only
+ * the last depth+blockLen steps are read by the block tracebacks, as with the circular decision memory of a streaming decoder.
+ *
+ * @param depth the decision depth (traceback length before the decoded block) in trellis steps
+ * @param blockLen the number of steps decoded by each traceback.  Must be at least 1
+ * @returns The number of uncoded bytes returned
+ */
+int viterbiDecoderHardButterflyk1Window(viterbiHardState_t* restrict state, uint8_t* restrict codedSegments, uint8_t* restrict uncoded, int segmentsIn, unsigned int depth, unsigned int blockLen);
+
 void viterbiInitButterflyk1(viterbiHardState_t* state);
 
 void resetViterbiDecoderHardButterflyk1(viterbiHardState_t* state);
 
+/**
+ * @brief Traces back a terminated packet from the per step decisions of the k=1 butterfly decoders
+ *
+ * @param tracebackBufs the decisions for each trellis step.  tracebackBufs[t][s] is the decision for state s after step t
+ * @param iterations the number of trellis steps (including the S padding steps)
+ * @param uncoded the decoded bytes
+ * @returns The number of uncoded bytes returned
+ */
+int viterbiTracebackButterflyk1(TRACEBACK_TYPE (* restrict tracebackBufs)[NUM_STATES], unsigned int iterations, uint8_t* restrict uncoded);
+
+/**
+ * @brief Traces back a packet and checks its CRC as the bytes are decoded
+ *
+ * The traceback produces the packet from the last byte to the first, so the CRC register is run backwards from the
+ * residue (see crcUnwindByte).  The frame passed the check if the register ends at its initial value.
+ */
+viterbiDecodeResult_t viterbiTracebackButterflyk1Crc(TRACEBACK_TYPE (* restrict tracebackBufs)[NUM_STATES], unsigned int iterations, uint8_t* restrict uncoded, crcType_t crc);
+
+/**
+ * @brief Traces back one step per iteration, writing each decoded bit into the output byte.  Produces the same output as viterbiTracebackButterflyk1
+ */
+int viterbiTracebackButterflyk1Reference(TRACEBACK_TYPE (* restrict tracebackBufs)[NUM_STATES], unsigned int iterations, uint8_t* restrict uncoded);
+
 // METRIC_TYPE minMetric(const METRIC_TYPE (*metrics)[NUM_STATES]);
 // METRIC_TYPE minMetric2(const METRIC_TYPE (*metrics)[2]);
 // METRIC_TYPE minMetric4(const METRIC_TYPE (*metrics)[4]);
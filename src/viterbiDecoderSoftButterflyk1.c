@@ -0,0 +1,235 @@
+#include "viterbiDecoderSoftButterflyk1.h"
+#include "convEncode.h"
+#include <stdio.h>
+#include <stdbool.h>
+#include <stdlib.h>
+
+void viterbiInitSoftButterflyk1(viterbiSoftState_t* state){
+    convEncoderState_t tmpEncoder;
+    resetConvEncoder(&tmpEncoder);
+    initConvEncoder(&tmpEncoder);
+
+    printf("Soft Decision Viterbi Decoder for k=1, Saturation: %d\n", VITERBI_SOFT_MAX);
+
+    crcInit();
+
+    //Same tables as viterbiInitButterflyk1
+    #ifdef USE_POLY_SYMMETRY
+        for(int i = 0; i < NUM_STATES/2; i++){
+            resetConvEncoder(&tmpEncoder);
+            tmpEncoder.tappedDelay = i;
+            state->edgeCodedBitsSymm[i] = convEncOneInput(&tmpEncoder, 0);
+        }
+    #else
+        for(int edgeInd = 0; edgeInd < POW2(k); edgeInd++){
+            for(int stateInd = 0; stateInd < NUM_STATES; stateInd++){
+                resetConvEncoder(&tmpEncoder);
+                tmpEncoder.tappedDelay = stateInd;
+                state->edgeCodedBits[edgeInd][stateInd] = convEncOneInput(&tmpEncoder, edgeInd);
+            }
+        }
+    #endif
+}
+
+void resetViterbiDecoderSoftButterflyk1(viterbiSoftState_t* state){
+    //Need to set the node metrics so that the initial path is the only non eliminated path
+    VITERBI_SOFT_METRIC_TYPE forceNot = (S+1)*VITERBI_SOFT_MAX_EDGE_WEIGHT;
+    for(int i = 0; i<NUM_STATES; i++){
+        state->nodeMetrics[i] = forceNot;
+    }
+    state->nodeMetrics[STARTING_STATE] = 0;
+
+    state->iteration = 0;
+    state->renormCounter = 0;
+    state->renormOffset = 0;
+}
+
+/**
+ * Scales, rounds, and saturates a sample
+ */
+static inline int32_t viterbiSoftQuantize(float sample, float scale){
+    float scaled = sample*scale;
+    scaled = scaled > VITERBI_SOFT_MAX ? VITERBI_SOFT_MAX : scaled;
+    scaled = scaled < -VITERBI_SOFT_MAX ? -VITERBI_SOFT_MAX : scaled;
+    return (int32_t) (scaled < 0 ? scaled - 0.5f : scaled + 0.5f);
+}
+
+/**
+ * The cost of an edge given the cost of each coded bit being 0 or 1.  The first coded bit is the MSb of the edge's coded bits
+ */
+static inline VITERBI_SOFT_METRIC_TYPE viterbiSoftEdgeMetric(EDGE_METRIC_INDEX_TYPE edgeCodedBits, const VITERBI_SOFT_METRIC_TYPE* costZero, const VITERBI_SOFT_METRIC_TYPE* costOne){
+    VITERBI_SOFT_METRIC_TYPE metric = 0;
+    for(int j = 0; j<n; j++){
+        metric += ((edgeCodedBits >> (n-1-j)) & 1) ? costOne[j] : costZero[j];
+    }
+    return metric;
+}
+
+/**
+ * Performs one trellis iteration given the quantized samples for the step
+ */
+static inline void viterbiSoftTrellisStep(viterbiSoftState_t* restrict state, const int32_t* quantized){
+    VITERBI_SOFT_METRIC_TYPE costZero[n];
+    VITERBI_SOFT_METRIC_TYPE costOne[n];
+    for(int j = 0; j<n; j++){
+        costZero[j] = VITERBI_SOFT_MAX - quantized[j];
+        costOne[j] = VITERBI_SOFT_MAX + quantized[j];
+    }
+
+    VITERBI_SOFT_METRIC_TYPE newMetrics[NUM_STATES] __attribute__ ((aligned (32)));
+    TRACEBACK_TYPE (* restrict tracebackBuf)[NUM_STATES] = &(state->tracebackBufs[state->iteration]);
+
+    //Same butterfly layout as viterbiDecoderHardButterflyk1
+    for(unsigned int butterfly = 0; butterfly<(NUM_STATES/2); butterfly++){
+        #ifdef USE_POLY_SYMMETRY
+            VITERBI_SOFT_METRIC_TYPE edgeMetric = viterbiSoftEdgeMetric(state->edgeCodedBitsSymm[butterfly], costZero, costOne);
+            VITERBI_SOFT_METRIC_TYPE edgeMetricComplement = VITERBI_SOFT_MAX_EDGE_WEIGHT-edgeMetric;
+
+            VITERBI_SOFT_METRIC_TYPE a[2];
+            a[0] = state->nodeMetrics[butterfly] + edgeMetric;
+            a[1] = state->nodeMetrics[NUM_STATES/2 + butterfly] + edgeMetricComplement;
+
+            VITERBI_SOFT_METRIC_TYPE b[2];
+            b[0] = state->nodeMetrics[butterfly] + edgeMetricComplement;
+            b[1] = state->nodeMetrics[NUM_STATES/2 + butterfly] + edgeMetric;
+        #else
+            VITERBI_SOFT_METRIC_TYPE a[2];
+            a[0] = state->nodeMetrics[butterfly] + viterbiSoftEdgeMetric(state->edgeCodedBits[0][butterfly], costZero, costOne);
+            a[1] = state->nodeMetrics[NUM_STATES/2 + butterfly] + viterbiSoftEdgeMetric(state->edgeCodedBits[0][NUM_STATES/2 + butterfly], costZero, costOne);
+
+            VITERBI_SOFT_METRIC_TYPE b[2];
+            b[0] = state->nodeMetrics[butterfly] + viterbiSoftEdgeMetric(state->edgeCodedBits[1][butterfly], costZero, costOne);
+            b[1] = state->nodeMetrics[NUM_STATES/2 + butterfly] + viterbiSoftEdgeMetric(state->edgeCodedBits[1][NUM_STATES/2 + butterfly], costZero, costOne);
+        #endif
+
+        //Select without an intermediate index so the loop vectorizes (see viterbiDecoderHardButterflyk1)
+        bool aDecision = a[0] > a[1];
+        bool bDecision = b[0] > b[1];
+
+        VITERBI_SOFT_METRIC_TYPE aMetric = a[0];
+        VITERBI_SOFT_METRIC_TYPE bMetric = b[0];
+
+        if(aDecision){
+            aMetric = a[1];
+        }
+        if(bDecision){
+            bMetric = b[1];
+        }
+
+        newMetrics[butterfly*2] = aMetric;
+        newMetrics[butterfly*2+1] = bMetric;
+
+        (*tracebackBuf)[butterfly*2] = aDecision;
+        (*tracebackBuf)[butterfly*2+1] = bDecision;
+    }
+
+    if(state->renormCounter >= VITERBI_SOFT_RENORM_INTERVAL){
+        VITERBI_SOFT_METRIC_TYPE minPathMetric = newMetrics[0];
+        for(unsigned int idx = 1; idx<NUM_STATES; idx++){
+            if(newMetrics[idx] < minPathMetric){
+                minPathMetric = newMetrics[idx];
+            }
+        }
+
+        for(unsigned int idx = 0; idx<NUM_STATES; idx++){
+            newMetrics[idx] = newMetrics[idx] - minPathMetric;
+        }
+
+        state->renormOffset += minPathMetric;
+        state->renormCounter = 0;
+    }else{
+        (state->renormCounter)++;
+    }
+
+    for(unsigned int idx = 0; idx<NUM_STATES; idx++){
+        state->nodeMetrics[idx] = newMetrics[idx];
+    }
+
+    (state->iteration)++;
+}
+
+/**
+ * The metric difference between the 2 paths into the terminating state (0) for the next trellis step (see viterbiTerminatingMarginButterflyk1)
+ */
+static uint32_t viterbiSoftTerminatingMargin(const viterbiSoftState_t* state, const int32_t* quantized){
+    VITERBI_SOFT_METRIC_TYPE costZero[n];
+    VITERBI_SOFT_METRIC_TYPE costOne[n];
+    for(int j = 0; j<n; j++){
+        costZero[j] = VITERBI_SOFT_MAX - quantized[j];
+        costOne[j] = VITERBI_SOFT_MAX + quantized[j];
+    }
+
+    #ifdef USE_POLY_SYMMETRY
+        uint32_t edgeMetric = viterbiSoftEdgeMetric(state->edgeCodedBitsSymm[0], costZero, costOne);
+        uint32_t fromLower = state->nodeMetrics[0] + edgeMetric;
+        uint32_t fromUpper = state->nodeMetrics[NUM_STATES/2] + VITERBI_SOFT_MAX_EDGE_WEIGHT - edgeMetric;
+    #else
+        uint32_t fromLower = state->nodeMetrics[0] + viterbiSoftEdgeMetric(state->edgeCodedBits[0][0], costZero, costOne);
+        uint32_t fromUpper = state->nodeMetrics[NUM_STATES/2] + viterbiSoftEdgeMetric(state->edgeCodedBits[0][NUM_STATES/2], costZero, costOne);
+    #endif
+
+    return fromLower > fromUpper ? fromLower-fromUpper : fromUpper-fromLower;
+}
+
+static viterbiDecodeResult_t viterbiSoftFinish(viterbiSoftState_t* restrict state, uint8_t* restrict uncoded, bool last, crcType_t crc, uint32_t margin){
+    viterbiDecodeResult_t result = {0, false, 0, 0};
+
+    if(last){
+        uint32_t pathMetric = state->renormOffset + state->nodeMetrics[0];
+
+        result = viterbiTracebackButterflyk1Crc(state->tracebackBufs, state->iteration, uncoded, crc);
+        result.pathMetric = pathMetric;
+        result.margin = margin;
+
+        //Reset state for next packet
+        resetViterbiDecoderSoftButterflyk1(state);
+    }
+
+    return result;
+}
+
+viterbiDecodeResult_t viterbiDecoderSoftButterflyk1Ex(viterbiSoftState_t* restrict state, const float* restrict samples, float scale, uint8_t* restrict uncoded, int stepsIn, bool last, crcType_t crc){
+    //The margin into the terminating state is measured before the last step
+    uint32_t margin = 0;
+    for(int i = 0; i<stepsIn; i++){
+        int32_t quantized[n];
+        for(int j = 0; j<n; j++){
+            quantized[j] = viterbiSoftQuantize(samples[i*n+j], scale);
+        }
+
+        if(last && i == stepsIn-1){
+            margin = viterbiSoftTerminatingMargin(state, quantized);
+        }
+
+        viterbiSoftTrellisStep(state, quantized);
+    }
+
+    return viterbiSoftFinish(state, uncoded, last, crc, margin);
+}
+
+viterbiDecodeResult_t viterbiDecoderSoftInt16Butterflyk1Ex(viterbiSoftState_t* restrict state, const int16_t* restrict samples, float scale, uint8_t* restrict uncoded, int stepsIn, bool last, crcType_t crc){
+    //The margin into the terminating state is measured before the last step
+    uint32_t margin = 0;
+    for(int i = 0; i<stepsIn; i++){
+        int32_t quantized[n];
+        for(int j = 0; j<n; j++){
+            quantized[j] = viterbiSoftQuantize((float) samples[i*n+j], scale);
+        }
+
+        if(last && i == stepsIn-1){
+            margin = viterbiSoftTerminatingMargin(state, quantized);
+        }
+
+        viterbiSoftTrellisStep(state, quantized);
+    }
+
+    return viterbiSoftFinish(state, uncoded, last, crc, margin);
+}
+
+int viterbiDecoderSoftButterflyk1(viterbiSoftState_t* restrict state, const float* restrict samples, float scale, uint8_t* restrict uncoded, int stepsIn, bool last){
+    return viterbiDecoderSoftButterflyk1Ex(state, samples, scale, uncoded, stepsIn, last, CRC_NONE).bytesOut;
+}
+
+int viterbiDecoderSoftInt16Butterflyk1(viterbiSoftState_t* restrict state, const int16_t* restrict samples, float scale, uint8_t* restrict uncoded, int stepsIn, bool last){
+    return viterbiDecoderSoftInt16Butterflyk1Ex(state, samples, scale, uncoded, stepsIn, last, CRC_NONE).bytesOut;
+}
@@ -0,0 +1,94 @@
+#ifndef _VITERBI_DECODER_SOFT_BUTTERFLYk1_H_
+#define _VITERBI_DECODER_SOFT_BUTTERFLYk1_H_
+
+#include "viterbiDecoder.h"
+
+//Soft decision variant of viterbiDecoderHardButterflyk1 which takes the demodulated samples directly
+//
+//The decoder takes n real samples per trellis step in transmission order: one BPSK symbol per coded bit, or the
+//interleaved I and Q of Gray mapped QPSK symbols.  A positive sample favours a 0 coded bit.  Each sample is scaled,
+//rounded, and saturated to +/-VITERBI_SOFT_MAX as part of the branch metric computation for its trellis step,
+//so no quantized buffer or hard sliced coded segments are created for the packet.
+//
+//The cost of a sample q for a coded bit of 0 is VITERBI_SOFT_MAX-q and for a coded bit of 1 is VITERBI_SOFT_MAX+q
+//(the correlation metric, offset to be non-negative).  With saturated samples of +/-VITERBI_SOFT_MAX, the path
+//metrics are 2*VITERBI_SOFT_MAX times the Hamming distance and the decoder makes the same decisions as the
+//hard decision decoder.  The decisions are stored in the same layout as the hard decision decoder and the
+//packet is traced back with viterbiTracebackButterflyk1.
+
+//***** Decoder Options *******
+#ifndef VITERBI_SOFT_MAX
+    #define VITERBI_SOFT_MAX (127) //The scaled samples are saturated to +/-VITERBI_SOFT_MAX
+#endif
+//***** End Options ******
+
+#define VITERBI_SOFT_METRIC_TYPE uint16_t
+#define VITERBI_SOFT_MAX_EDGE_WEIGHT (2*VITERBI_SOFT_MAX*n)
+
+//The node metrics are within S edge weights of the minimum (and the initial metrics are within 2*S+1 edge weights).
+//The metrics are renormalized often enough that the minimum cannot grow past the remaining range of METRIC_TYPE
+#define VITERBI_SOFT_RENORM_INTERVAL (UINT16_MAX/VITERBI_SOFT_MAX_EDGE_WEIGHT - 2*S - 2)
+#if VITERBI_SOFT_RENORM_INTERVAL < 1
+    #error VITERBI_SOFT_MAX is too large for the soft decision metric type
+#endif
+
+/**
+ * State for the soft decision decoder between calls
+ *
+ * @note This structure is large.  Allocate it statically or on the heap.
+ */
+typedef struct{
+    //Code Configuration (see viterbiHardState_t)
+    #ifdef USE_POLY_SYMMETRY
+        EDGE_METRIC_INDEX_TYPE edgeCodedBitsSymm[NUM_STATES/2];
+    #else
+        EDGE_METRIC_INDEX_TYPE edgeCodedBits[POW2(k)][NUM_STATES];
+    #endif
+
+    //Decoder State
+    VITERBI_SOFT_METRIC_TYPE nodeMetrics[NUM_STATES] __attribute__ ((aligned (64)));
+    unsigned int iteration;
+    unsigned int renormCounter;
+    uint32_t renormOffset; //Sum of the minimums subtracted from the node metrics by renormalization in the current packet
+
+    //The decisions for each trellis step (see viterbiHardState_t)
+    TRACEBACK_TYPE tracebackBufs[(TRACEBACK_BUFFER_LEN+S*k)][NUM_STATES] __attribute__ ((aligned (64)));
+} viterbiSoftState_t;
+
+void viterbiInitSoftButterflyk1(viterbiSoftState_t* state);
+
+void resetViterbiDecoderSoftButterflyk1(viterbiSoftState_t* state);
+
+/**
+ * @brief Performs soft decision viterbi decoding of float samples
+ *
+ * @note The code is expected to begin in the starting state and end in the 0 state.
+ *
+ * @param samples n samples per trellis step.  Positive values favour a 0 coded bit
+ * @param scale the samples are multiplied by scale before being rounded and saturated to +/-VITERBI_SOFT_MAX
+ * @param uncoded an array of uncoded bytes.  Written when last is set
+ * @param stepsIn The number of trellis steps being provided (stepsIn*n samples)
+ * @param last If true, returns the traceback and resets after this iteration
+ * @returns The number of uncoded bytes returned
+ */
+int viterbiDecoderSoftButterflyk1(viterbiSoftState_t* restrict state, const float* restrict samples, float scale, uint8_t* restrict uncoded, int stepsIn, bool last);
+
+/**
+ * @brief Performs soft decision viterbi decoding of int16 samples (ex. from a fixed point demodulator).  Otherwise the same as viterbiDecoderSoftButterflyk1
+ */
+int viterbiDecoderSoftInt16Butterflyk1(viterbiSoftState_t* restrict state, const int16_t* restrict samples, float scale, uint8_t* restrict uncoded, int stepsIn, bool last);
+
+/**
+ * @brief Same as viterbiDecoderSoftButterflyk1 but also checks the CRC of the decoded frame during the traceback and returns the decode quality (see viterbiDecoderHardButterflyk1Ex)
+ *
+ * The path metric and margin are in the units of the soft metric.  With saturated samples, they are 2*VITERBI_SOFT_MAX
+ * times the hard decision values.
+ */
+viterbiDecodeResult_t viterbiDecoderSoftButterflyk1Ex(viterbiSoftState_t* restrict state, const float* restrict samples, float scale, uint8_t* restrict uncoded, int stepsIn, bool last, crcType_t crc);
+
+/**
+ * @brief Same as viterbiDecoderSoftInt16Butterflyk1 but also checks the CRC of the decoded frame during the traceback and returns the decode quality (see viterbiDecoderSoftButterflyk1Ex)
+ */
+viterbiDecodeResult_t viterbiDecoderSoftInt16Butterflyk1Ex(viterbiSoftState_t* restrict state, const int16_t* restrict samples, float scale, uint8_t* restrict uncoded, int stepsIn, bool last, crcType_t crc);
+
+#endif
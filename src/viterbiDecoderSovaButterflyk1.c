@@ -0,0 +1,160 @@
+#include "viterbiDecoderSovaButterflyk1.h"
+#include <stdio.h>
+#include <stdbool.h>
+#include <stdlib.h>
+
+void viterbiInitSovaButterflyk1(viterbiSovaState_t* state){
+    viterbiInitButterflyk1(&(state->hard));
+    printf("SOVA Window: %d\n", SOVA_WINDOW_LEN);
+}
+
+void resetViterbiDecoderSovaButterflyk1(viterbiSovaState_t* state){
+    resetViterbiDecoderHardButterflyk1(&(state->hard));
+}
+
+int viterbiDecoderSovaButterflyk1(viterbiSovaState_t* restrict state, uint8_t* restrict codedSegments, uint8_t* restrict uncoded, int8_t* restrict reliability, int segmentsIn, bool last){
+    int segmentsOut = 0;
+    viterbiHardState_t* restrict hard = &(state->hard);
+
+    for(unsigned int i = 0; i<segmentsIn; i++){
+        uint8_t codedBits = codedSegments[i];
+
+        METRIC_TYPE newMetrics[NUM_STATES] __attribute__ ((aligned (32)));
+
+        TRACEBACK_TYPE (* restrict tracebackBuf)[NUM_STATES] = &(hard->tracebackBufs[hard->iteration]);
+        METRIC_TYPE (* restrict metricDiffBuf)[NUM_STATES] = &(state->metricDiffs[hard->iteration]);
+
+        //Trellis Itteration.  Same as viterbiDecoderHardButterflyk1 except that the metric differences are also stored
+        for(unsigned int butterfly = 0; butterfly<(NUM_STATES/2); butterfly++){
+            #ifdef USE_POLY_SYMMETRY
+                uint8_t edgeMetric = calcHammingDist(hard->edgeCodedBitsSymm[butterfly], codedBits, n);
+                uint8_t edgeMetricComplement = n-edgeMetric;
+
+                METRIC_TYPE a[2];
+                a[0] = hard->nodeMetricsA[butterfly] + edgeMetric;
+                a[1] = hard->nodeMetricsA[NUM_STATES/2 + butterfly] + edgeMetricComplement;
+
+                METRIC_TYPE b[2];
+                b[0] = hard->nodeMetricsA[butterfly] + edgeMetricComplement;
+                b[1] = hard->nodeMetricsA[NUM_STATES/2 + butterfly] + edgeMetric;
+            #else
+                //The butterfly has the same layout as the symmetric case but each edge has its own coded bits
+                METRIC_TYPE a[2];
+                a[0] = hard->nodeMetricsA[butterfly] + calcHammingDist(hard->edgeCodedBits[0][butterfly], codedBits, n);
+                a[1] = hard->nodeMetricsA[NUM_STATES/2 + butterfly] + calcHammingDist(hard->edgeCodedBits[0][NUM_STATES/2 + butterfly], codedBits, n);
+
+                METRIC_TYPE b[2];
+                b[0] = hard->nodeMetricsA[butterfly] + calcHammingDist(hard->edgeCodedBits[1][butterfly], codedBits, n);
+                b[1] = hard->nodeMetricsA[NUM_STATES/2 + butterfly] + calcHammingDist(hard->edgeCodedBits[1][NUM_STATES/2 + butterfly], codedBits, n);
+            #endif
+
+            bool aDecision = a[0] > a[1];
+            bool bDecision = b[0] > b[1];
+
+            METRIC_TYPE aMetric = a[0];
+            METRIC_TYPE bMetric = b[0];
+            METRIC_TYPE aDiff = a[1] - a[0];
+            METRIC_TYPE bDiff = b[1] - b[0];
+
+            if(aDecision){
+                aMetric = a[1];
+                aDiff = a[0] - a[1];
+            }
+            if(bDecision){
+                bMetric = b[1];
+                bDiff = b[0] - b[1];
+            }
+
+            newMetrics[butterfly*2] = aMetric;
+            newMetrics[butterfly*2+1] = bMetric;
+
+            (*tracebackBuf)[butterfly*2] = aDecision;
+            (*tracebackBuf)[butterfly*2+1] = bDecision;
+
+            (*metricDiffBuf)[butterfly*2] = aDiff;
+            (*metricDiffBuf)[butterfly*2+1] = bDiff;
+        }
+
+        //Renormalize at the same interval as the hard decoder.  Does not change the metric differences
+        if(hard->renormCounter >= VITERBI_RENORM_INTERVAL){
+            METRIC_TYPE minPathMetric = newMetrics[0];
+            for(unsigned int idx = 1; idx<NUM_STATES; idx++){
+                if(newMetrics[idx] < minPathMetric){
+                    minPathMetric = newMetrics[idx];
+                }
+            }
+
+            for(unsigned int idx = 0; idx<NUM_STATES; idx++){
+                newMetrics[idx] = newMetrics[idx] - minPathMetric;
+            }
+
+            hard->renormCounter = 0;
+        }else{
+            (hard->renormCounter)++;
+        }
+
+        for(unsigned int idx = 0; idx<NUM_STATES; idx++){
+            hard->nodeMetricsA[idx] = newMetrics[idx];
+        }
+
+        (hard->iteration)++;
+    }
+
+    if(last){
+        unsigned int numSteps = hard->iteration;
+        unsigned int dataSteps = numSteps - S;
+
+        //Traceback the ML path from the terminated state.  mlStates[t] is the state after t steps
+        SOVA_STATE_TYPE decodedState = 0;
+        state->mlStates[numSteps] = decodedState;
+        for(unsigned int t = numSteps; t>0; t--){
+            uint8_t decision = hard->tracebackBufs[t-1][decodedState];
+            decodedState = (decodedState >> k) | (decision << ((S-1)*k));
+            state->mlStates[t-1] = decodedState;
+        }
+
+        segmentsOut = (dataSteps-1)*k/8+1;
+        for(int i = 0; i<segmentsOut; i++){
+            uncoded[i] = 0;
+        }
+
+        //The decoded bit for a step is the LSb of the state after the step
+        for(unsigned int step = 0; step<dataSteps; step++){
+            uint8_t decodedBit = state->mlStates[step+1] & 1;
+            uncoded[step/8] |= decodedBit << (7 - step%8);
+            reliability[step] = SOVA_RELIABILITY_MAX;
+        }
+
+        //Reliability update.  At each step, the competing path entering the ML state is traced back until
+        //it merges with the ML path or the window ends.  The bits where it disagrees with the ML path have
+        //their reliability limited by the metric difference
+        for(unsigned int t = numSteps; t>0; t--){
+            SOVA_STATE_TYPE mlState = state->mlStates[t];
+            METRIC_TYPE metricDiff = state->metricDiffs[t-1][mlState];
+            if(metricDiff >= SOVA_RELIABILITY_MAX){
+                //Would not change any reliabilities
+                continue;
+            }
+
+            uint8_t competingDecision = !hard->tracebackBufs[t-1][mlState];
+            SOVA_STATE_TYPE competingState = (mlState >> k) | (competingDecision << ((S-1)*k));
+
+            unsigned int windowEnd = t-1 > SOVA_WINDOW_LEN ? t-1-SOVA_WINDOW_LEN : 0;
+            for(unsigned int j = t-1; j>windowEnd && competingState != state->mlStates[j]; j--){
+                //The bits decoded for step j-1 differ if the LSbs of the states after step j-1 differ
+                unsigned int step = j-1;
+                if(step < dataSteps && ((competingState ^ state->mlStates[j]) & 1) && metricDiff < reliability[step]){
+                    reliability[step] = metricDiff;
+                }
+
+                uint8_t decision = hard->tracebackBufs[j-1][competingState];
+                competingState = (competingState >> k) | (decision << ((S-1)*k));
+            }
+        }
+
+        //Reset state for next packet
+        resetViterbiDecoderSovaButterflyk1(state);
+    }
+
+    return segmentsOut;
+}
@@ -0,0 +1,57 @@
+#ifndef _VITERBI_DECODER_SOVA_BUTTERFLYk1_H_
+#define _VITERBI_DECODER_SOVA_BUTTERFLYk1_H_
+
+#include "viterbiDecoder.h"
+
+//Soft-output Viterbi (SOVA) variant of viterbiDecoderHardButterflyk1
+//
+//In addition to the decisions, the difference between the path metrics of the 2 edges entering
+//each state is recorded.  After the ML path is traced back, the competing path which merges into
+//the ML path at each step is traced back for up to SOVA_WINDOW_LEN steps.  Each decoded bit on which
+//the competing path disagrees with the ML path has its reliability lowered to the metric difference
+//if it is smaller (Hagenauer's update rule).
+
+//***** Decoder Options *******
+#ifndef SOVA_WINDOW_LEN
+    #define SOVA_WINDOW_LEN (TRACEBACK_LEN) //The number of steps the competing paths are traced back for the reliability update
+#endif
+//***** End Options ******
+
+#define SOVA_RELIABILITY_MAX (INT8_MAX)
+
+#if k*S <= 8
+    #define SOVA_STATE_TYPE uint8_t
+#elif k*S <= 16
+    #define SOVA_STATE_TYPE uint16_t
+#else
+    #define SOVA_STATE_TYPE uint32_t
+#endif
+
+/**
+ * State for the SOVA decoder between calls
+ *
+ * @note This structure is large.  Allocate it statically or on the heap.
+ */
+typedef struct{
+    viterbiHardState_t hard; //Trellis tables, node metrics, and decisions
+    METRIC_TYPE metricDiffs[(TRACEBACK_BUFFER_LEN+S*k)][NUM_STATES] __attribute__ ((aligned (64))); //|Metric difference| of the 2 edges entering each state
+    SOVA_STATE_TYPE mlStates[(TRACEBACK_BUFFER_LEN+S*k)+1]; //The states along the ML path, filled in during traceback
+} viterbiSovaState_t;
+
+void viterbiInitSovaButterflyk1(viterbiSovaState_t* state);
+
+void resetViterbiDecoderSovaButterflyk1(viterbiSovaState_t* state);
+
+/**
+ * @brief Performs soft-output viterbi decoding.  Has the same interface as viterbiDecoderHardButterflyk1 with an additional reliability output
+ *
+ * @param codedSegments an array of coded segments.  Each segment is in a separate byte
+ * @param uncoded an array of uncoded bytes.  Written when last is set
+ * @param reliability the reliability of each decoded bit, in transmission order.  This is the (saturated) path metric difference to the best path which decodes the bit differently, in units of Hamming distance.  0 is unreliable and SOVA_RELIABILITY_MAX is the most reliable.  Written when last is set
+ * @param segmentsIn The number of coded segements being provided
+ * @param last If true, returns the traceback and resets after this iteration
+ * @returns The number of uncoded bytes returned
+ */
+int viterbiDecoderSovaButterflyk1(viterbiSovaState_t* restrict state, uint8_t* restrict codedSegments, uint8_t* restrict uncoded, int8_t* restrict reliability, int segmentsIn, bool last);
+
+#endif
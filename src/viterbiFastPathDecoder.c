@@ -0,0 +1,161 @@
+#include "viterbiFastPathDecoder.h"
+#include "convEncode.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+void viterbiFastPathInit(viterbiFastPathState_t* state){
+    viterbiInitButterflyk1(&(state->viterbi));
+
+    convEncoderState_t tmpEncoder;
+    resetConvEncoder(&tmpEncoder);
+    initConvEncoder(&tmpEncoder);
+
+    for(int stateInd = 0; stateInd<NUM_STATES; stateInd++){
+        for(int input = 0; input<2; input++){
+            resetConvEncoder(&tmpEncoder);
+            tmpEncoder.tappedDelay = stateInd;
+            state->edgeCodedBits[stateInd][input] = convEncOneInput(&tmpEncoder, input);
+        }
+    }
+
+    state->totalSteps = 0;
+    state->viterbiSteps = 0;
+    state->viterbiSections = 0;
+
+    printf("Re-Encode Fast Path (Backoff=%d, Resync=%d)\n", FAST_PATH_BACKOFF_LEN, FAST_PATH_RESYNC_LEN);
+}
+
+void viterbiFastPathReset(viterbiFastPathState_t* state){
+    state->numReceived = 0;
+}
+
+/**
+ * Runs the Viterbi decoder starting at step start from a known state until the best path has matched
+ * the received segments for FAST_PATH_RESYNC_LEN steps (after step errStep) or the end of the packet
+ * is reached.  Fills in the decoded bits and states for the section.
+ *
+ * @returns the step the section ended at.  The fast path resumes from state->states[end]
+ */
+static unsigned int viterbiFastPathSection(viterbiFastPathState_t* restrict state, unsigned int start, unsigned int errStep, unsigned int totalSteps){
+    viterbiHardState_t* restrict viterbi = &(state->viterbi);
+
+    //Start from the known state
+    resetViterbiDecoderHardButterflyk1(viterbi);
+    METRIC_TYPE forceNot = (S+1)*MAX_EDGE_WEIGHT;
+    for(int i = 0; i<NUM_STATES; i++){
+        viterbi->nodeMetricsA[i] = forceNot;
+    }
+    viterbi->nodeMetricsA[state->states[start]] = 0;
+
+    METRIC_TYPE prevMinMetric = 0;
+    unsigned int cleanRun = 0;
+    unsigned int end = totalSteps;
+    FAST_PATH_STATE_TYPE endState = 0; //The terminated state
+
+    //The ACS is run in blocks of FAST_PATH_CHECK_INTERVAL steps to amortize the call and min overhead
+    uint8_t unused[1];
+    for(unsigned int step = start; step<totalSteps; ){
+        unsigned int blockLen = totalSteps-step < FAST_PATH_CHECK_INTERVAL ? totalSteps-step : FAST_PATH_CHECK_INTERVAL;
+        bool renorm = viterbi->renormCounter + blockLen > VITERBI_RENORM_INTERVAL;
+        viterbiDecoderHardButterflyk1(viterbi, state->received+step, unused, blockLen, false);
+        step += blockLen;
+
+        METRIC_TYPE minMetric = viterbi->nodeMetricsA[0];
+        for(unsigned int idx = 1; idx<NUM_STATES; idx++){
+            if(viterbi->nodeMetricsA[idx] < minMetric){
+                minMetric = viterbi->nodeMetricsA[idx];
+            }
+        }
+
+        //If the best metric did not increase, the best path matched the received segments.
+        //The increase is not known across a renormalization so the run is conservatively restarted
+        if(minMetric == prevMinMetric && !renorm){
+            cleanRun += blockLen;
+        }else{
+            cleanRun = 0;
+        }
+        prevMinMetric = minMetric;
+
+        if(step > errStep && cleanRun >= FAST_PATH_RESYNC_LEN && step < totalSteps){
+            end = step;
+            endState = argminNodeMetrics(&(viterbi->nodeMetricsA));
+            break;
+        }
+    }
+
+    //Traceback from the selected end state
+    FAST_PATH_STATE_TYPE decodedState = endState;
+    state->states[end] = decodedState;
+    for(unsigned int step = end; step>start; step--){
+        uint8_t decision = viterbi->tracebackBufs[step-1-start][decodedState];
+        state->decodedBits[step-1] = decodedState & 1;
+        decodedState = (decodedState >> 1) | (decision << (S-1));
+        state->states[step-1] = decodedState;
+    }
+
+    state->viterbiSteps += end-start;
+    state->viterbiSections++;
+
+    return end;
+}
+
+int viterbiFastPathDecoderHard(viterbiFastPathState_t* restrict state, uint8_t* restrict codedSegments, uint8_t* restrict uncoded, int segmentsIn, bool last){
+    //TODO: Remove check
+    if(state->numReceived + segmentsIn > MAX_PKT_LEN_SEGMENTS){
+        printf("Packet is longer than the fast path decoder supports\n");
+        exit(1);
+    }
+
+    memcpy(state->received+state->numReceived, codedSegments, segmentsIn);
+    state->numReceived += segmentsIn;
+
+    if(!last){
+        return 0;
+    }
+
+    unsigned int totalSteps = state->numReceived;
+    unsigned int dataSteps = totalSteps - S;
+
+    FAST_PATH_STATE_TYPE currentState = STARTING_STATE;
+    unsigned int step = 0;
+    while(step < totalSteps){
+        //Fast path
+        uint8_t codedBits = state->received[step];
+        state->states[step] = currentState;
+        bool match0 = codedBits == state->edgeCodedBits[currentState][0];
+        //During the termination, only the 0 input is possible
+        bool match1 = codedBits == state->edgeCodedBits[currentState][1] && step < dataSteps;
+
+        if(match0 || match1){
+            uint8_t decodedBit = match1;
+            state->decodedBits[step] = decodedBit;
+            currentState = ((currentState << 1) | decodedBit) & (NUM_STATES-1);
+            step++;
+            continue;
+        }
+
+        //Error detected, fall back to the Viterbi decoder
+        unsigned int start = step > FAST_PATH_BACKOFF_LEN ? step-FAST_PATH_BACKOFF_LEN : 0;
+
+        step = viterbiFastPathSection(state, start, step, totalSteps);
+        currentState = state->states[step];
+    }
+
+    state->totalSteps += totalSteps;
+
+    //Pack the decoded bits, MSb first
+    int segmentsOut = dataSteps/8;
+    for(int byte = 0; byte<segmentsOut; byte++){
+        uint8_t packed = 0;
+        for(int bit = 0; bit<8; bit++){
+            packed = (packed << 1) | state->decodedBits[byte*8+bit];
+        }
+        uncoded[byte] = packed;
+    }
+
+    //Reset state for next packet
+    viterbiFastPathReset(state);
+
+    return segmentsOut;
+}
@@ -0,0 +1,86 @@
+#ifndef _VITERBI_FAST_PATH_DECODER_H_
+#define _VITERBI_FAST_PATH_DECODER_H_
+
+#include "convCodeParams.h"
+#include "convHelpers.h"
+#include "viterbiDecoder.h"
+#include <stdbool.h>
+
+//Re-encode fast path for the k=1 butterfly Viterbi decoder
+//
+//When the channel is clean, each received segment is exactly the coded output of one of the 2
+//edges leaving the current encoder state.  The fast path tracks the encoder state and decodes
+//these segments directly (a hard inverse of the code) without running the ACS.
+//
+//When a received segment does not match either edge, the decoder backs off FAST_PATH_BACKOFF_LEN
+//steps (an undetected error can move the fast path onto a wrong state for a few steps before a
+//mismatch is seen) and runs the full Viterbi decoder from the fast path state at that point.  The
+//Viterbi section continues until the best path metric has not increased for FAST_PATH_RESYNC_LEN
+//consecutive steps (the best path matched the received segments).  The best state is then traced back and the fast path resumes
+//from it.  If the Viterbi section reaches the end of the packet, the traceback starts from the
+//terminated (0) state as in the hard decoder.
+
+//***** Decoder Options *******
+#ifndef FAST_PATH_BACKOFF_LEN
+    #define FAST_PATH_BACKOFF_LEN (TRACEBACK_LEN)
+#endif
+#ifndef FAST_PATH_RESYNC_LEN
+    #define FAST_PATH_RESYNC_LEN (TRACEBACK_LEN)
+#endif
+#ifndef FAST_PATH_CHECK_INTERVAL
+    #define FAST_PATH_CHECK_INTERVAL (8) //The number of steps between checks of the best path metric in the Viterbi sections
+#endif
+//***** End Options ******
+
+#if k*S <= 8
+    #define FAST_PATH_STATE_TYPE uint8_t
+#elif k*S <= 16
+    #define FAST_PATH_STATE_TYPE uint16_t
+#else
+    #define FAST_PATH_STATE_TYPE uint32_t
+#endif
+
+/**
+ * State for the fast path decoder between calls.  The received segments are buffered until the last call
+ *
+ * @note This structure is large.  Allocate it statically or on the heap.
+ */
+typedef struct{
+    viterbiHardState_t viterbi; //Used for the sections with errors
+
+    //The coded segment for each state and input
+    uint8_t edgeCodedBits[NUM_STATES][2];
+
+    //Received segments
+    uint8_t received[MAX_PKT_LEN_SEGMENTS];
+    unsigned int numReceived;
+
+    //Decoded bits (one per byte) and the state before each step
+    uint8_t decodedBits[MAX_PKT_LEN_SEGMENTS];
+    FAST_PATH_STATE_TYPE states[MAX_PKT_LEN_SEGMENTS+1];
+
+    //Statistics
+    uint64_t totalSteps; //Trellis steps in all decoded packets
+    uint64_t viterbiSteps; //Steps decoded with the ACS.  Steps in the backoff are decoded by both the fast path and the ACS
+    uint64_t viterbiSections;
+} viterbiFastPathState_t;
+
+void viterbiFastPathInit(viterbiFastPathState_t* state);
+
+void viterbiFastPathReset(viterbiFastPathState_t* state);
+
+/**
+ * @brief Performs hard decision decoding using the re-encode fast path where possible.  Has the same interface as the Viterbi decoder
+ *
+ * @note The code is expected to begin in the starting state and end in the 0 state.  The segments are buffered
+ *       and the packet is decoded when last is set.
+ *
+ * @param codedSegments an array of coded segments.  Each segment is in a separate byte
+ * @param uncoded an array of uncoded bytes.  Written when last is set
+ * @param segmentsIn The number of coded segements being provided
+ * @param last If true, decodes the packet and resets after this iteration
+ * @returns The number of uncoded bytes returned
+ */
+int viterbiFastPathDecoderHard(viterbiFastPathState_t* restrict state, uint8_t* restrict codedSegments, uint8_t* restrict uncoded, int segmentsIn, bool last);
+
+#endif
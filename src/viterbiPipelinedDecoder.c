@@ -0,0 +1,161 @@
+#include "viterbiPipelinedDecoder.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <errno.h>
+#include <sched.h>
+
+static void checkPacketLength(int segmentsIn){
+    if(segmentsIn <= S || segmentsIn > MAX_PKT_LEN_SEGMENTS){
+        printf("Pipelined decoder packet has %d segments, must be more than %d and at most %d\n", segmentsIn, S, MAX_PKT_LEN_SEGMENTS);
+        exit(1);
+    }
+}
+
+#ifdef VITERBI_PIPELINE_ENABLED
+/**
+ * Called while waiting on the other thread.  Spins for a short time then yields the core
+ */
+static inline void viterbiPipelineBackoff(int* spins){
+    if(*spins < VITERBI_PIPELINE_SPIN_LIMIT){
+        (*spins)++;
+        #if defined(__x86_64__) || defined(__i386__)
+            __builtin_ia32_pause();
+        #endif
+    }else{
+        sched_yield();
+    }
+}
+
+static void* viterbiPipelineTracebackWorker(void* arg){
+    viterbiPipeline_t* pipeline = (viterbiPipeline_t*) arg;
+
+    //The slots are traced back in the order they are submitted
+    unsigned int slotIdx = 0;
+    while(1){
+        viterbiPipelineSlot_t* slot = &(pipeline->slots[slotIdx]);
+
+        int spins = 0;
+        while(atomic_load_explicit(&slot->status, memory_order_acquire) != VITERBI_PIPELINE_SLOT_READY){
+            if(atomic_load_explicit(&pipeline->shutdown, memory_order_acquire)){
+                return NULL;
+            }
+            viterbiPipelineBackoff(&spins);
+        }
+
+        int bytesOut;
+        if(slot->crcOk == NULL){
+            bytesOut = viterbiTracebackButterflyk1(slot->state.tracebackBufs, slot->state.iteration, slot->uncoded);
+        }else{
+            viterbiDecodeResult_t result = viterbiTracebackButterflyk1Crc(slot->state.tracebackBufs, slot->state.iteration, slot->uncoded, slot->crc);
+            bytesOut = result.bytesOut;
+            *(slot->crcOk) = result.crcOk;
+        }
+        resetViterbiDecoderHardButterflyk1(&slot->state);
+
+        atomic_fetch_add_explicit(&pipeline->bytesDecoded, bytesOut, memory_order_relaxed);
+        atomic_store_explicit(&slot->status, VITERBI_PIPELINE_SLOT_FREE, memory_order_release);
+        atomic_fetch_add_explicit(&pipeline->completed, 1, memory_order_release);
+
+        slotIdx = slotIdx+1 < VITERBI_PIPELINE_SLOTS ? slotIdx+1 : 0;
+    }
+}
+#endif
+
+void viterbiPipelineInit(viterbiPipeline_t* pipeline){
+    #ifdef VITERBI_PIPELINE_ENABLED
+        printf("Pipelined Viterbi Decoder (Slots=%d)\n", VITERBI_PIPELINE_SLOTS);
+
+        for(int i = 0; i<VITERBI_PIPELINE_SLOTS; i++){
+            VITERBI_RESET(&(pipeline->slots[i].state));
+            VITERBI_INIT(&(pipeline->slots[i].state));
+            pipeline->slots[i].uncoded = NULL;
+            pipeline->slots[i].crc = CRC_NONE;
+            pipeline->slots[i].crcOk = NULL;
+            atomic_init(&(pipeline->slots[i].status), VITERBI_PIPELINE_SLOT_FREE);
+        }
+
+        atomic_init(&pipeline->shutdown, false);
+        atomic_init(&pipeline->completed, 0);
+        atomic_init(&pipeline->bytesDecoded, 0);
+        pipeline->submitted = 0;
+
+        int status = pthread_create(&pipeline->tracebackThread, NULL, viterbiPipelineTracebackWorker, pipeline);
+        if(status != 0){
+            printf("Could not create the traceback thread ... exiting");
+            errno = status;
+            perror(NULL);
+            exit(1);
+        }
+    #else
+        printf("Pipelined Viterbi Decoder (Not Pipelined for this Code)\n");
+        VITERBI_RESET(&pipeline->state);
+        VITERBI_INIT(&pipeline->state);
+        pipeline->bytesDecoded = 0;
+    #endif
+}
+
+void viterbiPipelineDestroy(viterbiPipeline_t* pipeline){
+    viterbiPipelineWait(pipeline);
+
+    #ifdef VITERBI_PIPELINE_ENABLED
+        atomic_store_explicit(&pipeline->shutdown, true, memory_order_release);
+
+        int status = pthread_join(pipeline->tracebackThread, NULL);
+        if(status != 0){
+            printf("Could not join the traceback thread ... exiting");
+            errno = status;
+            perror(NULL);
+            exit(1);
+        }
+    #endif
+}
+
+void viterbiPipelineSubmit(viterbiPipeline_t* pipeline, uint8_t* codedSegments, uint8_t* uncoded, int segmentsIn){
+    viterbiPipelineSubmitEx(pipeline, codedSegments, uncoded, segmentsIn, CRC_NONE, NULL);
+}
+
+void viterbiPipelineSubmitEx(viterbiPipeline_t* pipeline, uint8_t* codedSegments, uint8_t* uncoded, int segmentsIn, crcType_t crc, bool* crcOk){
+    checkPacketLength(segmentsIn);
+
+    #ifdef VITERBI_PIPELINE_ENABLED
+        viterbiPipelineSlot_t* slot = &(pipeline->slots[pipeline->submitted % VITERBI_PIPELINE_SLOTS]);
+
+        //Wait for the traceback of the packet previously in this slot
+        int spins = 0;
+        while(atomic_load_explicit(&slot->status, memory_order_acquire) != VITERBI_PIPELINE_SLOT_FREE){
+            viterbiPipelineBackoff(&spins);
+        }
+
+        //ACS only, the traceback is performed by the traceback thread
+        viterbiDecoderHardButterflyk1(&slot->state, codedSegments, NULL, segmentsIn, false);
+        slot->uncoded = uncoded;
+        slot->crc = crc;
+        slot->crcOk = crcOk;
+
+        atomic_store_explicit(&slot->status, VITERBI_PIPELINE_SLOT_READY, memory_order_release);
+        pipeline->submitted++;
+    #else
+        if(crcOk == NULL){
+            pipeline->bytesDecoded += VITERBI_DECODER_HARD(&pipeline->state, codedSegments, uncoded, segmentsIn, true);
+        }else{
+            viterbiDecodeResult_t result = VITERBI_DECODER_HARD_EX(&pipeline->state, codedSegments, uncoded, segmentsIn, true, crc);
+            pipeline->bytesDecoded += result.bytesOut;
+            *crcOk = result.crcOk;
+        }
+    #endif
+}
+
+long viterbiPipelineWait(viterbiPipeline_t* pipeline){
+    #ifdef VITERBI_PIPELINE_ENABLED
+        int spins = 0;
+        while(atomic_load_explicit(&pipeline->completed, memory_order_acquire) != pipeline->submitted){
+            viterbiPipelineBackoff(&spins);
+        }
+
+        return atomic_exchange_explicit(&pipeline->bytesDecoded, 0, memory_order_relaxed);
+    #else
+        long bytesDecoded = pipeline->bytesDecoded;
+        pipeline->bytesDecoded = 0;
+        return bytesDecoded;
+    #endif
+}
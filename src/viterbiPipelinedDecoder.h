@@ -0,0 +1,105 @@
+#ifndef _VITERBI_PIPELINED_DECODER_H_
+#define _VITERBI_PIPELINED_DECODER_H_
+
+#include "convCodeParams.h"
+#include "convHelpers.h"
+#include "viterbiDecoder.h"
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+
+//Pipelined k=1 butterfly Viterbi decoder for terminated packets
+//
+//The calling thread runs the ACS for a packet into one of VITERBI_PIPELINE_SLOTS decoder states and hands the state
+//(with its decisions in tracebackBufs) to a traceback thread.  While packet i is traced back, the calling thread runs
+//the ACS for packet i+1 into the next slot.  The slots are handed off with an atomic status per slot (release on
+//store, acquire on load) so neither thread takes a lock.  Threads waiting for a slot spin for a short time before
+//yielding the core.
+//
+//For codes other than k=1 (or with -DFORCE_GENERIC_DECODER), packets are decoded by the calling thread when submitted.
+
+//***** Decoder Options *******
+#ifndef VITERBI_PIPELINE_SLOTS
+    #define VITERBI_PIPELINE_SLOTS (2) //Decoder states (traceback buffers) in flight
+#endif
+#ifndef VITERBI_PIPELINE_SPIN_LIMIT
+    #define VITERBI_PIPELINE_SPIN_LIMIT (1024) //Polls of a slot status before the waiting thread yields
+#endif
+//***** End Options ******
+
+#if k==1 && !defined(FORCE_GENERIC_DECODER)
+    #define VITERBI_PIPELINE_ENABLED
+#endif
+
+#define VITERBI_PIPELINE_SLOT_FREE (0)
+#define VITERBI_PIPELINE_SLOT_READY (1) //The ACS is complete and the slot is ready for traceback
+
+typedef struct{
+    viterbiHardState_t state;
+    uint8_t* uncoded; //Where the traceback writes the decoded packet
+    crcType_t crc;
+    bool* crcOk; //Where the traceback writes the result of the CRC check (NULL if not checked)
+
+    //Written by the thread which owns the slot
+    _Atomic int status __attribute__ ((aligned (64)));
+} viterbiPipelineSlot_t;
+
+/**
+ * State for the pipelined decoder
+ *
+ * @note This structure is large and must be 64 byte aligned.  Allocate it with aligned_alloc.
+ */
+typedef struct{
+    #ifdef VITERBI_PIPELINE_ENABLED
+        viterbiPipelineSlot_t slots[VITERBI_PIPELINE_SLOTS];
+        pthread_t tracebackThread;
+        _Atomic bool shutdown;
+
+        //Written by the traceback thread
+        _Atomic unsigned long completed __attribute__ ((aligned (64)));
+        _Atomic long bytesDecoded;
+
+        //Only accessed by the calling thread
+        unsigned long submitted __attribute__ ((aligned (64)));
+    #else
+        viterbiHardState_t state;
+        long bytesDecoded;
+    #endif
+} viterbiPipeline_t;
+
+/**
+ * @brief Initializes the decoder states and starts the traceback thread
+ */
+void viterbiPipelineInit(viterbiPipeline_t* pipeline);
+
+/**
+ * @brief Waits for the submitted packets to finish and stops the traceback thread
+ */
+void viterbiPipelineDestroy(viterbiPipeline_t* pipeline);
+
+/**
+ * @brief Runs the ACS for a terminated packet and hands it to the traceback thread
+ *
+ * Blocks until a slot is free.  The coded segments are no longer needed when this returns.
+ *
+ * @param codedSegments the coded segments of the packet, including the S padding segments
+ * @param uncoded where the decoded packet is written.  Must not be read or reused until viterbiPipelineWait returns
+ * @param segmentsIn the number of coded segments.  Must be more than S (the packet is not empty) and at most MAX_PKT_LEN_SEGMENTS
+ */
+void viterbiPipelineSubmit(viterbiPipeline_t* pipeline, uint8_t* codedSegments, uint8_t* uncoded, int segmentsIn);
+
+/**
+ * @brief Same as viterbiPipelineSubmit but the traceback thread also checks the CRC of the decoded frame (see viterbiDecoderHardButterflyk1Ex)
+ *
+ * @param crcOk where the result of the CRC check is written.  Must not be read until viterbiPipelineWait returns.  If NULL, the CRC is not checked
+ */
+void viterbiPipelineSubmitEx(viterbiPipeline_t* pipeline, uint8_t* codedSegments, uint8_t* uncoded, int segmentsIn, crcType_t crc, bool* crcOk);
+
+/**
+ * @brief Waits until all of the submitted packets have been traced back
+ *
+ * @returns The number of uncoded bytes decoded since the last call to viterbiPipelineWait
+ */
+long viterbiPipelineWait(viterbiPipeline_t* pipeline);
+
+#endif